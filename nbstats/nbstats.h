@@ -0,0 +1,294 @@
+/*!	\file		nbstats.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	nbstats library: statistics and Newcomb-Benford analysis of a list of positive numbers.
+	Every analysis lives in its own nb_context, the library keeps no global state. Separate contexts
+	may be used on separate threads at the same time, one context must not be used by two threads at once.
+
+		nb_context* ctx = nb_create(NULL);
+		nb_ingest_buffer(ctx, text, length);	// as many times as needed, tokens may span two buffers
+		if (nb_finalize(ctx) == NB_OK)
+			use nb_result(ctx)
+		nb_destroy(ctx);
+
+	Finalized contexts (one per file) can be merged into an aggregate context, which then reports
+	count, mean, variance, range, digits and NB deviation of all of them.
+
+	nb_ingest_file also reads .nbc files (binary, see nb_write_nbc) without parsing: their values
+	go from the memory mapping into the statistics.
+
+	nb_ingest_file and nb_ingest_stream decompress gzip input in a build with NBSTATS_ZLIB, zstd input in one
+	with NBSTATS_ZSTD, on a thread of their own while the numbers already decompressed are tokenized.
+
+	nb_save_summary writes what a streaming analysis keeps (count, moments, range, digits, heavy hitters)
+	as a small .nbs file. Summaries of parts of a data set, loaded into one stream context with
+	nb_load_summary, give the streaming analysis of the whole, in whatever order they are loaded.
+
+	With config.memoryBudget the kept numbers that do not fit in it go to sorted runs in temporary files,
+	which nb_finalize merges back: median, mode and percentiles stay exact at any size of the data set.
+
+	With config.quantileError the result has the percentiles p1 ~ p99: exact when the numbers are kept,
+	otherwise (stream, nb_merge, nb_load_summary) from a mergeable KLL sketch of bounded memory, whose
+	percentiles are within quantileError * count of the true rank.
+
+	With config.precision the kept numbers are stored as double or float: median and percentiles then take half or a
+	quarter of the memory, within 2^-53 or 2^-24 of their value (count, mean, variance, range and digits are taken
+	before and are not affected). Mode and number duplication count the stored numbers, so numbers closer than that
+	to each other are one value for them: with float, different cents amounts from about 1.7e5 on. nbstats refuses
+	float and warns of double when they are wanted.
+
+	With config.window the last window numbers are watched as they come in: onWindow receives their
+	statistics and Newcomb-Benford analysis every config.step numbers, each number costs constant time.
+
+	With config.bootstrap nb_finalize resamples the leading digit counts that many times (on all the processors):
+	confidence intervals and p-values of NB deviation, chi-square and MAD, which unlike the fixed bands of the
+	NB deviation take the count of the data set into account.
+
+	With config.digitTests the forensic digit tests are counted in the same pass as the leading digits: second digit,
+	first two digits, last two digits, summation (each with its expected distribution, chi-square, MAD and NB deviation)
+	and number duplication.
+
+	A stream context can report before the end of its input: nb_snapshot fills nb_result from what has been
+	taken so far and the context goes on taking numbers, so a growing file is followed by ingesting only its new bytes.
+
+	With config.profile the context times its phases (wall and processor time, bytes, numbers, peak memory)
+	and counts the rejections by reason, see nb_profile. Without it the phases cost one test each.
+
+	With config.statistics only the statistics wanted are worked out, and nothing is kept that they do not need:
+	without median, mode, number duplication and percentiles the numbers are not kept (the context streams), without
+	the mode no heavy hitters either, so that the leading digits alone take constant memory at the speed of the tokenizer.
+
+	A CSV table is analyzed per group in one call: nb_group_file gives the statistics of the numbers
+	of one column for every value of another column, ranked by NB deviation (worst first).
+*/
+#ifndef NBSTATS_H
+#define NBSTATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// status codes
+#define NB_OK		0
+#define NB_NOMEM	1	// out of memory
+#define NB_INVALID	2	// not a number in the input, the data set ends there (reported to onReject)
+#define NB_EMPTY	3	// no number was accepted
+#define NB_IO		4	// the file could not be opened or read, or a temporary file written (errno is set)
+#define NB_STATE	5	// ingest after nb_finalize
+#define NB_COLUMN	6	// a column of nb_csv_config is not in the CSV header
+#define NB_FORMAT	7	// damaged .nbc, .nbs or compressed file, or one this build can not read (long double, compression)
+
+#define NB_NUM_QUANTILES	7	// p1, p5, p25, p50 (median), p75, p95, p99
+#define NB_MIN_MEMORY		((size_t)64 << 20)	// smallest config.memoryBudget
+#define NB_BOOTSTRAP_LEVEL	0.95	// confidence of the bootstrap intervals, the p-values are significant below 1 - it
+
+// why a token was not accepted
+enum nb_reject {
+	NB_REJECT_NEGATIVE,	// negative number
+	NB_REJECT_ZERO,		// 0 or a token starting with 0 that does not read as a positive number
+	NB_REJECT_INFINITY,	// too large for long double
+	NB_REJECT_INVALID	// not a number at all, terminates the data set
+};
+
+// storage type of the kept numbers (config.precision)
+enum nb_precision {
+	NB_PRECISION_LD,		// long double, as the numbers are read
+	NB_PRECISION_DOUBLE,	// the same as long double where long double is double (MSVC)
+	NB_PRECISION_FLOAT		// numbers beyond the range of float are kept at FLT_MIN or FLT_MAX
+};
+
+// forensic digit tests, config.digitTests has 1 << test for every test wanted
+enum nb_test {
+	NB_TEST_SECOND,			// second digit 0 ~ 9
+	NB_TEST_FIRST_TWO,		// first two digits 10 ~ 99
+	NB_TEST_LAST_TWO,		// last two digits 00 ~ 99 of the integer part, numbers from 10 on
+	NB_TEST_SUMMATION,		// sums of the numbers by their first two digits, all equal expected
+	NB_TEST_DUPLICATION,	// values that occur more than once as kept (config.precision), not stream or nb_merge
+	NB_NUM_TESTS
+};
+
+// statistics of nb_result, config.statistics has 1 << statistic for every statistic wanted
+enum nb_stat {
+	NB_STAT_MEAN,			// arithmetic mean
+	NB_STAT_VARIANCE,		// variance and standard deviation
+	NB_STAT_RANGE,			// smallest and largest number
+	NB_STAT_MEDIAN,			// keeps the numbers, selection without sorting
+	NB_STAT_MODE,			// keeps the numbers, or the heavy hitters with stream
+	NB_STAT_NB,				// leading digit frequencies, NB variance and NB deviation
+	NB_NUM_STATS
+};
+
+#define NB_ALL_STATS		((1u << NB_NUM_STATS) - 1)
+
+#define NB_NUM_DIGIT_TESTS	NB_TEST_DUPLICATION	// the tests with a distribution, nb_result.tests
+#define NB_MAX_BINS			100
+
+// phases of an analysis timed with config.profile
+enum nb_phase {
+	NB_PHASE_INGEST,		// reading, tokenizing, partial statistics, sketch, window and runs of the numbers
+	NB_PHASE_MERGE,			// nb_merge and nb_load_summary
+	NB_PHASE_RUNS,			// merge of the runs beyond the memory budget (median, mode and percentiles at once)
+	NB_PHASE_MODE,			// counting the kept numbers, or the heavy hitters
+	NB_PHASE_MEDIAN,		// selection of the middle numbers
+	NB_PHASE_QUANTILES,		// selection of the percentiles, or the sketch
+	NB_PHASE_BENFORD,		// frequencies and NB deviation
+	NB_PHASE_BOOTSTRAP,		// resamples of the leading digit counts
+	NB_NUM_PHASES
+};
+
+struct nb_phase_profile {
+	double wallSeconds;
+	double cpuSeconds;				// all threads of the process
+	unsigned long long bytes;		// input read, or kept numbers gone through
+	size_t elements;				// numbers taken or gone through
+	size_t peakMemory;				// peak resident set of the process at the end of the phase (bytes), 0: never run
+};
+
+struct nb_profile {
+	struct nb_phase_profile phases[NB_NUM_PHASES];	// sums over all the calls of each phase
+	size_t rejected[4];								// by enum nb_reject
+};
+
+// index is the number of the element (accepted ones before it), token is NULL for nb_ingest_values
+typedef void (*nb_reject_handler)(void* ctx, enum nb_reject reason, size_t index, const char* token, size_t length);
+
+// statistics of the last config.window numbers
+struct nb_window {
+	size_t first;					// element number of the oldest number in the window
+	size_t count;					// # elements in the window
+	long double arithmeticMean;
+	long double variance;
+	long double standardDeviation;
+	long int frequency[9];			// raw frequency of the leading digits 1 ~ 9
+	long double NBVariance;
+	long double NBDeviation;
+};
+
+// called from the ingest functions when the window first fills and every config.step numbers after that
+typedef void (*nb_window_handler)(void* ctx, const struct nb_window* window);
+
+struct nb_config {
+	unsigned threads;			// ingestion threads for nb_ingest_file (0 or 1: the calling thread only)
+	bool stream;				// constant memory: no median, approximate mode
+	nb_reject_handler onReject;	// NULL: rejections are not reported
+	void* rejectCtx;
+	size_t window;				// sliding window of the last window numbers (sets stream), 0: none
+	size_t step;				// numbers between two window reports, 0: window
+	nb_window_handler onWindow;
+	void* windowCtx;
+	double quantileError;		// percentiles, approximate ones within this fraction of the count in rank (e.g. 0.01), 0: none
+	size_t memoryBudget;		// bytes for the kept numbers (not stream), the rest is spilled to disk, 0: no limit
+	enum nb_precision precision;	// storage of the kept numbers, long double with memoryBudget (mode and duplication count it)
+	bool profile;				// time the phases, see nb_profile
+	unsigned digitTests;		// 1 << enum nb_test of the tests wanted, 0: none
+	size_t bootstrap;			// resamples of the leading digit counts, 0: none
+	unsigned bootstrapThreads;	// threads for the resamples, 0: one per processor
+	unsigned statistics;		// 1 << enum nb_stat of the statistics wanted, 0: NB_ALL_STATS
+};
+
+// a statistic of the leading digit test with config.bootstrap
+struct nb_bootstrap_stat {
+	double observed;
+	double low;						// NB_BOOTSTRAP_LEVEL confidence interval, from the resampled counts of the data set
+	double high;
+	double pValue;					// share of Benford distributed data sets of the same count as far from the law
+};
+
+struct nb_bootstrap {
+	size_t resamples;
+	struct nb_bootstrap_stat deviation;	// NB deviation
+	struct nb_bootstrap_stat chiSquare;	// chi-square of the counts (8 degrees of freedom)
+	struct nb_bootstrap_stat mad;		// mean absolute deviation of the frequencies (fractions)
+};
+
+// distribution of a digit test
+struct nb_digit_test {
+	bool computed;					// wanted, and every number merged in was counted for it
+	size_t bins;					// 10, 90, 100 or 90
+	int first;						// digit(s) of bin 0: 0, 10, 0 or 10
+	size_t count;					// numbers in the test (last two digits: from 10 on)
+	double expected[NB_MAX_BINS];	// expected frequencies (fractions)
+	double actual[NB_MAX_BINS];		// actual frequencies (fractions), summation: shares of the sum
+	double chiSquare;				// of the counts, 0 for summation (sums are not counts)
+	double MAD;						// mean absolute deviation of the frequencies
+	long double NBDeviation;		// root mean square of actual / expected - 1, as NBDeviation
+};
+
+struct nb_result {
+	unsigned statistics;			// 1 << enum nb_stat of the statistics worked out, the others are 0
+	size_t count;					// # elements
+	long double arithmeticMean;
+	bool hasMedian;					// false with stream or after nb_merge
+	long double statisticalMedian;
+	long double variance;
+	long double standardDeviation;
+	long double rangeMin;
+	long double rangeMax;
+	const long double* modes;		// ascending, owned by the context
+	size_t numModes;				// 0: every value occurs once
+	size_t modeCount;				// occurrences of each mode
+	size_t modeError;				// stream: modeCount may be too high by this much
+	bool modeUnknown;				// stream: too many distinct values to tell the mode, always after nb_merge
+	bool hasQuantiles;				// config.quantileError, and no merged data came without a sketch
+	bool quantilesExact;			// from the kept numbers, otherwise from the sketch
+	long double quantiles[NB_NUM_QUANTILES];	// p1, p5, p25, p50, p75, p95, p99 (nearest rank)
+	long int frequency[9];			// raw frequency of the leading digits 1 ~ 9
+	double expected[9];				// expected frequencies (%)
+	double actual[9];				// actual frequencies (%)
+	long double NBVariance;
+	long double NBDeviation;
+	struct nb_digit_test tests[NB_NUM_DIGIT_TESTS];	// by enum nb_test
+	bool hasDuplication;			// NB_TEST_DUPLICATION with the numbers kept
+	size_t duplicatedValues;		// distinct values that occur more than once
+	size_t duplicateNumbers;		// numbers that repeat a value before them
+	bool hasBootstrap;				// config.bootstrap
+	struct nb_bootstrap bootstrap;
+};
+
+// grouped analysis of a CSV table
+struct nb_csv_config {
+	const char* valueColumn;	// header of the numbers
+	const char* groupColumn;	// header of the groups, NULL: every row in one group
+	char separator;				// 0: ','
+	unsigned threads;			// 0 or 1: the calling thread only
+};
+
+struct nb_group {
+	const char* key;				// value of the group column (null terminated)
+	size_t keyLength;
+	size_t count;					// # elements, 0 if no field of the group was a positive number
+	size_t rejected;				// fields that are not positive numbers (not reported one by one)
+	long double arithmeticMean;
+	long double standardDeviation;
+	long double rangeMin;
+	long double rangeMax;
+	long int frequency[9];			// raw frequency of the leading digits 1 ~ 9
+	long double NBVariance;
+	long double NBDeviation;
+};
+
+typedef struct nb_context nb_context;
+
+nb_context* nb_create(const struct nb_config* config);
+void nb_destroy(nb_context* ctx);
+int nb_ingest_buffer(nb_context* ctx, const char* buf, size_t len);
+int nb_ingest_values(nb_context* ctx, const long double values[], size_t size);
+int nb_ingest_stream(nb_context* ctx, FILE* stream);
+int nb_ingest_file(nb_context* ctx, const char* fileName);
+int nb_write_nbc(nb_context* ctx, const char* fileName);
+int nb_save_summary(nb_context* ctx, const char* fileName);
+int nb_load_summary(nb_context* ctx, const char* fileName);
+int nb_merge(nb_context* dst, const nb_context* src);
+int nb_finalize(nb_context* ctx);
+int nb_snapshot(nb_context* ctx);
+size_t nb_count(const nb_context* ctx);
+const struct nb_result* nb_result(const nb_context* ctx);
+const struct nb_profile* nb_profile(const nb_context* ctx);
+
+int nb_group_file(const char* fileName, const struct nb_csv_config* config, struct nb_group** groups, size_t* numGroups);
+int nb_group_stream(FILE* stream, const struct nb_csv_config* config, struct nb_group** groups, size_t* numGroups);
+void nb_free_groups(struct nb_group* groups);
+
+#endif
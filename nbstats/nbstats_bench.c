@@ -0,0 +1,779 @@
+/*!	\file		nbstats_bench.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Benchmark of the stages of an analysis on synthetic data sets. Every data set is generated from a fixed seed,
+	so two runs (and two builds) see the same numbers:
+	- benford		log-uniform over 9 decades, follows the Newcomb-Benford law
+	- uniform		uniform in [1, 1000), far from it
+	- samedigit		every number starts with 1 (the 100% frequency table)
+	- ties			100 distinct integers, heavy ties for the mode
+	- tiny			log-uniform below 1, down to 1e-21
+	- huge			log-uniform from 1e100 to 1e300
+	- cents			amounts 1.00 ~ 100000.00 with two decimals, some of them repeated
+	at the sizes 10^min ~ 10^max. The stages are timed by the library itself (config.profile) where it has them:
+	ingest (tokenizing the text, getNumbers), mode (hash table of the kept numbers), median (selection), plus
+	print (the text report of nbstats rendered and written to a temporary file). The kernels are then timed alone on
+	the same numbers in an array: digits (countLeadingDigits), partial (addPartial, the digits with sum, variance,
+	min and max), radixsort (sortNumbers, which the analysis itself no longer needs) and qsort (qsort with
+	compareNumbers, the sort it replaced), and the median both ways: median-sort (radix sort, then the middle numbers)
+	against median-select (calStatisticalMedian, introselect).
+
+	nbstats_bench --self-test checks instead that countLeadingDigits (scalar and AVX2 kernel) and fastLeadingDigit
+	give exactly the digits of leadingDigit: random bit patterns, d * 10^k and d.9999995 * 10^k (where "%e" carries)
+	with their neighbours a few ulps and a few tolerances away, subnormal and huge numbers. It then analyzes every
+	data set with the numbers stored as long double, double and float (config.precision): median and percentiles must
+	be within 2^-53 (double) or 2^-24 (float) of the long double ones, clamped to the range of the type; mode and
+	duplication must be the same unless two different numbers are one value as stored.
+
+	nbstats_bench [--sizes MIN-MAX] [--data NAME,NAME...] [--repeat R]
+	One tab separated line per data set, size and stage on stdout, the best of R runs, for regression tracking:
+	data, size, stage, seconds, numbers per second (0 for print), MB per second (input text, the numbers gone through,
+	or the report), peak memory of the process in MB.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nbstats.h"
+#include "nbstats_digits.h"
+#include "nbstats_platform.h"
+#include "nbstats_render.h"
+#include "nbstats_sort.h"
+#include "nbstats_stats.h"
+
+#define BENCH_SEED		0x2545F4914F6CDD1DULL
+#define BENCH_BLOCK		65536	// numbers generated and ingested at a time
+#define BENCH_NUMBER	32		// longest generated number with its separator
+#define MAX_EXPONENT	9		// largest size 10^9
+#define SELF_TEST_RANDOM	(1 << 20)	// random bit patterns of the self test
+#define SELF_TEST_ULPS		3			// neighbours on each side of an edge
+#define SELF_TEST_EXTREME	64			// random numbers for each of the smallest and largest binary exponents
+#define SELF_TEST_REPORT	10			// mismatches printed
+#define SELF_TEST_SIZE		200001		// numbers of each data set in the precision test (odd: the median is one of them)
+
+// synthetic data sets
+enum dataSet {
+	DATA_BENFORD,
+	DATA_UNIFORM,
+	DATA_SAMEDIGIT,
+	DATA_TIES,
+	DATA_TINY,
+	DATA_HUGE,
+	DATA_CENTS,
+	NUM_DATA
+};
+
+static const char* const dataNames[NUM_DATA] = { "benford", "uniform", "samedigit", "ties", "tiny", "huge", "cents" };
+
+// stages of one run
+enum stage {
+	STAGE_INGEST,
+	STAGE_MODE,
+	STAGE_MEDIAN,
+	STAGE_PRINT,
+	STAGE_DIGITS,
+	STAGE_PARTIAL,
+	STAGE_RADIXSORT,
+	STAGE_QSORT,
+	STAGE_MEDIAN_SORT,
+	STAGE_MEDIAN_SELECT,
+	NUM_STAGES
+};
+
+static const char* const stageNames[NUM_STAGES] = { "ingest", "mode", "median", "print", "digits", "partial", "radixsort",
+	"qsort", "median-sort", "median-select" };
+
+// measurement of one stage
+struct timing {
+	double seconds;
+	unsigned long long bytes;
+	size_t elements;
+	size_t peakMemory;
+};
+
+// deterministic sequence of one data set
+struct generator {
+	enum dataSet set;
+	uint64_t state;
+};
+
+// command line options
+struct benchOptions {
+	int minExponent;
+	int maxExponent;
+	bool data[NUM_DATA];
+	unsigned repeat;
+	bool selfTest;
+};
+
+// conformance of the digit kernels to leadingDigit, one kernel at a time
+struct selfTest {
+	bool avx2;				// countLeadingDigitsWith runs the AVX2 kernel
+	size_t numbers;
+	size_t failures;
+	long double group[4];	// numbers counted together (the 4 lanes of the AVX2 kernel)
+	int expected[4];		// their leadingDigit
+	int grouped;
+};
+
+/*!	 \fn initGenerator
+	 \return none
+	 \param struct generator* g, enum dataSet set
+
+	 The same data set always starts from the same state */
+static void initGenerator(struct generator* g, enum dataSet set) {
+	g->set = set;
+	g->state = BENCH_SEED ^ ((uint64_t)set << 32);
+}
+
+/*!	 \fn nextRandom
+	 \return 64 random bits
+	 \param struct generator* g
+
+	 splitmix64 */
+static uint64_t nextRandom(struct generator* g) {
+	uint64_t z = (g->state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// uniform in [0, 1)
+static double nextUniform(struct generator* g) {
+	return (double)(nextRandom(g) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*!	 \fn nextNumber
+	 \return next positive number of the data set
+	 \param struct generator* g */
+static long double nextNumber(struct generator* g) {
+	switch (g->set) {
+	case DATA_BENFORD:
+		return (long double)pow(10, 9 * nextUniform(g));
+	case DATA_UNIFORM:
+		return (long double)(1 + 999 * nextUniform(g));
+	case DATA_SAMEDIGIT: // [1, 2) times 10^0 ~ 10^5
+		return (long double)((1 + nextUniform(g)) * pow(10, (double)(nextRandom(g) % 6)));
+	case DATA_TIES:
+		return (long double)(1 + nextRandom(g) % 100);
+	case DATA_TINY:
+		return (long double)pow(10, -1 - 20 * nextUniform(g));
+	case DATA_HUGE:
+		return (long double)pow(10, 100 + 200 * nextUniform(g));
+	default: // DATA_CENTS
+		return (long double)(100 + nextRandom(g) % 9999901) / 100;
+	}
+}
+
+/*!	 \fn generateText
+	 \return length of the text
+	 \param struct generator* g, char* text - room for BENCH_NUMBER characters per number, size_t n
+
+	 n numbers as white-space separated text, what nbstats reads from a file */
+static size_t generateText(struct generator* g, char* text, size_t n) {
+	size_t length = 0;
+	for (size_t i = 0; i < n; i++) {
+		int written = snprintf(text + length, BENCH_NUMBER, "%.17Lg\n", nextNumber(g));
+		length += written > 0 && written < BENCH_NUMBER ? (size_t)written : 0;
+	}
+	return length;
+}
+
+/*!	 \fn fromPhase
+	 \return none
+	 \param struct timing* t, const struct nb_phase_profile* p */
+static void fromPhase(struct timing* t, const struct nb_phase_profile* p) {
+	t->seconds = p->wallSeconds;
+	t->bytes = p->bytes;
+	t->elements = p->elements;
+	t->peakMemory = p->peakMemory;
+}
+
+/*!	 \fn openTemporary
+	 \return temporary file (removed when closed), NULL if it can not be created
+	 \param none */
+static FILE* openTemporary() {
+	FILE* file;
+#ifdef _WIN32
+	if (tmpfile_s(&file) != 0)
+		return NULL;
+#else
+	if ((file = tmpfile()) == NULL)
+		return NULL;
+#endif
+	return file;
+}
+
+/*!	 \fn runAnalysis
+	 \return false if out of memory, or the library failed
+	 \param enum dataSet set, size_t size, struct timing t[NUM_STAGES] - receives every stage
+
+	 One analysis of the data set as nbstats does it */
+static bool runAnalysis(enum dataSet set, size_t size, struct timing t[NUM_STAGES]) {
+	struct nb_config config = { 0 };
+	struct generator g;
+	char* text = (char*)malloc((size_t)BENCH_BLOCK * BENCH_NUMBER);
+	if (text == NULL)
+		return false;
+
+	config.profile = true;
+	nb_context* ctx = nb_create(&config);
+	if (ctx == NULL) {
+		free(text);
+		return false;
+	}
+
+	// ingest a block at a time, the library times the ingest only (not the generation)
+	int status = NB_OK;
+	initGenerator(&g, set);
+	for (size_t done = 0; status == NB_OK && done < size; ) {
+		size_t n = size - done < BENCH_BLOCK ? size - done : BENCH_BLOCK;
+		size_t length = generateText(&g, text, n);
+		status = nb_ingest_buffer(ctx, text, length);
+		done += n;
+	}
+	free(text);
+	if (status == NB_OK)
+		status = nb_finalize(ctx);
+	if (status != NB_OK) {
+		fprintf(stderr, "Error: %s %zu: status %d\n", dataNames[set], size, status);
+		nb_destroy(ctx);
+		return false;
+	}
+
+	const struct nb_profile* p = nb_profile(ctx);
+	fromPhase(&t[STAGE_INGEST], &p->phases[NB_PHASE_INGEST]);
+	fromPhase(&t[STAGE_MODE], &p->phases[NB_PHASE_MODE]);
+	fromPhase(&t[STAGE_MEDIAN], &p->phases[NB_PHASE_MEDIAN]);
+
+	FILE* out = openTemporary();
+	if (out == NULL) {
+		perror("Error: temporary file");
+		nb_destroy(ctx);
+		return false;
+	}
+	struct renderBuffer report;
+	struct reportInfo info = { 0 };
+	double start = wallSeconds();
+	initRender(&report, REPORT_CAPACITY); // out of memory fails the write
+	renderReport(&report, RENDER_TEXT, nb_result(ctx), &info);
+	bool written = writeRender(&report, out);
+	freeRender(&report);
+	t[STAGE_PRINT].seconds = wallSeconds() - start;
+	t[STAGE_PRINT].bytes = (unsigned long long)ftell(out);
+	t[STAGE_PRINT].elements = 0;
+	t[STAGE_PRINT].peakMemory = peakMemory();
+	fclose(out);
+	nb_destroy(ctx);
+	if (!written) {
+		fprintf(stderr, "Error: out of memory\n");
+		return false;
+	}
+
+	return true;
+}
+
+/*!	 \fn generateValues
+	 \return none
+	 \param enum dataSet set, long double values[], size_t size
+
+	 The numbers of the data set in an array, the same ones runAnalysis reads as text */
+static void generateValues(enum dataSet set, long double values[], size_t size) {
+	struct generator g;
+	initGenerator(&g, set);
+	for (size_t i = 0; i < size; i++)
+		values[i] = nextNumber(&g);
+}
+
+/*!	 \fn endKernel
+	 \return none
+	 \param struct timing* t, double start - wallSeconds before the kernel, size_t size - numbers gone through */
+static void endKernel(struct timing* t, double start, size_t size) {
+	t->seconds = wallSeconds() - start;
+	t->bytes = (unsigned long long)size * sizeof(long double);
+	t->elements = size;
+	t->peakMemory = peakMemory();
+}
+
+/*!	 \fn runKernels
+	 \return false if out of memory, or the two medians differ
+	 \param enum dataSet set, size_t size, struct timing t[NUM_STAGES] - receives the kernel stages
+
+	 The kernels alone on the numbers of the data set in an array, without the tokenizer around them */
+static bool runKernels(enum dataSet set, size_t size, struct timing t[NUM_STAGES]) {
+	long double* values = size > SIZE_MAX / sizeof(long double) ? NULL : (long double*)malloc(sizeof(long double) * size);
+	if (values == NULL) {
+		fprintf(stderr, "Error: out of memory\n");
+		return false;
+	}
+	generateValues(set, values, size);
+
+	long int fre[9] = { 0 };
+	double start = wallSeconds();
+	countLeadingDigits(values, size, fre);
+	endKernel(&t[STAGE_DIGITS], start, size);
+
+	struct partial partial;
+	initPartial(&partial);
+	start = wallSeconds();
+	addPartial(&partial, values, size);
+	endKernel(&t[STAGE_PARTIAL], start, size);
+
+	// the kernels below change the order, each starts from the generated one
+	start = wallSeconds();
+	sortNumbers(values, size);
+	endKernel(&t[STAGE_RADIXSORT], start, size);
+
+	generateValues(set, values, size);
+	start = wallSeconds();
+	qsort(values, size, sizeof(long double), compareNumbers);
+	endKernel(&t[STAGE_QSORT], start, size);
+
+	generateValues(set, values, size);
+	start = wallSeconds();
+	sortNumbers(values, size);
+	long double sorted = size % 2 == 0 ? (values[size / 2 - 1] + values[size / 2]) / 2 : values[size / 2];
+	endKernel(&t[STAGE_MEDIAN_SORT], start, size);
+
+	generateValues(set, values, size);
+	start = wallSeconds();
+	long double selected = calStatisticalMedian(values, size);
+	endKernel(&t[STAGE_MEDIAN_SELECT], start, size);
+	free(values);
+
+	if (sorted != selected) {
+		fprintf(stderr, "Error: %s %zu: median %.17Lg by sorting, %.17Lg by selection\n", dataNames[set], size, sorted, selected);
+		return false;
+	}
+	return true;
+}
+
+/*!	 \fn countedDigit
+	 \return the digit counted n times, 0 if the counts are not n times one digit
+	 \param const long int fre[9], long int n */
+static int countedDigit(const long int fre[9], long int n) {
+	int digit = 0;
+	long int total = 0;
+	for (int d = 1; d <= 9; d++) {
+		if (fre[d - 1] == n)
+			digit = d;
+		total += fre[d - 1];
+	}
+	return total == n ? digit : 0;
+}
+
+/*!	 \fn checkGroup
+	 \return none
+	 \param struct selfTest* st
+
+	 The last 4 different numbers counted in one call, against the counts of their leadingDigit */
+static void checkGroup(struct selfTest* st) {
+	long int fre[9] = { 0 };
+	long int expected[9] = { 0 };
+
+	countLeadingDigitsWith(st->group, 4, fre, st->avx2);
+	for (int i = 0; i < 4; i++)
+		expected[st->expected[i] - 1]++;
+	if (memcmp(fre, expected, sizeof(fre)) != 0) {
+		if (st->failures++ < SELF_TEST_REPORT)
+			printf("%.21Lg %.21Lg %.21Lg %.21Lg: counted together differently\n", st->group[0], st->group[1], st->group[2], st->group[3]);
+	}
+	st->grouped = 0;
+}
+
+/*!	 \fn checkNumber
+	 \return none
+	 \param struct selfTest* st, long double x
+
+	 fastLeadingDigit and countLeadingDigitsWith on x alone and 4 times, against leadingDigit
+	 \note numbers that leadingDigit has no digit for are skipped: not positive, not finite, 0 as a double */
+static void checkNumber(struct selfTest* st, long double x) {
+	if (!(x > 0 && x <= LDBL_MAX))
+		return;
+	int expected = leadingDigit(x);
+	if (expected < 1 || expected > 9)
+		return;
+
+	long double same[4] = { x, x, x, x };
+	long int one[9] = { 0 };
+	long int four[9] = { 0 };
+	int fast = fastLeadingDigit(x);
+	countLeadingDigitsWith(&x, 1, one, st->avx2);
+	countLeadingDigitsWith(same, 4, four, st->avx2);
+	st->numbers++;
+	if (fast != expected || countedDigit(one, 1) != expected || countedDigit(four, 4) != expected) {
+		if (st->failures++ < SELF_TEST_REPORT)
+			printf("%.21Lg: leadingDigit %d, fastLeadingDigit %d, counted alone %d, 4 times %d\n",
+				x, expected, fast, countedDigit(one, 1), countedDigit(four, 4));
+	}
+
+	st->group[st->grouped] = x;
+	st->expected[st->grouped] = expected;
+	if (++st->grouped == 4)
+		checkGroup(st);
+}
+
+/*!	 \fn checkEdge
+	 \return none
+	 \param struct selfTest* st, long double x - number on a digit boundary, long double m - its x / 10^k
+
+	 x and its neighbours: SELF_TEST_ULPS ulps on each side, and around the tolerance of the kernels */
+static void checkEdge(struct selfTest* st, long double x, long double m) {
+	static const double offsets[] = { -2e-9, -1e-9, -5e-10, -1e-10, 1e-10, 5e-10, 1e-9, 2e-9 };
+	long double below = x;
+	long double above = x;
+
+	checkNumber(st, x);
+	for (int i = 0; i < SELF_TEST_ULPS; i++) {
+		below = nextafterl(below, 0);
+		above = nextafterl(above, LDBL_MAX);
+		checkNumber(st, below);
+		checkNumber(st, above);
+	}
+	for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++)
+		checkNumber(st, x + x * offsets[i] / m);
+}
+
+/*!	 \fn checkKernel
+	 \return none
+	 \param struct selfTest* st - avx2 set, counts zero
+
+	 Every number of the self test through one kernel */
+static void checkKernel(struct selfTest* st) {
+	struct generator g;
+	char text[48];
+	int minPower = DBL_MIN_10_EXP - DBL_DIG - 3; // down to the smallest subnormal double
+
+	// random bit patterns of doubles (long double on MSVC)
+	initGenerator(&g, DATA_BENFORD);
+	for (int i = 0; i < SELF_TEST_RANDOM; i++) {
+		uint64_t bits = nextRandom(&g) & 0x7FFFFFFFFFFFFFFFULL;
+		double x;
+		memcpy(&x, &bits, sizeof(x));
+		checkNumber(st, (long double)x);
+	}
+
+	// d * 10^k, the boundaries of the leading digit, rounded correctly by strtold
+	// (beyond the range of double every kernel hands the number to leadingDigit)
+	for (int k = minPower; k <= DBL_MAX_10_EXP; k++) {
+		for (int d = 1; d <= 9; d++) {
+			snprintf(text, sizeof(text), "%de%d", d, k);
+			checkEdge(st, strtold(text, NULL), d);
+		}
+	}
+
+	// d.9999995 * 10^k below 1, where "%e" rounds up into the next digit
+	for (int k = minPower; k < 0; k++) {
+		for (int d = 1; d <= 9; d++) {
+			snprintf(text, sizeof(text), "%d.9999995e%d", d, k);
+			checkEdge(st, strtold(text, NULL), d + 0.9999995L);
+		}
+	}
+
+	// subnormal numbers and the largest binary exponents of double and of long double
+	static const int extremes[][2] = {
+		{ DBL_MIN_EXP - DBL_MANT_DIG, DBL_MIN_EXP + 8 }, { DBL_MAX_EXP - 8, DBL_MAX_EXP },
+		{ LDBL_MIN_EXP - LDBL_MANT_DIG, LDBL_MIN_EXP + 8 }, { LDBL_MAX_EXP - 8, LDBL_MAX_EXP }
+	};
+	for (size_t r = 0; r < sizeof(extremes) / sizeof(extremes[0]); r++) {
+		for (int e = extremes[r][0]; e <= extremes[r][1]; e++) {
+			for (int i = 0; i < SELF_TEST_EXTREME; i++)
+				checkNumber(st, ldexpl(0.5 + nextUniform(&g) / 2, e));
+		}
+	}
+	checkNumber(st, LDBL_MAX);
+	checkNumber(st, nextafterl(0, 1));
+}
+
+/*!	 \fn clampTo
+	 \return x within the range of the storage type, as the store keeps numbers beyond it
+	 \param long double x, enum nb_precision precision */
+static long double clampTo(long double x, enum nb_precision precision) {
+	long double low = precision == NB_PRECISION_FLOAT ? FLT_MIN : precision == NB_PRECISION_DOUBLE ? DBL_MIN : LDBL_MIN;
+	long double high = precision == NB_PRECISION_FLOAT ? FLT_MAX : precision == NB_PRECISION_DOUBLE ? DBL_MAX : LDBL_MAX;
+	return x < low ? low : x > high ? high : x;
+}
+
+/*!	 \fn storedAs
+	 \return x as the store of the type keeps it
+	 \param long double x, enum nb_precision precision */
+static long double storedAs(long double x, enum nb_precision precision) {
+	x = clampTo(x, precision);
+	if (precision == NB_PRECISION_FLOAT)
+		return (float)x;
+	if (precision == NB_PRECISION_DOUBLE)
+		return (double)x;
+	return x;
+}
+
+/*!	 \fn withinBound
+	 \return true if got is within 2^-53 (double) or 2^-24 (float) of the long double value, clamped to the type
+	 \param long double got, long double exact - of the long double analysis, enum nb_precision precision */
+static bool withinBound(long double got, long double exact, enum nb_precision precision) {
+	long double bound = precision == NB_PRECISION_FLOAT ? FLT_EPSILON / 2 : precision == NB_PRECISION_DOUBLE ? DBL_EPSILON / 2 : 0;
+	long double expected = clampTo(exact, precision);
+	return fabsl(got - expected) <= expected * bound;
+}
+
+/*!	 \fn analyzeText
+	 \return finalized context, NULL if out of memory or the library failed
+	 \param const char* text, size_t length, enum nb_precision precision
+
+	 Median, exact percentiles, mode and duplication of the numbers stored as precision */
+static nb_context* analyzeText(const char* text, size_t length, enum nb_precision precision) {
+	struct nb_config config = { 0 };
+	config.precision = precision;
+	config.quantileError = 0.01;
+	config.digitTests = 1u << NB_TEST_DUPLICATION;
+
+	nb_context* ctx = nb_create(&config);
+	if (ctx != NULL && (nb_ingest_buffer(ctx, text, length) != NB_OK || nb_finalize(ctx) != NB_OK)) {
+		nb_destroy(ctx);
+		ctx = NULL;
+	}
+	return ctx;
+}
+
+/*!	 \fn mergedNumbers
+	 \return distinct numbers that are one value with another one as stored
+	 \param long double sorted[] - the numbers in ascending order, size_t size, enum nb_precision precision */
+static size_t mergedNumbers(const long double sorted[], size_t size, enum nb_precision precision) {
+	size_t merged = 0;
+	for (size_t i = 1; i < size; i++) {
+		if (sorted[i] != sorted[i - 1] && storedAs(sorted[i], precision) == storedAs(sorted[i - 1], precision))
+			merged++;
+	}
+	return merged;
+}
+
+/*!	 \fn comparePrecision
+	 \return mismatches of the result against the long double one
+	 \param const struct nb_result* r, const struct nb_result* exact, enum nb_precision precision,
+			bool sameValues - no two different numbers are one value as stored */
+static size_t comparePrecision(const struct nb_result* r, const struct nb_result* exact, enum nb_precision precision,
+	bool sameValues) {
+	size_t failures = 0;
+
+	if (!r->hasMedian || !withinBound(r->statisticalMedian, exact->statisticalMedian, precision)) {
+		failures++;
+		printf("median %.21Lg, long double %.21Lg\n", r->statisticalMedian, exact->statisticalMedian);
+	}
+	for (int q = 0; q < NB_NUM_QUANTILES; q++) {
+		if (!r->quantilesExact || !withinBound(r->quantiles[q], exact->quantiles[q], precision)) {
+			failures++;
+			printf("percentile %d: %.21Lg, long double %.21Lg\n", q, r->quantiles[q], exact->quantiles[q]);
+		}
+	}
+	if (!sameValues)
+		return failures;
+
+	bool sameModes = r->numModes == exact->numModes && r->modeCount == exact->modeCount;
+	for (size_t i = 0; sameModes && i < r->numModes; i++)
+		sameModes = withinBound(r->modes[i], exact->modes[i], precision);
+	if (!sameModes) {
+		failures++;
+		printf("mode: %zu values x%zu, long double %zu values x%zu\n", r->numModes, r->modeCount, exact->numModes, exact->modeCount);
+	}
+	if (!r->hasDuplication || r->duplicatedValues != exact->duplicatedValues || r->duplicateNumbers != exact->duplicateNumbers) {
+		failures++;
+		printf("duplication: %zu values %zu numbers, long double %zu values %zu numbers\n", r->duplicatedValues,
+			r->duplicateNumbers, exact->duplicatedValues, exact->duplicateNumbers);
+	}
+	return failures;
+}
+
+/*!	 \fn checkPrecision
+	 \return false if out of memory, the library failed, or double or float storage is out of its bounds
+	 \param enum dataSet set
+
+	 SELF_TEST_SIZE numbers of the data set analyzed as long double, double and float */
+static bool checkPrecision(enum dataSet set) {
+	struct generator g;
+	char* text = (char*)malloc((size_t)SELF_TEST_SIZE * BENCH_NUMBER);
+	long double* values = (long double*)malloc(sizeof(long double) * SELF_TEST_SIZE);
+	nb_context* exact = NULL;
+	bool passed = text != NULL && values != NULL;
+
+	if (passed) {
+		initGenerator(&g, set);
+		size_t length = generateText(&g, text, SELF_TEST_SIZE);
+		exact = analyzeText(text, length, NB_PRECISION_LD);
+		passed = exact != NULL;
+
+		// the numbers as the library reads them, for the ones that become one value
+		char* next = text;
+		for (size_t i = 0; i < SELF_TEST_SIZE; i++)
+			values[i] = strtold(next, &next);
+		sortNumbers(values, SELF_TEST_SIZE);
+
+		for (enum nb_precision precision = NB_PRECISION_DOUBLE; passed && precision <= NB_PRECISION_FLOAT; precision++) {
+			nb_context* ctx = analyzeText(text, length, precision);
+			if (ctx == NULL) {
+				passed = false;
+				break;
+			}
+			size_t merged = mergedNumbers(values, SELF_TEST_SIZE, precision);
+			size_t failures = comparePrecision(nb_result(ctx), nb_result(exact), precision, merged == 0);
+			printf("%s precision, %s: %d numbers, %zu mismatches", precision == NB_PRECISION_FLOAT ? "float" : "double",
+				dataNames[set], SELF_TEST_SIZE, failures);
+			if (merged > 0)
+				printf(" (%zu numbers merged, mode and duplication not compared)", merged);
+			printf("\n");
+			passed = failures == 0;
+			nb_destroy(ctx);
+		}
+	}
+	if (exact != NULL)
+		nb_destroy(exact);
+	else
+		fprintf(stderr, "Error: %s: out of memory, or the analysis failed\n", dataNames[set]);
+	free(values);
+	free(text);
+	return passed;
+}
+
+/*!	 \fn runSelfTest
+	 \return true if every kernel gave the digits of leadingDigit, and double and float storage are within bounds
+	 \param none
+
+	 The scalar kernel, then the AVX2 kernel where the build and the processor have it, then the precision of
+	 every data set */
+static bool runSelfTest() {
+	bool passed = true;
+
+	for (int avx2 = 0; avx2 <= 1; avx2++) {
+		struct selfTest st = { 0 };
+		if (avx2 && !digitsHaveAvx2()) {
+			printf("avx2 kernel: not available, skipped\n");
+			continue;
+		}
+		st.avx2 = avx2 != 0;
+		checkKernel(&st);
+		printf("%s kernel: %zu numbers, %zu mismatches\n", avx2 ? "avx2" : "scalar", st.numbers, st.failures);
+		passed = passed && st.failures == 0;
+	}
+	for (int set = 0; set < NUM_DATA; set++)
+		passed = checkPrecision((enum dataSet)set) && passed;
+	return passed;
+}
+
+/*!	 \fn printTiming
+	 \return none
+	 \param enum dataSet set, size_t size, enum stage stage, const struct timing* t */
+static void printTiming(enum dataSet set, size_t size, enum stage stage, const struct timing* t) {
+	double perSecond = t->seconds > 0 ? 1 / t->seconds : 0;
+	printf("%s\t%zu\t%s\t%.6f\t%.0f\t%.1f\t%.1f\n", dataNames[set], size, stageNames[stage], t->seconds,
+		(double)t->elements * perSecond, (double)t->bytes / 1e6 * perSecond, (double)t->peakMemory / 1e6);
+}
+
+/*!	 \fn usageError
+	 \return none
+	 \param none */
+static void usageError() {
+	fprintf(stderr, "usage: nbstats_bench [--sizes MIN-MAX] [--data NAME,NAME...] [--repeat R]\n");
+	fprintf(stderr, "       nbstats_bench --self-test\n");
+	fprintf(stderr, "  --sizes MIN-MAX    sizes 10^MIN ~ 10^MAX, 3 <= MIN <= MAX <= %d (default 3-6)\n", MAX_EXPONENT);
+	fprintf(stderr, "  --data NAME,...    benford, uniform, samedigit, ties, tiny, huge, cents (default all)\n");
+	fprintf(stderr, "  --repeat R         best of R runs (default 3)\n");
+	fprintf(stderr, "  --self-test        digit kernels against leadingDigit, double and float storage against long double,\n");
+	fprintf(stderr, "                     no timing\n");
+	exit(EXIT_FAILURE);
+}
+
+/*!	 \fn parseData
+	 \return false if a name is not a data set
+	 \param const char* list - comma separated names, bool data[NUM_DATA] - receives the chosen ones */
+static bool parseData(const char* list, bool data[NUM_DATA]) {
+	memset(data, 0, sizeof(bool) * NUM_DATA);
+	while (*list != '\0') {
+		size_t length = strcspn(list, ",");
+		int set = 0;
+		while (set < NUM_DATA && !(strlen(dataNames[set]) == length && strncmp(dataNames[set], list, length) == 0))
+			set++;
+		if (set == NUM_DATA)
+			return false;
+		data[set] = true;
+		list += length;
+		if (*list == ',')
+			list++;
+	}
+	return true;
+}
+
+/*!	 \fn parseOptions
+	 \return none
+	 \param int argc, char* argv[], struct benchOptions* opts
+
+	 Invalid command line terminates the program. */
+static void parseOptions(int argc, char* argv[], struct benchOptions* opts) {
+	opts->minExponent = 3;
+	opts->maxExponent = 6;
+	for (int set = 0; set < NUM_DATA; set++)
+		opts->data[set] = true;
+	opts->repeat = 3;
+	opts->selfTest = false;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+			char tail;
+			if (sscanf(argv[++i], "%d-%d%c", &opts->minExponent, &opts->maxExponent, &tail) != 2
+				|| opts->minExponent < 3 || opts->minExponent > opts->maxExponent || opts->maxExponent > MAX_EXPONENT)
+				usageError();
+		}
+		else if (strcmp(argv[i], "--data") == 0 && i + 1 < argc) {
+			if (!parseData(argv[++i], opts->data))
+				usageError();
+		}
+		else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			char* end;
+			unsigned long repeat = strtoul(argv[++i], &end, 10);
+			if (*end != '\0' || repeat == 0 || repeat > 1000)
+				usageError();
+			opts->repeat = (unsigned)repeat;
+		}
+		else if (strcmp(argv[i], "--self-test") == 0) {
+			opts->selfTest = true;
+		}
+		else {
+			usageError();
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	struct benchOptions opts;
+
+	parseOptions(argc, argv, &opts);
+	if (opts.selfTest)
+		return runSelfTest() ? EXIT_SUCCESS : EXIT_FAILURE;
+	printf("data\tsize\tstage\tseconds\tnumbers_per_s\tmb_per_s\tpeak_mb\n");
+	for (int set = 0; set < NUM_DATA; set++) {
+		if (!opts.data[set])
+			continue;
+		size_t size = 1;
+		for (int e = 0; e < opts.minExponent; e++)
+			size *= 10;
+		for (int e = opts.minExponent; e <= opts.maxExponent; e++, size *= 10) {
+			struct timing best[NUM_STAGES];
+			for (unsigned r = 0; r < opts.repeat; r++) {
+				struct timing t[NUM_STAGES] = { 0 };
+				if (!runAnalysis((enum dataSet)set, size, t) || !runKernels((enum dataSet)set, size, t))
+					return EXIT_FAILURE;
+				for (int s = 0; s < NUM_STAGES; s++) {
+					if (r == 0 || t[s].seconds < best[s].seconds)
+						best[s] = t[s];
+				}
+			}
+			for (int s = 0; s < NUM_STAGES; s++)
+				printTiming((enum dataSet)set, size, (enum stage)s, &best[s]);
+			fflush(stdout);
+		}
+	}
+	return 0;
+}
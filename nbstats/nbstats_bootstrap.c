@@ -0,0 +1,373 @@
+/*!	\file		nbstats_bootstrap.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Bootstrap of the leading digit test. Every resample draws the 9 digit counts of a data set of the same count,
+	one binomial per digit given the digits before it (multinomial), once from the frequencies of the data set
+	(confidence intervals of NB deviation, chi-square and MAD) and once from the Newcomb-Benford frequencies
+	(their p-values). Only the counts are resampled, so a resample costs the same whatever the count.
+	The random numbers of resample i come from Philox4x32-10 with the counter (i, kind, block): no state is shared
+	between the threads, and the results do not depend on the number of threads.
+	Binomials with a mean below 10 are drawn by inversion, the others by BTRD (Hormann 1993), exact at any count.
+*/
+#include "nbstats_bootstrap.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nbstats_platform.h"
+#include "nbstats_pool.h"
+#include "nbstats_sort.h"
+
+#define BOOTSTRAP_SEED		0x853C49E6748FEA9BULL
+#define BOOTSTRAP_TASK		1024	// resamples per task of the pool
+
+#define PHILOX_M0			0xD2511F53u
+#define PHILOX_M1			0xCD9E8D57u
+#define PHILOX_W0			0x9E3779B9u
+#define PHILOX_W1			0xBB67AE85u
+
+// what a resample is drawn from, part of the counter
+enum resampleKind {
+	RESAMPLE_DATA,			// frequencies of the data set
+	RESAMPLE_BENFORD		// Newcomb-Benford frequencies
+};
+
+// statistics of the digit test
+enum digitStatistic {
+	STAT_DEVIATION,
+	STAT_CHI_SQUARE,
+	STAT_MAD,
+	NUM_STATS
+};
+
+// random numbers of one resample
+struct randomStream {
+	uint32_t counter[4];	// resample (low, high), kind, block
+	uint32_t block[4];
+	int used;				// words of block taken
+};
+
+// shared by the tasks, every task writes only its own resamples
+struct bootstrapRun {
+	size_t count;
+	double data[9];			// frequencies of the data set (fractions)
+	double benford[9];
+	size_t resamples;
+	double* statistics[NUM_STATS];	// of the resamples from the data set
+	double* nulls[NUM_STATS];		// of the resamples from the Newcomb-Benford law
+};
+
+// log(k!) - Stirling approximation of it, for k < 10
+static const double stirlingTable[10] = {
+	0.08106146679532726, 0.04134069595540929, 0.02767792568499834, 0.02079067210376509, 0.01664469118982119,
+	0.01387612882307075, 0.01189670994589177, 0.01041126526197209, 0.009255462182712733, 0.008330563433362871
+};
+
+/*!	 \fn philox
+	 \return none
+	 \param const uint32_t counter[4], uint32_t out[4]
+
+	 Philox4x32-10 of the counter, keyed with BOOTSTRAP_SEED */
+static void philox(const uint32_t counter[4], uint32_t out[4]) {
+	uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	uint32_t k0 = (uint32_t)BOOTSTRAP_SEED, k1 = (uint32_t)(BOOTSTRAP_SEED >> 32);
+
+	for (int round = 0; round < 10; round++) {
+		uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+		uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+		c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32_t)p1;
+		c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32_t)p0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+/*!	 \fn initStream
+	 \return none
+	 \param struct randomStream* s, size_t resample, enum resampleKind kind */
+static void initStream(struct randomStream* s, size_t resample, enum resampleKind kind) {
+	s->counter[0] = (uint32_t)resample;
+	s->counter[1] = (uint32_t)((uint64_t)resample >> 32);
+	s->counter[2] = (uint32_t)kind;
+	s->counter[3] = 0;
+	s->used = 4;
+}
+
+/*!	 \fn nextUniform
+	 \return uniform in (0, 1), 53 bits
+	 \param struct randomStream* s */
+static double nextUniform(struct randomStream* s) {
+	if (s->used == 4) {
+		philox(s->counter, s->block);
+		s->counter[3]++;
+		s->used = 0;
+	}
+	uint64_t bits = ((uint64_t)s->block[s->used] << 21) ^ (s->block[s->used + 1] >> 11);
+	s->used += 2;
+	return ((double)bits + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+/*!	 \fn stirlingTail
+	 \return log(k!) - ((k + 0.5) log(k + 1) - (k + 1) + log(2 pi) / 2)
+	 \param double k - whole number */
+static double stirlingTail(double k) {
+	if (k < 10)
+		return stirlingTable[(int)k];
+	double k1 = k + 1;
+	double k2 = k1 * k1;
+	return (1.0 / 12 - (1.0 / 360 - 1.0 / 1260 / k2) / k2) / k1;
+}
+
+/*!	 \fn binomialInversion
+	 \return binomial(n, p)
+	 \param struct randomStream* s, size_t n, double p - n p < 10, p <= 0.5
+
+	 Walk the probabilities from 0 until the uniform is used up */
+static size_t binomialInversion(struct randomStream* s, size_t n, double p) {
+	double q = 1 - p;
+	double ratio = p / q;
+	double a = ((double)n + 1) * ratio;
+	double first = pow(q, (double)n);
+
+	for (;;) {
+		double u = nextUniform(s);
+		double f = first;
+		size_t x = 0;
+		while (u > f && f > 0 && x <= n) {
+			u -= f;
+			x++;
+			f *= a / (double)x - ratio;
+		}
+		if (u <= f && x <= n)
+			return x;
+		// rounding left a little of the uniform at the end of the tail, draw again
+	}
+}
+
+/*!	 \fn binomialBtrd
+	 \return binomial(n, p)
+	 \param struct randomStream* s, size_t size - n, double p - n p >= 10, p <= 0.5
+
+	 Transformed rejection with decomposition: most draws are accepted from the triangle in the middle,
+	 the others are checked against the exact probability ratio, recursively near the mode */
+static size_t binomialBtrd(struct randomStream* s, size_t size, double p) {
+	double n = (double)size;
+	double m = floor((n + 1) * p);
+	double r = p / (1 - p);
+	double nr = (n + 1) * r;
+	double npq = n * p * (1 - p);
+	double spq = sqrt(npq);
+	double b = 1.15 + 2.53 * spq;
+	double a = -0.0873 + 0.0248 * b + 0.01 * p;
+	double c = n * p + 0.5;
+	double alpha = (2.83 + 5.1 / b) * spq;
+	double vr = 0.92 - 4.2 / b;
+	double urvr = 0.86 * vr;
+
+	for (;;) {
+		double v = nextUniform(s);
+		double u;
+		if (v <= urvr) {
+			u = v / vr - 0.43;
+			return (size_t)floor((2 * a / (0.5 - fabs(u)) + b) * u + c);
+		}
+		if (v >= vr) {
+			u = nextUniform(s) - 0.5;
+		}
+		else {
+			u = v / vr - 0.93;
+			u = (u < 0 ? -0.5 : 0.5) - u;
+			v = nextUniform(s) * vr;
+		}
+
+		double us = 0.5 - fabs(u);
+		double k = floor((2 * a / us + b) * u + c);
+		if (k < 0 || k > n)
+			continue;
+		v = v * alpha / (a / (us * us) + b);
+		double km = fabs(k - m);
+		if (km <= 15) { // probability ratio of k and the mode, term by term
+			double f = 1;
+			if (m < k) {
+				for (double i = m + 1; i <= k; i++)
+					f *= nr / i - r;
+			}
+			else {
+				for (double i = k + 1; i <= m; i++)
+					v *= nr / i - r;
+			}
+			if (v <= f)
+				return (size_t)k;
+			continue;
+		}
+
+		// squeeze, then the log of the ratio with Stirling's formula
+		v = log(v);
+		double rho = km / npq * (((km / 3 + 0.625) * km + 1.0 / 6) / npq + 0.5);
+		double t = -km * km / (2 * npq);
+		if (v < t - rho)
+			return (size_t)k;
+		if (v > t + rho)
+			continue;
+		double nm = n - m + 1;
+		double h = (m + 0.5) * log((m + 1) / (r * nm)) + stirlingTail(m) + stirlingTail(n - m);
+		double nk = n - k + 1;
+		if (v <= h + (n + 1) * log(nm / nk) + (k + 0.5) * log(nk * r / (k + 1)) - stirlingTail(k) - stirlingTail(n - k))
+			return (size_t)k;
+	}
+}
+
+/*!	 \fn binomial
+	 \return binomial(n, p)
+	 \param struct randomStream* s, size_t n, double p */
+static size_t binomial(struct randomStream* s, size_t n, double p) {
+	if (n == 0 || p <= 0)
+		return 0;
+	if (p >= 1)
+		return n;
+	if (p > 0.5)
+		return n - binomial(s, n, 1 - p);
+	if ((double)n * p < 10)
+		return binomialInversion(s, n, p);
+	return binomialBtrd(s, n, p);
+}
+
+/*!	 \fn multinomial
+	 \return none
+	 \param struct randomStream* s, size_t n, const double p[9] - sums to 1, size_t counts[9]
+
+	 Each digit takes its share of the numbers not taken by the digits before it */
+static void multinomial(struct randomStream* s, size_t n, const double p[9], size_t counts[9]) {
+	double mass = 1;
+	for (int i = 0; i < 8; i++) {
+		double share = mass > 0 ? p[i] / mass : 1;
+		counts[i] = binomial(s, n, share < 1 ? share : 1);
+		n -= counts[i];
+		mass -= p[i];
+	}
+	counts[8] = n;
+}
+
+/*!	 \fn digitStatistics
+	 \return none
+	 \param const size_t counts[9], size_t n, const double expected[9] - fractions, double stat[NUM_STATS]
+
+	 NB deviation (as calNBVariance), chi-square and mean absolute deviation of the frequencies */
+static void digitStatistics(const size_t counts[9], size_t n, const double expected[9], double stat[NUM_STATS]) {
+	double variance = 0, chiSquare = 0, mad = 0;
+	for (int i = 0; i < 9; i++) {
+		double actual = (double)counts[i] / (double)n;
+		double e = (double)n * expected[i];
+		variance += (actual / expected[i] - 1) * (actual / expected[i] - 1);
+		chiSquare += ((double)counts[i] - e) * ((double)counts[i] - e) / e;
+		mad += fabs(actual - expected[i]);
+	}
+	stat[STAT_DEVIATION] = sqrt(variance / 9);
+	stat[STAT_CHI_SQUARE] = chiSquare;
+	stat[STAT_MAD] = mad / 9;
+}
+
+/*!	 \fn resampleTask
+	 \return none
+	 \param void* arg - struct bootstrapRun, unsigned worker - unused, size_t task
+
+	 BOOTSTRAP_TASK resamples of each kind */
+static void resampleTask(void* arg, unsigned worker, size_t task) {
+	struct bootstrapRun* run = (struct bootstrapRun*)arg;
+	size_t first = task * BOOTSTRAP_TASK;
+	size_t last = first + BOOTSTRAP_TASK < run->resamples ? first + BOOTSTRAP_TASK : run->resamples;
+	(void)worker;
+
+	for (size_t i = first; i < last; i++) {
+		struct randomStream s;
+		size_t counts[9];
+		double stat[NUM_STATS];
+
+		initStream(&s, i, RESAMPLE_DATA);
+		multinomial(&s, run->count, run->data, counts);
+		digitStatistics(counts, run->count, run->benford, stat);
+		for (int k = 0; k < NUM_STATS; k++)
+			run->statistics[k][i] = stat[k];
+
+		initStream(&s, i, RESAMPLE_BENFORD);
+		multinomial(&s, run->count, run->benford, counts);
+		digitStatistics(counts, run->count, run->benford, stat);
+		for (int k = 0; k < NUM_STATS; k++)
+			run->nulls[k][i] = stat[k];
+	}
+}
+
+/*!	 \fn summarize
+	 \return none
+	 \param double observed, double resampled[] - sorted here, const double nulls[], size_t size,
+			struct nb_bootstrap_stat* out
+
+	 Percentile interval (nearest rank) and the share of the null resamples at least as far from the law */
+static void summarize(double observed, double resampled[], const double nulls[], size_t size, struct nb_bootstrap_stat* out) {
+	double tail = (1 - NB_BOOTSTRAP_LEVEL) / 2;
+	size_t low = (size_t)ceil(tail * (double)size);
+	size_t high = (size_t)ceil((1 - tail) * (double)size);
+
+	sortNumbersDouble(resampled, size);
+	out->observed = observed;
+	out->low = resampled[low > 0 ? low - 1 : 0];
+	out->high = resampled[high > 0 ? (high <= size ? high - 1 : size - 1) : 0];
+
+	size_t extreme = 0;
+	for (size_t i = 0; i < size; i++)
+		extreme += nulls[i] >= observed;
+	out->pValue = (double)(extreme + 1) / (double)(size + 1);
+}
+
+/*!	 \fn bootstrapDigits
+	 \return false if out of memory
+	 \param const long int fre[9] - raw frequency of the leading digits, size_t resamples,
+			unsigned threads - 0: one per processor, struct nb_bootstrap* out */
+bool bootstrapDigits(const long int fre[9], size_t resamples, unsigned threads, struct nb_bootstrap* out) {
+	struct bootstrapRun run;
+	size_t counts[9];
+	double observed[NUM_STATS];
+	bool ok = true;
+
+	run.count = 0;
+	for (int i = 0; i < 9; i++)
+		run.count += (size_t)fre[i];
+	if (run.count == 0 || resamples == 0 || resamples > SIZE_MAX / sizeof(double))
+		return false;
+	for (int i = 0; i < 9; i++) {
+		counts[i] = (size_t)fre[i];
+		run.data[i] = (double)fre[i] / (double)run.count;
+		run.benford[i] = log10((double)(i + 2)) - log10((double)(i + 1));
+	}
+	digitStatistics(counts, run.count, run.benford, observed);
+
+	run.resamples = resamples;
+	for (int k = 0; k < NUM_STATS; k++) {
+		run.statistics[k] = (double*)malloc(sizeof(double) * resamples);
+		run.nulls[k] = (double*)malloc(sizeof(double) * resamples);
+		ok = ok && run.statistics[k] != NULL && run.nulls[k] != NULL;
+	}
+	if (ok)
+		ok = runPool(threads != 0 ? threads : processorCount(), (resamples + BOOTSTRAP_TASK - 1) / BOOTSTRAP_TASK, resampleTask, &run);
+
+	if (ok) {
+		out->resamples = resamples;
+		summarize(observed[STAT_DEVIATION], run.statistics[STAT_DEVIATION], run.nulls[STAT_DEVIATION], resamples, &out->deviation);
+		summarize(observed[STAT_CHI_SQUARE], run.statistics[STAT_CHI_SQUARE], run.nulls[STAT_CHI_SQUARE], resamples, &out->chiSquare);
+		summarize(observed[STAT_MAD], run.statistics[STAT_MAD], run.nulls[STAT_MAD], resamples, &out->mad);
+	}
+	for (int k = 0; k < NUM_STATS; k++) {
+		free(run.statistics[k]);
+		free(run.nulls[k]);
+	}
+	return ok;
+}
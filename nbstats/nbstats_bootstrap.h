@@ -0,0 +1,19 @@
+/*!	\file		nbstats_bootstrap.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Bootstrap of the leading digit test: the digit counts are resampled (multinomial) from their own frequencies
+	for the confidence intervals, and from the Newcomb-Benford frequencies for the p-values.
+*/
+#ifndef NBSTATS_BOOTSTRAP_H
+#define NBSTATS_BOOTSTRAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nbstats.h"
+
+bool bootstrapDigits(const long int fre[9], size_t resamples, unsigned threads, struct nb_bootstrap* out);
+
+#endif
@@ -0,0 +1,351 @@
+/*!	\file		nbstats_decompress.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Decompression on its own thread. The decoder fills the buffers of a ring one after the other and
+	waits only when all of them are full; the tokenizer takes them in the same order and gives each one
+	back when it asks for the next. With both sides busy the input takes about as long as the slower of
+	decompressing and parsing, instead of both. Concatenated gzip members and zstd frames are one input.
+*/
+#include "nbstats_decompress.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_platform.h"
+
+#ifdef NBSTATS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef NBSTATS_ZSTD
+#include <zstd.h>
+#endif
+
+struct decoder {
+	enum compression compression;
+	const char* data;		// compressed bytes in memory: the whole input, or the first bytes of the stream
+	size_t size;
+	FILE* stream;			// the rest of the input, NULL: none
+	char* input;			// DECODE_INPUT bytes read from the stream
+	char* buffers[DECODE_BUFFERS];
+	size_t sizes[DECODE_BUFFERS];
+	struct mutex lock;
+	struct condition changed;	// a buffer was filled or given back, the decoder finished or must stop
+	size_t filled;			// buffers the decoder filled so far
+	size_t freed;			// buffers the tokenizer gave back so far
+	bool holding;			// the tokenizer has buffer freed % DECODE_BUFFERS
+	bool finished;			// the decoder fills no more buffers
+	bool stop;				// the tokenizer wants no more
+	int status;				// of the decoder, read after it finished
+	struct thread thread;
+};
+
+/*!	 \fn detectCompression
+	 \return compression of the input from its first bytes, COMPRESSION_NONE for text and .nbc files
+	 \param const char* data, size_t size - start of the input
+
+	 Neither magic number can start a list of numbers */
+enum compression detectCompression(const char* data, size_t size) {
+	const unsigned char* p = (const unsigned char*)data;
+
+	if (size >= 2 && p[0] == 0x1f && p[1] == 0x8b)
+		return COMPRESSION_GZIP;
+	if (size >= 4 && p[0] == 0x28 && p[1] == 0xb5 && p[2] == 0x2f && p[3] == 0xfd)
+		return COMPRESSION_ZSTD;
+	return COMPRESSION_NONE;
+}
+
+/*!	 \fn canDecompress
+	 \return true if this build decodes the compression
+	 \param enum compression c */
+bool canDecompress(enum compression c) {
+	switch (c) {
+	case COMPRESSION_NONE:
+		return true;
+#ifdef NBSTATS_ZLIB
+	case COMPRESSION_GZIP:
+		return true;
+#endif
+#ifdef NBSTATS_ZSTD
+	case COMPRESSION_ZSTD:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+#if defined(NBSTATS_ZLIB) || defined(NBSTATS_ZSTD)
+/*!	 \fn readInput
+	 \return false at the end of the input, or when it can not be read (d->status is set)
+	 \param struct decoder* d, const char** in, size_t* size - the next compressed bytes */
+static bool readInput(struct decoder* d, const char** in, size_t* size) {
+	if (d->size > 0) {
+		*in = d->data;
+		*size = d->size;
+		d->size = 0;
+		return true;
+	}
+	if (d->stream == NULL)
+		return false;
+
+	*in = d->input;
+	*size = fread(d->input, 1, DECODE_INPUT, d->stream);
+	if (*size > 0)
+		return true;
+	if (ferror(d->stream))
+		d->status = DECODE_IO;
+	return false;
+}
+
+/*!	 \fn emptyBuffer
+	 \return the buffer to fill next, NULL if the tokenizer wants no more
+	 \param struct decoder* d
+
+	 Wait while all the buffers are full */
+static char* emptyBuffer(struct decoder* d) {
+	lockMutex(&d->lock);
+	while (d->filled - d->freed == DECODE_BUFFERS && !d->stop)
+		waitCondition(&d->changed, &d->lock);
+	bool stop = d->stop;
+	unlockMutex(&d->lock);
+	return stop ? NULL : d->buffers[d->filled % DECODE_BUFFERS];
+}
+
+/*!	 \fn fillBuffer
+	 \return none
+	 \param struct decoder* d, size_t size - bytes decompressed into the buffer of emptyBuffer */
+static void fillBuffer(struct decoder* d, size_t size) {
+	lockMutex(&d->lock);
+	d->sizes[d->filled % DECODE_BUFFERS] = size;
+	d->filled++;
+	wakeCondition(&d->changed);
+	unlockMutex(&d->lock);
+}
+#endif
+
+#ifdef NBSTATS_ZLIB
+/*!	 \fn decodeGzip
+	 \return none, d->status
+	 \param struct decoder* d
+
+	 gzip (or zlib) members one after the other, the input must end with the end of a member */
+static void decodeGzip(struct decoder* d) {
+	z_stream z;
+	const char* in = NULL;
+	size_t inSize = 0;
+	bool ended = false;		// at the end of a member
+	bool full = false;		// the last inflate filled the buffer, more output may be pending
+
+	memset(&z, 0, sizeof(z));
+	if (inflateInit2(&z, 15 + 32) != Z_OK) { // 32: gzip or zlib header
+		d->status = DECODE_NOMEM;
+		return;
+	}
+	char* out = emptyBuffer(d);
+	size_t outSize = 0;
+	while (out != NULL) {
+		if (z.avail_in == 0 && !full) {
+			if (inSize == 0 && !readInput(d, &in, &inSize))
+				break;
+			z.next_in = (Bytef*)in;
+			z.avail_in = inSize > UINT_MAX ? UINT_MAX : (uInt)inSize;
+			in += z.avail_in;
+			inSize -= z.avail_in;
+		}
+		z.next_out = (Bytef*)(out + outSize);
+		z.avail_out = (uInt)(DECODE_BLOCK - outSize);
+		int ret = inflate(&z, Z_NO_FLUSH);
+		if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+			d->status = ret == Z_MEM_ERROR ? DECODE_NOMEM : DECODE_DAMAGED;
+			break;
+		}
+		outSize = DECODE_BLOCK - z.avail_out;
+		full = z.avail_out == 0;
+		if (ret == Z_STREAM_END) // another member may follow
+			inflateReset(&z);
+		ended = ret == Z_STREAM_END || (ended && ret == Z_BUF_ERROR);
+
+		if (full) {
+			fillBuffer(d, outSize);
+			out = emptyBuffer(d);
+			outSize = 0;
+		}
+	}
+	if (out != NULL && d->status == DECODE_OK) {
+		if (outSize > 0)
+			fillBuffer(d, outSize);
+		if (!ended)
+			d->status = DECODE_DAMAGED; // cut off in the middle of a member
+	}
+	inflateEnd(&z);
+}
+#endif
+
+#ifdef NBSTATS_ZSTD
+/*!	 \fn decodeZstd
+	 \return none, d->status
+	 \param struct decoder* d
+
+	 zstd frames one after the other, the input must end with the end of a frame */
+static void decodeZstd(struct decoder* d) {
+	ZSTD_DStream* z = ZSTD_createDStream();
+	ZSTD_inBuffer in = { NULL, 0, 0 };
+	size_t left = 0;		// of the current frame, 0: at the end of a frame
+	bool full = false;		// the last call filled the buffer, more output may be pending
+
+	if (z == NULL) {
+		d->status = DECODE_NOMEM;
+		return;
+	}
+	ZSTD_initDStream(z);
+	char* out = emptyBuffer(d);
+	size_t outSize = 0;
+	while (out != NULL) {
+		if (in.pos == in.size && !full) {
+			const char* data;
+			size_t size;
+			if (!readInput(d, &data, &size))
+				break;
+			in.src = data;
+			in.size = size;
+			in.pos = 0;
+		}
+		ZSTD_outBuffer o = { out, DECODE_BLOCK, outSize };
+		left = ZSTD_decompressStream(z, &o, &in);
+		if (ZSTD_isError(left)) {
+			d->status = DECODE_DAMAGED;
+			break;
+		}
+		outSize = o.pos;
+		full = o.pos == o.size;
+
+		if (full) {
+			fillBuffer(d, outSize);
+			out = emptyBuffer(d);
+			outSize = 0;
+		}
+	}
+	if (out != NULL && d->status == DECODE_OK) {
+		if (outSize > 0)
+			fillBuffer(d, outSize);
+		if (left != 0)
+			d->status = DECODE_DAMAGED; // cut off in the middle of a frame
+	}
+	ZSTD_freeDStream(z);
+}
+#endif
+
+/*!	 \fn decodeMain
+	 \return none
+	 \param void* arg - struct decoder
+
+	 Thread of the decoder */
+static void decodeMain(void* arg) {
+	struct decoder* d = (struct decoder*)arg;
+
+	switch (d->compression) {
+#ifdef NBSTATS_ZLIB
+	case COMPRESSION_GZIP:
+		decodeGzip(d);
+		break;
+#endif
+#ifdef NBSTATS_ZSTD
+	case COMPRESSION_ZSTD:
+		decodeZstd(d);
+		break;
+#endif
+	default:
+		d->status = DECODE_DAMAGED;
+		break;
+	}
+
+	lockMutex(&d->lock);
+	d->finished = true;
+	wakeCondition(&d->changed);
+	unlockMutex(&d->lock);
+}
+
+/*!	 \fn freeDecoder
+	 \return none
+	 \param struct decoder* d - its thread is not running */
+static void freeDecoder(struct decoder* d) {
+	for (int i = 0; i < DECODE_BUFFERS; i++)
+		free(d->buffers[i]);
+	free(d->input);
+	freeCondition(&d->changed);
+	freeMutex(&d->lock);
+	free(d);
+}
+
+/*!	 \fn startDecoder
+	 \return the running decoder, NULL if out of resources
+	 \param enum compression c - canDecompress, const char* data, size_t size - compressed bytes in memory,
+			FILE* stream - the rest of the compressed input after data, NULL: data is all of it
+
+	 data must stay until stopDecoder */
+struct decoder* startDecoder(enum compression c, const char* data, size_t size, FILE* stream) {
+	struct decoder* d = (struct decoder*)calloc(1, sizeof(struct decoder));
+	bool ok = d != NULL;
+
+	if (!ok)
+		return NULL;
+	d->compression = c;
+	d->data = data;
+	d->size = size;
+	d->stream = stream;
+	d->status = DECODE_OK;
+	for (int i = 0; i < DECODE_BUFFERS; i++)
+		ok = ok && (d->buffers[i] = (char*)malloc(DECODE_BLOCK)) != NULL;
+	if (stream != NULL)
+		ok = ok && (d->input = (char*)malloc(DECODE_INPUT)) != NULL;
+	ok = ok && initMutex(&d->lock) && initCondition(&d->changed) && startThread(&d->thread, decodeMain, d);
+	if (!ok) {
+		freeDecoder(d);
+		return NULL;
+	}
+	return d;
+}
+
+/*!	 \fn nextBlock
+	 \return false at the end of the decompressed input (or of what could be decompressed, see stopDecoder)
+	 \param struct decoder* d, const char** block, size_t* size - the next decompressed bytes
+
+	 Give back the block of the last call and wait for the next one. The block stays until the next call. */
+bool nextBlock(struct decoder* d, const char** block, size_t* size) {
+	lockMutex(&d->lock);
+	if (d->holding) {
+		d->freed++;
+		d->holding = false;
+		wakeCondition(&d->changed);
+	}
+	while (d->filled == d->freed && !d->finished)
+		waitCondition(&d->changed, &d->lock);
+	if (d->filled != d->freed) {
+		*block = d->buffers[d->freed % DECODE_BUFFERS];
+		*size = d->sizes[d->freed % DECODE_BUFFERS];
+		d->holding = true;
+	}
+	bool got = d->holding;
+	unlockMutex(&d->lock);
+	return got;
+}
+
+/*!	 \fn stopDecoder
+	 \return DECODE_OK, DECODE_NOMEM, DECODE_DAMAGED or DECODE_IO
+	 \param struct decoder* d - from startDecoder, released
+
+	 Stop the decoder (also before the end of the input) and wait for its thread */
+int stopDecoder(struct decoder* d) {
+	lockMutex(&d->lock);
+	d->stop = true;
+	wakeCondition(&d->changed);
+	unlockMutex(&d->lock);
+	joinThread(&d->thread);
+
+	int status = d->status;
+	freeDecoder(d);
+	return status;
+}
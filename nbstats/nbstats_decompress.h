@@ -0,0 +1,41 @@
+/*!	\file		nbstats_decompress.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Compressed input (gzip, zstd), decompressed on its own thread into a ring of large buffers which the
+	tokenizer takes one after the other, so that decompressing and parsing overlap.
+	gzip needs a build with NBSTATS_ZLIB (and zlib), zstd one with NBSTATS_ZSTD (and libzstd). The ReleaseCompressed|x64
+	configuration of the Visual Studio projects has both, with zlib.lib and zstd.lib from $(CompressionLibs)include and lib
+	(deps\x64\ next to the solution unless set otherwise).
+*/
+#ifndef NBSTATS_DECOMPRESS_H
+#define NBSTATS_DECOMPRESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define DECODE_BLOCK	(1 << 20)	// decompressed bytes of one buffer of the ring
+#define DECODE_BUFFERS	4			// buffers of the ring
+#define DECODE_INPUT	(1 << 18)	// compressed bytes read from a stream at once
+
+// stopDecoder results
+#define DECODE_OK		0
+#define DECODE_NOMEM	1
+#define DECODE_DAMAGED	2	// not valid compressed data, or it ends too early
+#define DECODE_IO		3	// the stream could not be read (errno is set)
+
+enum compression {
+	COMPRESSION_NONE,
+	COMPRESSION_GZIP,
+	COMPRESSION_ZSTD
+};
+
+enum compression detectCompression(const char* data, size_t size);
+bool canDecompress(enum compression c);
+struct decoder* startDecoder(enum compression c, const char* data, size_t size, FILE* stream);
+bool nextBlock(struct decoder* d, const char** block, size_t* size);
+int stopDecoder(struct decoder* d);
+
+#endif
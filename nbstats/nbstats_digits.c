@@ -0,0 +1,484 @@
+/*!	\file		nbstats_digits.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Leading digit kernel. x = m * 10^k is found from the binary exponent of x and a table of powers
+	of ten, 4 numbers at a time with AVX2 where the processor has it. A number whose m is too close
+	to a digit boundary to be sure (repeated division and "%e" rounding could go either way) is
+	handed to leadingDigit, so the digits are always the ones leadingDigit gives.
+	The first two digits of the forensic tests are found the same way, from x / 10^(k-1), but they are the exact
+	digits of x (no "%e" rounding below 1): a number close to a boundary is printed with 30 digits instead.
+*/
+#include "nbstats_digits.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "nbstats_platform.h"
+
+// AVX2 kernel works on doubles, only when long double is double (MSVC)
+#if (defined(_M_X64) || defined(__x86_64__)) && LDBL_MANT_DIG == DBL_MANT_DIG
+#define DIGITS_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET	__attribute__((target("avx2")))
+#endif
+#endif
+
+#define POW10_BIAS		308			// pow10Table[k + POW10_BIAS] = 10^k
+#define DIGIT_TOLERANCE	1e-9		// m closer than this to a boundary goes to leadingDigit
+#define ROUND_UP		0.9999995	// "%e" keeps 6 decimals, from here the first digit carries
+#define EXACT_LIMIT		9007199254740992.0	// 2^53, integers below are exact and so is x / 10^k
+
+// 10^k, k = -308 .. 307 (exact up to 10^22)
+static const double pow10Table[] = {
+	1e-308, 1e-307, 1e-306, 1e-305, 1e-304, 1e-303, 1e-302, 1e-301,
+	1e-300, 1e-299, 1e-298, 1e-297, 1e-296, 1e-295, 1e-294, 1e-293,
+	1e-292, 1e-291, 1e-290, 1e-289, 1e-288, 1e-287, 1e-286, 1e-285,
+	1e-284, 1e-283, 1e-282, 1e-281, 1e-280, 1e-279, 1e-278, 1e-277,
+	1e-276, 1e-275, 1e-274, 1e-273, 1e-272, 1e-271, 1e-270, 1e-269,
+	1e-268, 1e-267, 1e-266, 1e-265, 1e-264, 1e-263, 1e-262, 1e-261,
+	1e-260, 1e-259, 1e-258, 1e-257, 1e-256, 1e-255, 1e-254, 1e-253,
+	1e-252, 1e-251, 1e-250, 1e-249, 1e-248, 1e-247, 1e-246, 1e-245,
+	1e-244, 1e-243, 1e-242, 1e-241, 1e-240, 1e-239, 1e-238, 1e-237,
+	1e-236, 1e-235, 1e-234, 1e-233, 1e-232, 1e-231, 1e-230, 1e-229,
+	1e-228, 1e-227, 1e-226, 1e-225, 1e-224, 1e-223, 1e-222, 1e-221,
+	1e-220, 1e-219, 1e-218, 1e-217, 1e-216, 1e-215, 1e-214, 1e-213,
+	1e-212, 1e-211, 1e-210, 1e-209, 1e-208, 1e-207, 1e-206, 1e-205,
+	1e-204, 1e-203, 1e-202, 1e-201, 1e-200, 1e-199, 1e-198, 1e-197,
+	1e-196, 1e-195, 1e-194, 1e-193, 1e-192, 1e-191, 1e-190, 1e-189,
+	1e-188, 1e-187, 1e-186, 1e-185, 1e-184, 1e-183, 1e-182, 1e-181,
+	1e-180, 1e-179, 1e-178, 1e-177, 1e-176, 1e-175, 1e-174, 1e-173,
+	1e-172, 1e-171, 1e-170, 1e-169, 1e-168, 1e-167, 1e-166, 1e-165,
+	1e-164, 1e-163, 1e-162, 1e-161, 1e-160, 1e-159, 1e-158, 1e-157,
+	1e-156, 1e-155, 1e-154, 1e-153, 1e-152, 1e-151, 1e-150, 1e-149,
+	1e-148, 1e-147, 1e-146, 1e-145, 1e-144, 1e-143, 1e-142, 1e-141,
+	1e-140, 1e-139, 1e-138, 1e-137, 1e-136, 1e-135, 1e-134, 1e-133,
+	1e-132, 1e-131, 1e-130, 1e-129, 1e-128, 1e-127, 1e-126, 1e-125,
+	1e-124, 1e-123, 1e-122, 1e-121, 1e-120, 1e-119, 1e-118, 1e-117,
+	1e-116, 1e-115, 1e-114, 1e-113, 1e-112, 1e-111, 1e-110, 1e-109,
+	1e-108, 1e-107, 1e-106, 1e-105, 1e-104, 1e-103, 1e-102, 1e-101,
+	1e-100, 1e-99, 1e-98, 1e-97, 1e-96, 1e-95, 1e-94, 1e-93,
+	1e-92, 1e-91, 1e-90, 1e-89, 1e-88, 1e-87, 1e-86, 1e-85,
+	1e-84, 1e-83, 1e-82, 1e-81, 1e-80, 1e-79, 1e-78, 1e-77,
+	1e-76, 1e-75, 1e-74, 1e-73, 1e-72, 1e-71, 1e-70, 1e-69,
+	1e-68, 1e-67, 1e-66, 1e-65, 1e-64, 1e-63, 1e-62, 1e-61,
+	1e-60, 1e-59, 1e-58, 1e-57, 1e-56, 1e-55, 1e-54, 1e-53,
+	1e-52, 1e-51, 1e-50, 1e-49, 1e-48, 1e-47, 1e-46, 1e-45,
+	1e-44, 1e-43, 1e-42, 1e-41, 1e-40, 1e-39, 1e-38, 1e-37,
+	1e-36, 1e-35, 1e-34, 1e-33, 1e-32, 1e-31, 1e-30, 1e-29,
+	1e-28, 1e-27, 1e-26, 1e-25, 1e-24, 1e-23, 1e-22, 1e-21,
+	1e-20, 1e-19, 1e-18, 1e-17, 1e-16, 1e-15, 1e-14, 1e-13,
+	1e-12, 1e-11, 1e-10, 1e-9, 1e-8, 1e-7, 1e-6, 1e-5,
+	1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3,
+	1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+	1e20, 1e21, 1e22, 1e23, 1e24, 1e25, 1e26, 1e27,
+	1e28, 1e29, 1e30, 1e31, 1e32, 1e33, 1e34, 1e35,
+	1e36, 1e37, 1e38, 1e39, 1e40, 1e41, 1e42, 1e43,
+	1e44, 1e45, 1e46, 1e47, 1e48, 1e49, 1e50, 1e51,
+	1e52, 1e53, 1e54, 1e55, 1e56, 1e57, 1e58, 1e59,
+	1e60, 1e61, 1e62, 1e63, 1e64, 1e65, 1e66, 1e67,
+	1e68, 1e69, 1e70, 1e71, 1e72, 1e73, 1e74, 1e75,
+	1e76, 1e77, 1e78, 1e79, 1e80, 1e81, 1e82, 1e83,
+	1e84, 1e85, 1e86, 1e87, 1e88, 1e89, 1e90, 1e91,
+	1e92, 1e93, 1e94, 1e95, 1e96, 1e97, 1e98, 1e99,
+	1e100, 1e101, 1e102, 1e103, 1e104, 1e105, 1e106, 1e107,
+	1e108, 1e109, 1e110, 1e111, 1e112, 1e113, 1e114, 1e115,
+	1e116, 1e117, 1e118, 1e119, 1e120, 1e121, 1e122, 1e123,
+	1e124, 1e125, 1e126, 1e127, 1e128, 1e129, 1e130, 1e131,
+	1e132, 1e133, 1e134, 1e135, 1e136, 1e137, 1e138, 1e139,
+	1e140, 1e141, 1e142, 1e143, 1e144, 1e145, 1e146, 1e147,
+	1e148, 1e149, 1e150, 1e151, 1e152, 1e153, 1e154, 1e155,
+	1e156, 1e157, 1e158, 1e159, 1e160, 1e161, 1e162, 1e163,
+	1e164, 1e165, 1e166, 1e167, 1e168, 1e169, 1e170, 1e171,
+	1e172, 1e173, 1e174, 1e175, 1e176, 1e177, 1e178, 1e179,
+	1e180, 1e181, 1e182, 1e183, 1e184, 1e185, 1e186, 1e187,
+	1e188, 1e189, 1e190, 1e191, 1e192, 1e193, 1e194, 1e195,
+	1e196, 1e197, 1e198, 1e199, 1e200, 1e201, 1e202, 1e203,
+	1e204, 1e205, 1e206, 1e207, 1e208, 1e209, 1e210, 1e211,
+	1e212, 1e213, 1e214, 1e215, 1e216, 1e217, 1e218, 1e219,
+	1e220, 1e221, 1e222, 1e223, 1e224, 1e225, 1e226, 1e227,
+	1e228, 1e229, 1e230, 1e231, 1e232, 1e233, 1e234, 1e235,
+	1e236, 1e237, 1e238, 1e239, 1e240, 1e241, 1e242, 1e243,
+	1e244, 1e245, 1e246, 1e247, 1e248, 1e249, 1e250, 1e251,
+	1e252, 1e253, 1e254, 1e255, 1e256, 1e257, 1e258, 1e259,
+	1e260, 1e261, 1e262, 1e263, 1e264, 1e265, 1e266, 1e267,
+	1e268, 1e269, 1e270, 1e271, 1e272, 1e273, 1e274, 1e275,
+	1e276, 1e277, 1e278, 1e279, 1e280, 1e281, 1e282, 1e283,
+	1e284, 1e285, 1e286, 1e287, 1e288, 1e289, 1e290, 1e291,
+	1e292, 1e293, 1e294, 1e295, 1e296, 1e297, 1e298, 1e299,
+	1e300, 1e301, 1e302, 1e303, 1e304, 1e305, 1e306, 1e307
+};
+
+/*!	 \fn leadingDigit
+	 \return 1 ~ 9
+	 \param long double x - positive number
+
+	 First significant digit of x as the frequency table always counted it
+	 \note below 1 the digit of the "%e" form (6 decimals) is taken, from 10 x is divided by 10 until below 10 */
+int leadingDigit(long double x) {
+	long double digit = 0;
+
+	if (x < 1) { // float number < 1
+		char str[20];
+		snprintf(str, sizeof(str), "%e", (double)x);
+		return str[0] - '0';
+	}
+	else if (x < 10) { // if num is between 0 and 9
+		return (int)x;
+	}
+
+	digit = x / 10;
+	while (digit >= 10) {
+		digit = digit / 10;
+	}
+	return (int)digit;
+}
+
+/*!	 \fn fastDigit
+	 \return 1 ~ 9, 0 if x is out of range or too close to a digit boundary to be sure
+	 \param long double x - positive number
+
+	 Leading digit from x / 10^k, k = floor(log10(x)) estimated from the binary exponent */
+static inline int fastDigit(long double x) {
+	double xd = (double)x;
+	unsigned long long bits;
+
+	if (!(xd >= DBL_MIN && xd <= DBL_MAX))
+		return 0;
+	if (x >= 1 && x < 10)
+		return (int)x;
+
+	memcpy(&bits, &xd, sizeof(bits));
+	int e2 = (int)((bits >> 52) & 0x7FF) - 1023;
+	int k = (e2 * 78913) >> 18; // floor(e2 * log10(2)), so 1 <= m < 20
+
+	long double m = x / pow10Table[k + POW10_BIAS];
+	if (m >= 10)
+		m = m / 10;
+	int digit = (int)m;
+	long double frac = m - digit;
+
+	if (x < 1) { // "%e" rounds to 7 significant digits
+		if (frac > ROUND_UP - DIGIT_TOLERANCE && frac < ROUND_UP + DIGIT_TOLERANCE)
+			return 0;
+		if (frac >= ROUND_UP)
+			digit = digit == 9 ? 1 : digit + 1;
+	}
+	else if (frac < DIGIT_TOLERANCE || frac > 1 - DIGIT_TOLERANCE) {
+		if (!(frac == 0 && x < EXACT_LIMIT)) // d * 10^k exactly, every division on the way is exact too
+			return 0;
+	}
+	return digit >= 1 && digit <= 9 ? digit : 0;
+}
+
+/*!	 \fn fastLeadingDigit
+	 \return 1 ~ 9
+	 \param long double x - positive number
+
+	 leadingDigit of one number, by the table unless x is too close to a digit boundary */
+int fastLeadingDigit(long double x) {
+	int digit = fastDigit(x);
+	return digit != 0 ? digit : leadingDigit(x);
+}
+
+#ifdef DIGITS_AVX2
+/*!	 \fn countAvx2
+	 \return none
+	 \param const long double a[] - numbers array, size_t size - multiple of 4, long int fre[9] - raw frequency
+
+	 fastDigit for 4 numbers at a time without branches, the few numbers it can not be sure of go to leadingDigit */
+AVX2_TARGET static void countAvx2(const long double a[], size_t size, long int fre[9]) {
+	long int counts[4][10] = { { 0 } };	// one table per lane
+	int digits[4];
+
+	const __m256d one = _mm256_set1_pd(1);
+	const __m256d nine = _mm256_set1_pd(9);
+	const __m256d ten = _mm256_set1_pd(10);
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d minValue = _mm256_set1_pd(DBL_MIN);
+	const __m256d maxValue = _mm256_set1_pd(DBL_MAX);
+	const __m256d exactLimit = _mm256_set1_pd(EXACT_LIMIT);
+	const __m256d low = _mm256_set1_pd(DIGIT_TOLERANCE);
+	const __m256d high = _mm256_set1_pd(1 - DIGIT_TOLERANCE);
+	const __m256d roundUp = _mm256_set1_pd(ROUND_UP);
+	const __m256d roundLow = _mm256_set1_pd(ROUND_UP - DIGIT_TOLERANCE);
+	const __m256d roundHigh = _mm256_set1_pd(ROUND_UP + DIGIT_TOLERANCE);
+	const __m256i highHalves = _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7);
+	const __m128i exponentMask = _mm_set1_epi32(0x7FF);
+	const __m128i exponentBias = _mm_set1_epi32(1023);
+	const __m128i maxExponent = _mm_set1_epi32(1023);
+	const __m128i log10Of2 = _mm_set1_epi32(78913);
+	const __m128i tableBias = _mm_set1_epi32(POW10_BIAS);
+
+	for (size_t i = 0; i < size; i += 4) {
+		__m256d x = _mm256_loadu_pd((const double*)&a[i]);
+
+		// k = floor(e2 * log10(2)) from the exponent bits (inf and nan clamped, they go to leadingDigit)
+		__m128i upper = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(x), highHalves));
+		__m128i e2 = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(upper, 20), exponentMask), exponentBias);
+		__m128i k = _mm_srai_epi32(_mm_mullo_epi32(_mm_min_epi32(e2, maxExponent), log10Of2), 18);
+
+		__m256d m = _mm256_div_pd(x, _mm256_i32gather_pd(pow10Table, _mm_add_epi32(k, tableBias), 8));
+		m = _mm256_blendv_pd(m, _mm256_div_pd(m, ten), _mm256_cmp_pd(m, ten, _CMP_GE_OQ));
+		__m256d digit = _mm256_floor_pd(m);
+		__m256d frac = _mm256_sub_pd(m, digit);
+
+		// below 1: "%e" rounding carries into the first digit
+		__m256d below1 = _mm256_cmp_pd(x, one, _CMP_LT_OQ);
+		__m256d carried = _mm256_add_pd(digit, _mm256_and_pd(_mm256_cmp_pd(frac, roundUp, _CMP_GE_OQ), one));
+		carried = _mm256_blendv_pd(carried, one, _mm256_cmp_pd(carried, ten, _CMP_EQ_OQ));
+		digit = _mm256_blendv_pd(digit, carried, below1);
+
+		__m256d nearRound = _mm256_and_pd(_mm256_cmp_pd(frac, roundLow, _CMP_GT_OQ), _mm256_cmp_pd(frac, roundHigh, _CMP_LT_OQ));
+		__m256d nearInteger = _mm256_or_pd(_mm256_cmp_pd(frac, low, _CMP_LT_OQ), _mm256_cmp_pd(frac, high, _CMP_GT_OQ));
+		__m256d exact = _mm256_and_pd(_mm256_cmp_pd(frac, zero, _CMP_EQ_OQ), _mm256_cmp_pd(x, exactLimit, _CMP_LT_OQ));
+		__m256d from10 = _mm256_cmp_pd(x, ten, _CMP_GE_OQ);
+
+		__m256d valid = _mm256_and_pd(_mm256_cmp_pd(x, minValue, _CMP_GE_OQ), _mm256_cmp_pd(x, maxValue, _CMP_LE_OQ));
+		valid = _mm256_and_pd(valid, _mm256_cmp_pd(digit, one, _CMP_GE_OQ));
+		valid = _mm256_and_pd(valid, _mm256_cmp_pd(digit, nine, _CMP_LE_OQ));
+		__m256d unsure = _mm256_or_pd(_mm256_and_pd(below1, nearRound), _mm256_andnot_pd(exact, _mm256_and_pd(from10, nearInteger)));
+		int fallback = (~_mm256_movemask_pd(valid) & 0xF) | _mm256_movemask_pd(unsure);
+
+		_mm_storeu_si128((__m128i*)digits, _mm256_cvttpd_epi32(digit));
+		if (fallback) {
+			for (int j = 0; j < 4; j++) {
+				if (fallback & (1 << j))
+					digits[j] = leadingDigit(a[i + j]);
+			}
+		}
+		counts[0][digits[0]]++;
+		counts[1][digits[1]]++;
+		counts[2][digits[2]]++;
+		counts[3][digits[3]]++;
+	}
+
+	for (int d = 1; d <= 9; d++)
+		fre[d - 1] += counts[0][d] + counts[1][d] + counts[2][d] + counts[3][d];
+}
+#endif
+
+/*!	 \fn digitsHaveAvx2
+	 \return true if countLeadingDigits runs the AVX2 kernel: it is built in and the processor has AVX2
+	 \param none */
+bool digitsHaveAvx2(void) {
+#ifdef DIGITS_AVX2
+	return processorHasAvx2();
+#else
+	return false;
+#endif
+}
+
+/*!	 \fn countLeadingDigitsWith
+	 \return none
+	 \param const long double a[] - numbers array, size_t size - how many numbers in array, long int fre[9] - raw frequency,
+			bool avx2 - the AVX2 kernel, if digitsHaveAvx2
+
+	 countLeadingDigits with the kernel chosen by the caller, so both can be checked against leadingDigit */
+void countLeadingDigitsWith(const long double a[], size_t size, long int fre[9], bool avx2) {
+	size_t i = 0;
+
+#ifdef DIGITS_AVX2
+	if (avx2 && processorHasAvx2()) {
+		i = size - size % 4;
+		countAvx2(a, i, fre);
+	}
+#else
+	(void)avx2;
+#endif
+	for (; i < size; i++) {
+		int digit = fastDigit(a[i]);
+		if (digit == 0)
+			digit = leadingDigit(a[i]);
+		fre[digit - 1] += 1; // index 0 base
+	}
+}
+
+/*!	 \fn countLeadingDigits
+	 \return none
+	 \param const long double a[] - numbers array, size_t size - how many numbers in array, long int fre[9] - raw frequency
+
+	 Add the leading digit of every number to the raw frequency, same digits as leadingDigit */
+void countLeadingDigits(const long double a[], size_t size, long int fre[9]) {
+	countLeadingDigitsWith(a, size, fre, true);
+}
+
+/*!	 \fn exactFirstTwo
+	 \return 10 ~ 99
+	 \param long double x - positive number
+
+	 First two significant digits of x from its decimal form, rounded to the digits that x holds (LDBL_DIG), so that
+	 8.2 which is stored as 8.1999... stays 82 */
+static int exactFirstTwo(long double x) {
+	char str[48];
+	snprintf(str, sizeof(str), "%.*Le", LDBL_DIG - 1, x);
+	return (str[0] - '0') * 10 + (str[2] - '0');
+}
+
+/*!	 \fn firstTwoDigits
+	 \return 10 ~ 99
+	 \param long double x - positive number
+
+	 First two significant digits of x, from x / 10^(k-1) unless x is too close to a boundary to be sure */
+int firstTwoDigits(long double x) {
+	double xd = (double)x;
+	unsigned long long bits;
+
+	if (!(xd >= DBL_MIN && xd <= DBL_MAX))
+		return exactFirstTwo(x);
+
+	memcpy(&bits, &xd, sizeof(bits));
+	int e2 = (int)((bits >> 52) & 0x7FF) - 1023;
+	int k = (e2 * 78913) >> 18; // floor(e2 * log10(2)), so 10 <= m < 200
+	if (k - 1 < -POW10_BIAS)
+		return exactFirstTwo(x);
+
+	long double m = x / pow10Table[k - 1 + POW10_BIAS];
+	if (m >= 100)
+		m = m / 10;
+	int digits = (int)m;
+	long double frac = m - digits;
+
+	if (frac < DIGIT_TOLERANCE || frac > 1 - DIGIT_TOLERANCE || digits < 10 || digits > 99) {
+		if (x < EXACT_LIMIT && x == floorl(x)) { // whole number: its decimal digits
+			unsigned long long v = (unsigned long long)x;
+			while (v >= 100)
+				v /= 10;
+			return v < 10 ? (int)v * 10 : (int)v;
+		}
+		return exactFirstTwo(x);
+	}
+	return digits;
+}
+
+/*!	 \fn lastTwoDigits
+	 \return 0 ~ 99
+	 \param long double x - number from 10 on
+
+	 Last two digits of the integer part of x */
+int lastTwoDigits(long double x) {
+	if (x < 1e18)
+		return (int)((unsigned long long)x % 100);
+	return (int)fmodl(x, 100); // exact, whatever the size of x
+}
+
+/*!	 \fn initDigitTests
+	 \return none
+	 \param struct digitTests* t, unsigned enabled - 1 << enum nb_test of the tests to count */
+void initDigitTests(struct digitTests* t, unsigned enabled) {
+	memset(t, 0, sizeof(*t));
+	t->enabled = enabled;
+}
+
+/*!	 \fn addDigitTests
+	 \return none
+	 \param struct digitTests* t, const long double a[] - numbers array, size_t size
+
+	 Count the digits of the numbers for the enabled tests */
+void addDigitTests(struct digitTests* t, const long double a[], size_t size) {
+	bool firstTwo = (t->enabled & (1u << NB_TEST_SECOND | 1u << NB_TEST_FIRST_TWO | 1u << NB_TEST_SUMMATION)) != 0;
+	bool sums = (t->enabled & 1u << NB_TEST_SUMMATION) != 0;
+	bool lastTwo = (t->enabled & 1u << NB_TEST_LAST_TWO) != 0;
+
+	for (size_t i = 0; i < size; i++) {
+		long double x = a[i];
+		if (firstTwo) {
+			int digits = firstTwoDigits(x);
+			t->firstTwo[digits - 10]++;
+			if (sums)
+				t->sums[digits - 10] += x;
+		}
+		if (lastTwo && x >= 10)
+			t->lastTwo[lastTwoDigits(x)]++;
+	}
+}
+
+/*!	 \fn mergeDigitTests
+	 \return none
+	 \param struct digitTests* dst, const struct digitTests* src - same tests enabled */
+void mergeDigitTests(struct digitTests* dst, const struct digitTests* src) {
+	for (int i = 0; i < 90; i++) {
+		dst->firstTwo[i] += src->firstTwo[i];
+		dst->sums[i] += src->sums[i];
+	}
+	for (int i = 0; i < 100; i++)
+		dst->lastTwo[i] += src->lastTwo[i];
+}
+
+/*!	 \fn calDigitTest
+	 \return none
+	 \param const struct digitTests* t, enum nb_test test - one with a distribution, struct nb_digit_test* out
+
+	 Expected and actual frequencies of the test, chi-square, MAD and NB deviation. The expected second digits are
+	 summed over the first digits, the first two digits follow log10(1 + 1 / d), the last two digits and the sums
+	 are uniform. */
+void calDigitTest(const struct digitTests* t, enum nb_test test, struct nb_digit_test* out) {
+	long double observed[NB_MAX_BINS] = { 0 };
+	long double total = 0;
+
+	memset(out, 0, sizeof(*out));
+	switch (test) {
+	case NB_TEST_SECOND:
+		out->bins = 10;
+		for (int d = 0; d < 10; d++) {
+			for (int first = 1; first <= 9; first++) {
+				observed[d] += t->firstTwo[first * 10 + d - 10];
+				out->expected[d] += log10(1 + 1.0 / (first * 10 + d));
+			}
+		}
+		break;
+	case NB_TEST_FIRST_TWO:
+		out->bins = 90;
+		out->first = 10;
+		for (int i = 0; i < 90; i++) {
+			observed[i] = t->firstTwo[i];
+			out->expected[i] = log10(1 + 1.0 / (i + 10));
+		}
+		break;
+	case NB_TEST_LAST_TWO:
+		out->bins = 100;
+		for (int i = 0; i < 100; i++) {
+			observed[i] = t->lastTwo[i];
+			out->expected[i] = 1.0 / 100;
+		}
+		break;
+	default: // NB_TEST_SUMMATION
+		out->bins = 90;
+		out->first = 10;
+		for (int i = 0; i < 90; i++) {
+			observed[i] = t->sums[i];
+			out->expected[i] = 1.0 / 90;
+			out->count += (size_t)t->firstTwo[i];
+		}
+		break;
+	}
+
+	for (size_t i = 0; i < out->bins; i++) {
+		total += observed[i];
+		if (test != NB_TEST_SUMMATION)
+			out->count += (size_t)observed[i];
+	}
+	out->computed = true;
+	if (!(total > 0))
+		return;
+
+	double variance = 0;
+	for (size_t i = 0; i < out->bins; i++) {
+		double e = out->expected[i];
+		out->actual[i] = (double)(observed[i] / total);
+		if (test != NB_TEST_SUMMATION)
+			out->chiSquare += ((double)observed[i] - e * (double)total) * ((double)observed[i] - e * (double)total) / (e * (double)total);
+		out->MAD += fabs(out->actual[i] - e);
+		variance += (out->actual[i] / e - 1) * (out->actual[i] / e - 1);
+	}
+	out->MAD /= (double)out->bins;
+	out->NBDeviation = sqrt(variance / (double)out->bins);
+}
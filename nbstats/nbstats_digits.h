@@ -0,0 +1,38 @@
+/*!	\file		nbstats_digits.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Leading digit of the numbers for the Newcomb-Benford frequency table.
+	countLeadingDigits gives the same digits as leadingDigit without formatting or division loops.
+	The forensic digit tests count the first two and the last two digits of the same numbers.
+*/
+#ifndef NBSTATS_DIGITS_H
+#define NBSTATS_DIGITS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nbstats.h"
+
+// counts of the forensic digit tests (nb_test)
+struct digitTests {
+	unsigned enabled;			// 1 << enum nb_test of the tests counted
+	long int firstTwo[90];		// first two digits 10 ~ 99, the second digit test adds them up
+	long int lastTwo[100];		// last two digits of the integer part, numbers from 10 on
+	long double sums[90];		// sums of the numbers by their first two digits
+};
+
+int leadingDigit(long double x);
+int fastLeadingDigit(long double x);
+void countLeadingDigits(const long double a[], size_t size, long int fre[9]);
+bool digitsHaveAvx2(void);
+void countLeadingDigitsWith(const long double a[], size_t size, long int fre[9], bool avx2);
+int firstTwoDigits(long double x);
+int lastTwoDigits(long double x);
+void initDigitTests(struct digitTests* t, unsigned enabled);
+void addDigitTests(struct digitTests* t, const long double a[], size_t size);
+void mergeDigitTests(struct digitTests* dst, const struct digitTests* src);
+void calDigitTest(const struct digitTests* t, enum nb_test test, struct nb_digit_test* out);
+
+#endif
@@ -0,0 +1,670 @@
+/*!	\file		nbstats_group.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Grouped analysis of a CSV table: the numbers of one column, grouped by the value of another column.
+	The table is read in one pass, every row adds its number to the partial statistics of its group,
+	which are found in a hash table. With several threads every thread takes a part of the rows with
+	its own hash table, the tables are merged at the end.
+	Fields follow RFC 4180: separated by ',' (or the configured separator), optionally quoted with '"',
+	"" is a quote inside a quoted field, records end with LF or CRLF. The first record names the columns.
+*/
+#include "nbstats.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "nbstats_platform.h"
+#include "nbstats_stats.h"
+#include "nbstats_tokenizer.h"
+
+#define MIN_CHUNK		(1 << 16)	// no thread for less than 64KB of rows
+#define READ_BLOCK		(1 << 20)	// a stream is read into memory 1MB at a time
+#define INITIAL_SLOTS	64			// power of two
+#define KEY_BLOCK		(1 << 16)	// group names are copied into blocks of 64KB
+
+// field of a record, begin .. begin + length is the contents without the quotes
+struct field {
+	const char* begin;
+	size_t length;
+	bool escaped;			// contains "" that stands for one quote
+};
+
+struct group {
+	const char* key;		// in the key blocks of the table
+	size_t keyLength;
+	size_t hash;
+	size_t rejected;		// fields of the value column that are not positive numbers
+	struct partial stats;
+};
+
+// storage for the group names, each block is followed by its characters
+struct keyBlock {
+	struct keyBlock* next;
+	size_t used;
+	size_t size;
+};
+
+// hash table of groups, open addressing with linear probing
+struct groupTable {
+	struct group* groups;	// in the order of their first row
+	size_t size;
+	size_t capacity;
+	size_t* slots;			// group number + 1, 0 is empty
+	size_t mask;			// number of slots - 1
+	size_t last;			// group of the previous row + 1, rows of a group often come together
+	struct keyBlock* keys;
+};
+
+// part of the rows for one thread
+struct csvChunk {
+	const char* begin;
+	size_t len;
+	char separator;
+	size_t valueIndex;
+	size_t groupIndex;		// SIZE_MAX: one group
+	struct groupTable table;
+	char* scratch;			// group name with "" turned into "
+	size_t scratchSize;
+	int status;
+	struct thread thread;
+};
+
+/*!	 \fn hashKey
+	 \return hash of the group name (FNV-1a)
+	 \param const char* key, size_t length */
+static size_t hashKey(const char* key, size_t length) {
+	uint64_t h = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; i++) {
+		h ^= (unsigned char)key[i];
+		h *= 1099511628211ULL;
+	}
+	return (size_t)(h ^ (h >> 32));
+}
+
+/*!	 \fn initGroupTable
+	 \return false if out of memory
+	 \param struct groupTable* t */
+static bool initGroupTable(struct groupTable* t) {
+	memset(t, 0, sizeof(*t));
+	t->slots = (size_t*)calloc(INITIAL_SLOTS, sizeof(size_t));
+	t->mask = INITIAL_SLOTS - 1;
+	return t->slots != NULL;
+}
+
+/*!	 \fn freeGroupTable
+	 \return none
+	 \param struct groupTable* t */
+static void freeGroupTable(struct groupTable* t) {
+	while (t->keys != NULL) {
+		struct keyBlock* next = t->keys->next;
+		free(t->keys);
+		t->keys = next;
+	}
+	free(t->groups);
+	free(t->slots);
+	memset(t, 0, sizeof(*t));
+}
+
+/*!	 \fn copyKey
+	 \return the copy, NULL if out of memory
+	 \param struct groupTable* t, const char* key, size_t length
+
+	 Keep a group name in the key blocks of the table (the rows it came from go away) */
+static const char* copyKey(struct groupTable* t, const char* key, size_t length) {
+	struct keyBlock* b = t->keys;
+
+	if (b == NULL || b->size - b->used < length) {
+		size_t size = length > KEY_BLOCK ? length : KEY_BLOCK;
+		b = (struct keyBlock*)malloc(sizeof(struct keyBlock) + size);
+		if (b == NULL)
+			return NULL;
+		b->used = 0;
+		b->size = size;
+		b->next = t->keys;
+		t->keys = b;
+	}
+
+	char* copy = (char*)(b + 1) + b->used;
+	memcpy(copy, key, length);
+	b->used += length;
+	return copy;
+}
+
+/*!	 \fn growSlots
+	 \return false if out of memory
+	 \param struct groupTable* t
+
+	 Double the slots and put every group in again */
+static bool growSlots(struct groupTable* t) {
+	size_t count = (t->mask + 1) * 2;
+	size_t* slots = (size_t*)calloc(count, sizeof(size_t));
+	if (slots == NULL)
+		return false;
+
+	for (size_t g = 0; g < t->size; g++) {
+		size_t i = t->groups[g].hash & (count - 1);
+		while (slots[i] != 0)
+			i = (i + 1) & (count - 1);
+		slots[i] = g + 1;
+	}
+	free(t->slots);
+	t->slots = slots;
+	t->mask = count - 1;
+	return true;
+}
+
+/*!	 \fn findGroup
+	 \return the group, NULL if out of memory
+	 \param struct groupTable* t, const char* key, size_t length
+
+	 Look up a group by its name, a new group is added the first time */
+static struct group* findGroup(struct groupTable* t, const char* key, size_t length) {
+	if (t->last != 0) {
+		struct group* g = &t->groups[t->last - 1];
+		if (g->keyLength == length && memcmp(g->key, key, length) == 0)
+			return g;
+	}
+
+	size_t hash = hashKey(key, length);
+	size_t i = hash & t->mask;
+	for (; t->slots[i] != 0; i = (i + 1) & t->mask) {
+		struct group* g = &t->groups[t->slots[i] - 1];
+		if (g->hash == hash && g->keyLength == length && memcmp(g->key, key, length) == 0) {
+			t->last = t->slots[i];
+			return g;
+		}
+	}
+
+	// new group, at most 3/4 of the slots are used
+	if ((t->size + 1) * 4 > (t->mask + 1) * 3) {
+		if (!growSlots(t))
+			return NULL;
+		for (i = hash & t->mask; t->slots[i] != 0; i = (i + 1) & t->mask)
+			;
+	}
+	if (t->size == t->capacity) {
+		size_t capacity = t->capacity == 0 ? 32 : t->capacity * 2;
+		struct group* groupsDouble = (struct group*)realloc(t->groups, sizeof(struct group) * capacity);
+		if (groupsDouble == NULL)
+			return NULL;
+		t->groups = groupsDouble;
+		t->capacity = capacity;
+	}
+
+	struct group* g = &t->groups[t->size];
+	if ((g->key = copyKey(t, key, length)) == NULL)
+		return NULL;
+	g->keyLength = length;
+	g->hash = hash;
+	g->rejected = 0;
+	initPartial(&g->stats);
+	t->slots[i] = ++t->size;
+	t->last = t->size;
+	return g;
+}
+
+/*!	 \fn mergeTable
+	 \return false if out of memory
+	 \param struct groupTable* dst, const struct groupTable* src
+
+	 Add the groups of src to the groups of the same name in dst */
+static bool mergeTable(struct groupTable* dst, const struct groupTable* src) {
+	for (size_t i = 0; i < src->size; i++) {
+		const struct group* s = &src->groups[i];
+		struct group* d = findGroup(dst, s->key, s->keyLength);
+		if (d == NULL)
+			return false;
+		mergePartial(&d->stats, &s->stats);
+		d->rejected += s->rejected;
+	}
+	return true;
+}
+
+/*!	 \fn parseRecord
+	 \return start of the next record
+	 \param const char* p, const char* end - rest of the input, char separator,
+			struct field fields[], const size_t wanted[], int numWanted - fields to return by column number,
+			size_t* numFields - fields in the record
+
+	 Split one record into fields, only the wanted ones are returned (untouched when the record is too short).
+	 A quote that is not closed takes the rest of the input. */
+static const char* parseRecord(const char* p, const char* end, char separator,
+	struct field fields[], const size_t wanted[], int numWanted, size_t* numFields) {
+	size_t index = 0;
+
+	for (;;) {
+		struct field f;
+
+		if (p < end && *p == '"') {
+			const char* close = end;
+			f.begin = ++p;
+			f.escaped = false;
+			for (;;) {
+				const char* q = (const char*)memchr(p, '"', (size_t)(end - p));
+				if (q == NULL) {
+					p = end;
+					break;
+				}
+				if (q + 1 < end && q[1] == '"') {
+					f.escaped = true;
+					p = q + 2;
+					continue;
+				}
+				close = q;
+				p = q + 1;
+				break;
+			}
+			f.length = (size_t)(close - f.begin);
+			while (p < end && *p != separator && *p != '\n') // anything after the closing quote is dropped
+				p++;
+		}
+		else {
+			f.begin = p;
+			f.escaped = false;
+			while (p < end && *p != separator && *p != '\n')
+				p++;
+			f.length = (size_t)(p - f.begin);
+			if (f.length > 0 && f.begin[f.length - 1] == '\r' && (p == end || *p == '\n'))
+				f.length--;
+		}
+
+		for (int w = 0; w < numWanted; w++) {
+			if (wanted[w] == index)
+				fields[w] = f;
+		}
+		index++;
+
+		if (p == end)
+			break;
+		if (*p++ == '\n')
+			break;
+	}
+
+	*numFields = index;
+	return p;
+}
+
+/*!	 \fn unescape
+	 \return false if out of memory
+	 \param struct field* f, char** scratch, size_t* scratchSize - buffer that receives the contents
+
+	 Turn "" into " (only for fields that have it) */
+static bool unescape(struct field* f, char** scratch, size_t* scratchSize) {
+	if (!f->escaped)
+		return true;
+
+	if (*scratchSize < f->length) {
+		char* grown = (char*)realloc(*scratch, f->length);
+		if (grown == NULL)
+			return false;
+		*scratch = grown;
+		*scratchSize = f->length;
+	}
+
+	size_t n = 0;
+	for (size_t i = 0; i < f->length; i++) {
+		(*scratch)[n++] = f->begin[i];
+		if (f->begin[i] == '"' && i + 1 < f->length && f->begin[i + 1] == '"')
+			i++;
+	}
+	f->begin = *scratch;
+	f->length = n;
+	f->escaped = false;
+	return true;
+}
+
+static inline bool isBlankCh(char c) { return c == ' ' || c == '\t'; }
+
+/*!	 \fn groupRows
+	 \return none
+	 \param void* arg - struct csvChunk
+
+	 Worker: add the number of every row of the chunk to its group */
+static void groupRows(void* arg) {
+	struct csvChunk* c = (struct csvChunk*)arg;
+	const char* p = c->begin;
+	const char* end = c->begin + c->len;
+	const size_t wanted[2] = { c->valueIndex, c->groupIndex };
+
+	if (!initGroupTable(&c->table)) {
+		c->status = NB_NOMEM;
+		return;
+	}
+
+	while (p < end) {
+		struct field fields[2] = { { NULL, 0, false }, { "", 0, false } };
+		size_t numFields;
+
+		if (*p == '\n' || (*p == '\r' && p + 1 < end && p[1] == '\n')) { // blank line
+			p += *p == '\n' ? 1 : 2;
+			continue;
+		}
+		p = parseRecord(p, end, c->separator, fields, wanted, 2, &numFields);
+
+		if (!unescape(&fields[1], &c->scratch, &c->scratchSize)) {
+			c->status = NB_NOMEM;
+			return;
+		}
+		struct group* g = findGroup(&c->table, fields[1].begin, fields[1].length);
+		if (g == NULL) {
+			c->status = NB_NOMEM;
+			return;
+		}
+
+		// the number, blanks around it are allowed
+		const char* s = fields[0].begin;
+		size_t length = fields[0].length;
+		long double value;
+		enum rejectReason reason;
+		while (length > 0 && isBlankCh(*s)) {
+			s++;
+			length--;
+		}
+		while (length > 0 && isBlankCh(s[length - 1]))
+			length--;
+
+		if (s != NULL && readNumber(s, length, &value, &reason))
+			addValue(&g->stats, value);
+		else
+			g->rejected++;
+	}
+}
+
+/*!	 \fn findRecordSplit
+	 \return offset of the first record that starts at or after target (len if there is none)
+	 \param const char* buf, size_t len - rows, size_t from - start of a record before target, size_t target
+
+	 Quotes are counted from a known record start, a line feed inside a quoted field does not end a record */
+static size_t findRecordSplit(const char* buf, size_t len, size_t from, size_t target) {
+	bool quoted = false;
+
+	for (const char* q = buf + from; q < buf + target; q++) {
+		q = (const char*)memchr(q, '"', (size_t)(buf + target - q));
+		if (q == NULL)
+			break;
+		quoted = !quoted;
+	}
+
+	for (size_t i = target; i < len; i++) {
+		if (buf[i] == '"')
+			quoted = !quoted;
+		else if (buf[i] == '\n' && !quoted)
+			return i + 1;
+	}
+	return len;
+}
+
+/*!	 \fn findColumn
+	 \return column number, SIZE_MAX if there is no such column
+	 \param const char* p, const char* end - header record, char separator, const char* name,
+			char** scratch, size_t* scratchSize */
+static size_t findColumn(const char* p, const char* end, char separator, const char* name,
+	char** scratch, size_t* scratchSize) {
+	size_t nameLength = strlen(name);
+
+	for (size_t index = 0;; index++) {
+		struct field f = { NULL, 0, false };
+		size_t numFields;
+
+		parseRecord(p, end, separator, &f, &index, 1, &numFields);
+		if (index >= numFields || !unescape(&f, scratch, scratchSize))
+			return SIZE_MAX;
+		while (f.length > 0 && isBlankCh(*f.begin)) {
+			f.begin++;
+			f.length--;
+		}
+		while (f.length > 0 && isBlankCh(f.begin[f.length - 1]))
+			f.length--;
+		if (f.length == nameLength && memcmp(f.begin, name, nameLength) == 0)
+			return index;
+	}
+}
+
+/*!	 \fn groupCsv
+	 \return NB_OK, NB_NOMEM, NB_COLUMN or NB_EMPTY (no rows)
+	 \param const char* buf, size_t len - whole table, const struct nb_csv_config* config,
+			struct groupTable* table - receives the groups
+
+	 Read the header, then group the rows with config->threads threads */
+static int groupCsv(const char* buf, size_t len, const struct nb_csv_config* config, struct groupTable* table) {
+	char separator = config->separator != '\0' ? config->separator : ',';
+	unsigned threads = config->threads != 0 ? config->threads : 1;
+	char* scratch = NULL;
+	size_t scratchSize = 0;
+	int status = NB_OK;
+
+	if (len >= 3 && memcmp(buf, "\xEF\xBB\xBF", 3) == 0) { // UTF-8 byte order mark
+		buf += 3;
+		len -= 3;
+	}
+	if (len == 0)
+		return NB_EMPTY;
+
+	// header
+	size_t numFields;
+	struct field unused;
+	const char* rows = parseRecord(buf, buf + len, separator, &unused, NULL, 0, &numFields);
+	size_t valueIndex = findColumn(buf, rows, separator, config->valueColumn, &scratch, &scratchSize);
+	size_t groupIndex = SIZE_MAX;
+	if (config->groupColumn != NULL)
+		groupIndex = findColumn(buf, rows, separator, config->groupColumn, &scratch, &scratchSize);
+	free(scratch);
+	if (valueIndex == SIZE_MAX || (config->groupColumn != NULL && groupIndex == SIZE_MAX))
+		return NB_COLUMN;
+
+	len -= (size_t)(rows - buf);
+	if (threads > len / MIN_CHUNK + 1)
+		threads = (unsigned)(len / MIN_CHUNK + 1);
+
+	struct csvChunk* chunks = (struct csvChunk*)calloc(threads, sizeof(struct csvChunk));
+	if (chunks == NULL)
+		return NB_NOMEM;
+
+	// split at a record boundary near every 1/threads of the rows
+	size_t begin = 0;
+	for (unsigned i = 0; i < threads; i++) {
+		size_t end = len;
+		if (i + 1 < threads) {
+			end = len / threads * (i + 1);
+			end = end < begin ? begin : findRecordSplit(rows, len, begin, end);
+		}
+		chunks[i].begin = rows + begin;
+		chunks[i].len = end - begin;
+		chunks[i].separator = separator;
+		chunks[i].valueIndex = valueIndex;
+		chunks[i].groupIndex = groupIndex;
+		begin = end;
+	}
+
+	// the first chunk runs on this thread
+	for (unsigned i = 1; i < threads; i++) {
+		if (!startThread(&chunks[i].thread, groupRows, &chunks[i]))
+			groupRows(&chunks[i]);
+	}
+	groupRows(&chunks[0]);
+	for (unsigned i = 1; i < threads; i++)
+		joinThread(&chunks[i].thread);
+
+	for (unsigned i = 0; i < threads; i++) {
+		if (chunks[i].status != NB_OK)
+			status = chunks[i].status;
+		else if (status == NB_OK && i > 0 && !mergeTable(&chunks[0].table, &chunks[i].table))
+			status = NB_NOMEM;
+	}
+	if (status == NB_OK && chunks[0].table.size == 0)
+		status = NB_EMPTY;
+
+	if (status == NB_OK) {
+		*table = chunks[0].table;
+		chunks[0].table.groups = NULL;
+		chunks[0].table.slots = NULL;
+		chunks[0].table.keys = NULL;
+	}
+	for (unsigned i = 0; i < threads; i++) {
+		freeGroupTable(&chunks[i].table);
+		free(chunks[i].scratch);
+	}
+	free(chunks);
+	return status;
+}
+
+/*!	 \fn compareGroups
+	 \return order of two groups, worst Benford relationship first
+	 \param const void* a, const void* b - struct nb_group
+
+	 By NB Deviation (descending), groups without numbers last, then by name */
+static int compareGroups(const void* a, const void* b) {
+	const struct nb_group* x = (const struct nb_group*)a;
+	const struct nb_group* y = (const struct nb_group*)b;
+
+	if ((x->count == 0) != (y->count == 0))
+		return x->count == 0 ? 1 : -1;
+	if (x->NBDeviation != y->NBDeviation)
+		return x->NBDeviation > y->NBDeviation ? -1 : 1;
+
+	size_t length = x->keyLength < y->keyLength ? x->keyLength : y->keyLength;
+	int order = memcmp(x->key, y->key, length);
+	if (order != 0)
+		return order;
+	return x->keyLength < y->keyLength ? -1 : x->keyLength > y->keyLength;
+}
+
+/*!	 \fn finishGroups
+	 \return NB_OK or NB_NOMEM
+	 \param const struct groupTable* table, struct nb_group** groups, size_t* numGroups
+
+	 Results of every group, ranked worst first. The names are kept in the same allocation. */
+static int finishGroups(const struct groupTable* table, struct nb_group** groups, size_t* numGroups) {
+	size_t keyBytes = 0;
+	for (size_t i = 0; i < table->size; i++)
+		keyBytes += table->groups[i].keyLength + 1;
+
+	struct nb_group* result = (struct nb_group*)malloc(sizeof(struct nb_group) * table->size + keyBytes);
+	if (result == NULL)
+		return NB_NOMEM;
+
+	char* keys = (char*)(result + table->size);
+	for (size_t i = 0; i < table->size; i++) {
+		const struct group* g = &table->groups[i];
+		struct nb_group* r = &result[i];
+		double expected[9];
+		double actual[9];
+
+		memset(r, 0, sizeof(*r));
+		memcpy(keys, g->key, g->keyLength);
+		keys[g->keyLength] = '\0';
+		r->key = keys;
+		r->keyLength = g->keyLength;
+		keys += g->keyLength + 1;
+
+		r->count = g->stats.count;
+		r->rejected = g->rejected;
+		if (r->count == 0)
+			continue;
+		r->arithmeticMean = partialMean(&g->stats);
+		r->standardDeviation = sqrt(g->stats.m2 / g->stats.count);
+		r->rangeMin = g->stats.min;
+		r->rangeMax = g->stats.max;
+		for (int d = 0; d < 9; d++)
+			r->frequency[d] = g->stats.fre[d];
+		calFrequencies(r->frequency, r->count, expected, actual);
+		r->NBVariance = calNBVariance(expected, actual);
+		r->NBDeviation = sqrt(r->NBVariance);
+	}
+
+	qsort(result, table->size, sizeof(struct nb_group), compareGroups);
+	*groups = result;
+	*numGroups = table->size;
+	return NB_OK;
+}
+
+/*!	 \fn groupBuffer
+	 \return NB_OK, NB_NOMEM, NB_COLUMN or NB_EMPTY
+	 \param const char* buf, size_t len - whole table, const struct nb_csv_config* config,
+			struct nb_group** groups, size_t* numGroups */
+static int groupBuffer(const char* buf, size_t len, const struct nb_csv_config* config,
+	struct nb_group** groups, size_t* numGroups) {
+	struct groupTable table;
+
+	int status = groupCsv(buf, len, config, &table);
+	if (status == NB_OK) {
+		status = finishGroups(&table, groups, numGroups);
+		freeGroupTable(&table);
+	}
+	return status;
+}
+
+/*!	 \fn nb_group_stream
+	 \return NB_OK, NB_NOMEM, NB_COLUMN, NB_EMPTY or NB_IO
+	 \param FILE* stream, const struct nb_csv_config* config,
+			struct nb_group** groups, size_t* numGroups - results, release with nb_free_groups
+
+	 Grouped analysis of a CSV table read from a stream (stdin) */
+int nb_group_stream(FILE* stream, const struct nb_csv_config* config, struct nb_group** groups, size_t* numGroups) {
+	char* buf = NULL;
+	size_t len = 0;
+	size_t capacity = 0;
+	int status = NB_OK;
+
+	for (;;) {
+		if (capacity - len < READ_BLOCK) {
+			capacity = capacity == 0 ? READ_BLOCK : capacity * 2;
+			char* grown = (char*)realloc(buf, capacity);
+			if (grown == NULL) {
+				free(buf);
+				return NB_NOMEM;
+			}
+			buf = grown;
+		}
+		size_t got = fread(buf + len, 1, capacity - len, stream);
+		if (got == 0)
+			break;
+		len += got;
+	}
+
+	if (ferror(stream))
+		status = NB_IO;
+	else
+		status = groupBuffer(buf, len, config, groups, numGroups);
+	free(buf);
+	return status;
+}
+
+/*!	 \fn nb_group_file
+	 \return NB_OK, NB_NOMEM, NB_COLUMN, NB_EMPTY or NB_IO (errno is set)
+	 \param const char* fileName, const struct nb_csv_config* config,
+			struct nb_group** groups, size_t* numGroups - results, release with nb_free_groups
+
+	 Grouped analysis of a CSV file. The file is memory-mapped, a file that can not be mapped is read as a stream. */
+int nb_group_file(const char* fileName, const struct nb_csv_config* config, struct nb_group** groups, size_t* numGroups) {
+	struct mappedFile view;
+
+	if (mapFile(fileName, &view)) {
+		int status = groupBuffer(view.data, view.size, config, groups, numGroups);
+		unmapFile(&view);
+		return status;
+	}
+
+	FILE* stream;
+#ifdef _WIN32
+	if (fopen_s(&stream, fileName, "rb") != 0)
+		return NB_IO;
+#else
+	if ((stream = fopen(fileName, "rb")) == NULL)
+		return NB_IO;
+#endif
+	int status = nb_group_stream(stream, config, groups, numGroups);
+	fclose(stream);
+	return status;
+}
+
+/*!	 \fn nb_free_groups
+	 \return none
+	 \param struct nb_group* groups - results of nb_group_file or nb_group_stream, NULL is allowed */
+void nb_free_groups(struct nb_group* groups) {
+	free(groups);
+}
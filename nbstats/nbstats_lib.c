@@ -0,0 +1,1231 @@
+/*!	\file		nbstats_lib.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	nbstats library: one nb_context per analysis.
+	The numbers are tokenized as they come in, and the partial statistics (sum, squares, range, leading digits)
+	are added while they are still in cache. Median and mode are taken by nb_finalize from the kept numbers,
+	which are moved from the tokenizer into a store of config.precision after every block,
+	with stream only the partial statistics and a heavy-hitters summary are kept.
+	With a memory budget the kept numbers are written out as sorted runs whenever they fill a quarter of it
+	(the array may have doubled beyond them, and sorting takes as much again), and nb_finalize takes median,
+	mode and percentiles in one merge of the runs.
+	Compressed input (gzip, zstd) is decompressed on a thread of its own while the blocks it has filled are tokenized.
+	nb_create plans the work of config.statistics: what is not needed for them is neither kept nor calculated.
+*/
+#include "nbstats.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_bootstrap.h"
+#include "nbstats_decompress.h"
+#include "nbstats_digits.h"
+#include "nbstats_mode.h"
+#include "nbstats_nbc.h"
+#include "nbstats_parallel.h"
+#include "nbstats_platform.h"
+#include "nbstats_quantile.h"
+#include "nbstats_sort.h"
+#include "nbstats_spill.h"
+#include "nbstats_stats.h"
+#include "nbstats_store.h"
+#include "nbstats_summary.h"
+#include "nbstats_tokenizer.h"
+#include "nbstats_window.h"
+
+#define INGEST_BLOCK	(1 << 20)	// streams are read, and mapped files handed to the tokenizer, 1MB at a time
+#define HEAVY_HITTERS	1024		// distinct values tracked for the mode with stream
+#define NBC_BLOCK		2048		// .nbc values checked and taken at a time, while in cache
+#define BLOCK_VALUES	(INGEST_BLOCK / 2 + 1)	// most numbers one block of text can hold
+#define DIGIT_TESTS		(1u << NB_TEST_SECOND | 1u << NB_TEST_FIRST_TWO | 1u << NB_TEST_LAST_TWO | 1u << NB_TEST_SUMMATION)
+
+struct nb_context {
+	struct nb_config config;
+	int status;					// first failure, every later call returns it
+	bool finalized;
+	bool reported;				// result holds a finalize or snapshot
+	bool merged;				// holds statistics of other contexts, no median or mode
+	struct tokenizer tok;		// numbers of the last block, until they are taken
+	struct valueStore kept;		// kept numbers, not stream
+	struct partial stats;
+	struct digitTests tests;	// config.digitTests with a distribution only
+	bool testsIncomplete;		// data without the same digit tests was merged, no digit tests
+	struct heavyHitters hitters;	// tracksMode only
+	bool tracksMode;			// stream with the mode wanted: heavy hitters are kept
+	bool partialsOnly;			// stream that keeps nothing but the partial statistics, the numbers are not gathered
+	struct kll sketch;			// config.quantileError only, fed with stream or once merged
+	bool sketchIncomplete;		// data without a sketch was merged, no percentiles
+	struct spill spill;			// config.memoryBudget only: kept numbers written out
+	size_t spillAt;				// kept numbers that are written out as a run
+	struct slidingWindow window;	// config.window only
+	char* pending;				// unfinished token at the end of the last buffer
+	size_t pendingSize;
+	size_t pendingCapacity;
+	struct modes modes;
+	struct nb_result result;
+	struct nb_profile profile;	// config.profile only
+};
+
+// start of a timed phase
+struct phaseStart {
+	double wall;
+	double cpu;
+};
+
+// fractions of the count at the percentiles of nb_result
+static const double quantileFractions[NB_NUM_QUANTILES] = { 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99 };
+
+static const enum nb_reject rejectReasons[] = {
+	[REJECT_NEGATIVE] = NB_REJECT_NEGATIVE,
+	[REJECT_ZERO] = NB_REJECT_ZERO,
+	[REJECT_INFINITY] = NB_REJECT_INFINITY,
+	[REJECT_INVALID] = NB_REJECT_INVALID
+};
+
+static inline bool isSpaceCh(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+/*!	 \fn startPhase
+	 \return none
+	 \param const nb_context* ctx, struct phaseStart* start */
+static inline void startPhase(const nb_context* ctx, struct phaseStart* start) {
+	if (ctx->config.profile) {
+		start->wall = wallSeconds();
+		start->cpu = cpuSeconds();
+	}
+}
+
+/*!	 \fn endPhase
+	 \return none
+	 \param nb_context* ctx, enum nb_phase phase, const struct phaseStart* start, unsigned long long bytes, size_t elements
+
+	 Add the time since start to the phase */
+static void endPhase(nb_context* ctx, enum nb_phase phase, const struct phaseStart* start, unsigned long long bytes, size_t elements) {
+	if (!ctx->config.profile)
+		return;
+
+	struct nb_phase_profile* p = &ctx->profile.phases[phase];
+	p->wallSeconds += wallSeconds() - start->wall;
+	p->cpuSeconds += cpuSeconds() - start->cpu;
+	p->bytes += bytes;
+	p->elements += elements;
+	size_t peak = peakMemory();
+	if (peak > p->peakMemory)
+		p->peakMemory = peak;
+}
+
+/*!	 \fn reportRejection
+	 \return none
+	 \param nb_context* ctx, enum nb_reject reason, size_t index, const char* token, size_t length
+
+	 Count the rejection for the profile and pass it on to the configured handler */
+static void reportRejection(nb_context* ctx, enum nb_reject reason, size_t index, const char* token, size_t length) {
+	ctx->profile.rejected[reason]++;
+	if (ctx->config.onReject != NULL)
+		ctx->config.onReject(ctx->config.rejectCtx, reason, index, token, length);
+}
+
+/*!	 \fn forwardRejection
+	 \return none
+	 \param void* ctx - nb_context, enum rejectReason reason, size_t index, const char* token, size_t length
+
+	 Tokenizer reject handler, passes the rejection on to the configured one */
+static void forwardRejection(void* ctx, enum rejectReason reason, size_t index, const char* token, size_t length) {
+	reportRejection((nb_context*)ctx, rejectReasons[reason], index, token, length);
+}
+
+/*!	 \fn forwardParallelRejection
+	 \return none
+	 \param void* ctx - nb_context, enum rejectReason reason, size_t index - in the scanned buffer, const char* token, size_t length
+
+	 scanParallel numbers the elements of its buffer from 0, continue after the numbers already taken */
+static void forwardParallelRejection(void* ctx, enum rejectReason reason, size_t index, const char* token, size_t length) {
+	nb_context* c = (nb_context*)ctx;
+	reportRejection(c, rejectReasons[reason], c->tok.total + index, token, length);
+}
+
+/*!	 \fn fail
+	 \return status
+	 \param nb_context* ctx, int status
+
+	 Remember the first failure */
+static int fail(nb_context* ctx, int status) {
+	if (ctx->status == NB_OK)
+		ctx->status = status;
+	return ctx->status;
+}
+
+/*!	 \fn planWork
+	 \return none
+	 \param nb_context* ctx - with its config
+
+	 Work out what config.statistics need. Count, moments, range and leading digits are one pass over the numbers
+	 as they come in, whatever is wanted. The numbers are kept only for median, mode, number duplication and exact
+	 percentiles, otherwise the context streams; a stream keeps the heavy hitters only for the mode. */
+static void planWork(nb_context* ctx) {
+	struct nb_config* c = &ctx->config;
+
+	c->statistics &= NB_ALL_STATS;
+	if (c->statistics == 0)
+		c->statistics = NB_ALL_STATS;
+	bool keep = (c->statistics & (1u << NB_STAT_MEDIAN | 1u << NB_STAT_MODE)) != 0
+		|| (c->digitTests & 1u << NB_TEST_DUPLICATION) != 0 || c->quantileError > 0;
+	if (!keep)
+		c->stream = true;
+	ctx->tracksMode = c->stream && (c->statistics & 1u << NB_STAT_MODE) != 0;
+	ctx->partialsOnly = c->stream && !ctx->tracksMode && c->window == 0 && c->quantileError == 0;
+}
+
+/*!	 \fn nb_create
+	 \return new context, NULL if out of memory
+	 \param const struct nb_config* config - NULL for one thread, all numbers kept, no reject reports
+
+	 Start an analysis */
+nb_context* nb_create(const struct nb_config* config) {
+	nb_context* ctx = (nb_context*)calloc(1, sizeof(nb_context));
+	if (ctx == NULL)
+		return NULL;
+
+	if (config != NULL)
+		ctx->config = *config;
+	if (ctx->config.threads == 0)
+		ctx->config.threads = 1;
+	if (ctx->config.window > 0) // the numbers are only kept in the window
+		ctx->config.stream = true;
+	planWork(ctx);
+	if (ctx->config.stream)
+		ctx->config.memoryBudget = 0;
+	if (ctx->config.memoryBudget > 0) { // the runs are long double
+		ctx->config.precision = NB_PRECISION_LD;
+		if (ctx->config.memoryBudget < NB_MIN_MEMORY)
+			ctx->config.memoryBudget = NB_MIN_MEMORY;
+		ctx->spillAt = ctx->config.memoryBudget / 4 / sizeof(long double) - BLOCK_VALUES;
+	}
+	initSpill(&ctx->spill);
+	initStore(&ctx->kept, ctx->config.precision);
+
+	initPartial(&ctx->stats);
+	initDigitTests(&ctx->tests, ctx->config.digitTests & DIGIT_TESTS);
+	if (!initTokenizer(&ctx->tok)) {
+		free(ctx);
+		return NULL;
+	}
+	ctx->tok.onReject = ctx->config.onReject != NULL || ctx->config.profile ? forwardRejection : NULL;
+	ctx->tok.rejectCtx = ctx;
+
+	if (ctx->tracksMode && !initHeavyHitters(&ctx->hitters, HEAVY_HITTERS)) {
+		freeTokenizer(&ctx->tok);
+		free(ctx);
+		return NULL;
+	}
+	if (ctx->config.window > 0
+		&& !initWindow(&ctx->window, ctx->config.window, ctx->config.step, ctx->config.onWindow, ctx->config.windowCtx)) {
+		if (ctx->tracksMode)
+			freeHeavyHitters(&ctx->hitters);
+		freeTokenizer(&ctx->tok);
+		free(ctx);
+		return NULL;
+	}
+	if (ctx->config.quantileError > 0 && !initKll(&ctx->sketch, kllParameter(ctx->config.quantileError))) {
+		if (ctx->config.window > 0)
+			freeWindow(&ctx->window);
+		if (ctx->tracksMode)
+			freeHeavyHitters(&ctx->hitters);
+		freeTokenizer(&ctx->tok);
+		free(ctx);
+		return NULL;
+	}
+	return ctx;
+}
+
+/*!	 \fn nb_destroy
+	 \return none
+	 \param nb_context* ctx - may be NULL
+
+	 Release the context and its result */
+void nb_destroy(nb_context* ctx) {
+	if (ctx == NULL)
+		return;
+	freeTokenizer(&ctx->tok);
+	freeStore(&ctx->kept);
+	if (ctx->tracksMode)
+		freeHeavyHitters(&ctx->hitters);
+	if (ctx->config.window > 0)
+		freeWindow(&ctx->window);
+	if (ctx->config.quantileError > 0)
+		freeKll(&ctx->sketch);
+	freeSpill(&ctx->spill);
+	freeModes(&ctx->modes);
+	free(ctx->pending);
+	free(ctx);
+}
+
+/*!	 \fn takeQuantiles
+	 \return none
+	 \param nb_context* ctx, const long double values[], size_t size
+
+	 Add numbers to the quantile sketch, which is only needed when they may not all be kept */
+static void takeQuantiles(nb_context* ctx, const long double values[], size_t size) {
+	if (ctx->config.quantileError > 0 && (ctx->config.stream || ctx->merged || ctx->config.memoryBudget > 0)
+		&& !addKll(&ctx->sketch, values, size))
+		fail(ctx, NB_NOMEM);
+}
+
+/*!	 \fn spillValues
+	 \return none, a failure is the status of ctx
+	 \param nb_context* ctx
+
+	 With a memory budget, write the kept numbers out as a sorted run once there are spillAt of them */
+static void spillValues(nb_context* ctx) {
+	if (ctx->config.memoryBudget == 0 || ctx->kept.size < ctx->spillAt || ctx->status != NB_OK)
+		return;
+
+	enum spillStatus status = spillRun(&ctx->spill, (long double*)ctx->kept.values, ctx->kept.size);
+	if (status != SPILL_OK) {
+		fail(ctx, status == SPILL_NOMEM ? NB_NOMEM : NB_IO);
+		return;
+	}
+	ctx->kept.size = 0;
+}
+
+/*!	 \fn takeValues
+	 \return none, out of memory is the status of ctx
+	 \param nb_context* ctx
+
+	 Add the numbers just tokenized to the statistics, then keep them in the store (not stream) */
+static void takeValues(nb_context* ctx) {
+	const long double* values = ctx->tok.values;
+	size_t size = ctx->tok.size;
+
+	if (ctx->tests.enabled != 0)
+		addPartialTests(&ctx->stats, &ctx->tests, values, size);
+	else
+		addPartial(&ctx->stats, values, size);
+	takeQuantiles(ctx, values, size);
+	if (ctx->config.stream) {
+		if (ctx->tracksMode)
+			addHeavyHitters(&ctx->hitters, values, size);
+		if (ctx->config.window > 0)
+			addWindow(&ctx->window, values, size);
+	}
+	else if (!appendStore(&ctx->kept, values, size)) {
+		fail(ctx, NB_NOMEM);
+	}
+	ctx->tok.size = 0;
+	ctx->tok.values[0] = 0;
+	spillValues(ctx);
+}
+
+/*!	 \fn scanBlock
+	 \return NB_OK, NB_NOMEM or NB_INVALID
+	 \param nb_context* ctx, const char* buf, size_t len, bool eof - no more input follows, size_t* used - bytes consumed
+
+	 Tokenize one block and take its numbers */
+static int scanBlock(nb_context* ctx, const char* buf, size_t len, bool eof, size_t* used) {
+	struct phaseStart start = { 0, 0 };
+	size_t total = ctx->tok.total;
+
+	startPhase(ctx, &start);
+	int status = scanNumbers(&ctx->tok, buf, len, eof, used);
+	takeValues(ctx);
+	endPhase(ctx, NB_PHASE_INGEST, &start, *used, ctx->tok.total - total);
+	if (status == TOKENIZER_NOMEM)
+		return fail(ctx, NB_NOMEM);
+	if (status == TOKENIZER_INVALID)
+		return fail(ctx, NB_INVALID);
+	return ctx->status;
+}
+
+/*!	 \fn appendPending
+	 \return false if out of memory
+	 \param nb_context* ctx, const char* buf, size_t len
+
+	 Keep the start of a token until the rest of it comes in */
+static bool appendPending(nb_context* ctx, const char* buf, size_t len) {
+	if (len == 0)
+		return true;
+	if (ctx->pendingSize + len > ctx->pendingCapacity) {
+		size_t capacity = ctx->pendingCapacity == 0 ? 64 : ctx->pendingCapacity;
+		while (capacity < ctx->pendingSize + len)
+			capacity *= 2;
+		char* pendingDouble = (char*)realloc(ctx->pending, capacity);
+		if (pendingDouble == NULL)
+			return false;
+		ctx->pending = pendingDouble;
+		ctx->pendingCapacity = capacity;
+	}
+	memcpy(ctx->pending + ctx->pendingSize, buf, len);
+	ctx->pendingSize += len;
+	return true;
+}
+
+/*!	 \fn flushPending
+	 \return NB_OK, NB_NOMEM or NB_INVALID
+	 \param nb_context* ctx
+
+	 End of input, the carried token is complete */
+static int flushPending(nb_context* ctx) {
+	size_t used = 0;
+	int status = NB_OK;
+
+	if (ctx->pendingSize > 0)
+		status = scanBlock(ctx, ctx->pending, ctx->pendingSize, true, &used);
+	ctx->pendingSize = 0;
+	return status;
+}
+
+/*!	 \fn nb_ingest_buffer
+	 \return NB_OK, NB_NOMEM, NB_INVALID or NB_STATE
+	 \param nb_context* ctx, const char* buf, size_t len - white-space separated numbers
+
+	 Add the numbers in buf. A token at the end of buf may continue in the next buffer,
+	 it is taken when its end comes in (or by nb_finalize). */
+int nb_ingest_buffer(nb_context* ctx, const char* buf, size_t len) {
+	size_t at = 0;
+	size_t used = 0;
+
+	if (ctx->status != NB_OK)
+		return ctx->status;
+	if (ctx->finalized)
+		return NB_STATE;
+
+	if (ctx->config.memoryBudget > 0 && len > INGEST_BLOCK) { // a block at a time, so the kept numbers stay in the budget
+		for (size_t block = 0; block < len; block += INGEST_BLOCK) {
+			int status = nb_ingest_buffer(ctx, buf + block, len - block < INGEST_BLOCK ? len - block : INGEST_BLOCK);
+			if (status != NB_OK)
+				return status;
+		}
+		return NB_OK;
+	}
+
+	if (ctx->pendingSize > 0) { // finish the carried token with the start of buf, up to its first white-space
+		while (at < len && !isSpaceCh(buf[at]))
+			at++;
+		if (at == len) { // still not complete
+			if (!appendPending(ctx, buf, len))
+				return fail(ctx, NB_NOMEM);
+			return NB_OK;
+		}
+		if (!appendPending(ctx, buf, ++at))
+			return fail(ctx, NB_NOMEM);
+
+		// white-space ends every token, so all of pending is used
+		int status = scanBlock(ctx, ctx->pending, ctx->pendingSize, false, &used);
+		ctx->pendingSize = 0;
+		if (status != NB_OK)
+			return status;
+	}
+
+	int status = scanBlock(ctx, buf + at, len - at, false, &used);
+	if (status != NB_OK)
+		return status;
+	if (!appendPending(ctx, buf + at + used, len - at - used))
+		return fail(ctx, NB_NOMEM);
+	return NB_OK;
+}
+
+/*!	 \fn nb_ingest_values
+	 \return NB_OK, NB_NOMEM or NB_STATE
+	 \param nb_context* ctx, const long double values[], size_t size - numbers already read
+
+	 Add numbers that need no tokenizing. Numbers that are not positive and finite are rejected as the tokenizer would. */
+int nb_ingest_values(nb_context* ctx, const long double values[], size_t size) {
+	struct phaseStart start = { 0, 0 };
+	size_t total = ctx->tok.total;
+
+	if (ctx->status != NB_OK)
+		return ctx->status;
+	if (ctx->finalized)
+		return NB_STATE;
+	startPhase(ctx, &start);
+
+	for (size_t i = 0; i < size; i++) {
+		long double x = values[i];
+		enum nb_reject reason;
+
+		if (x > 0 && !isinf(x)) {
+			if (ctx->tok.size + 1 == ctx->tok.capacity) {
+				takeValues(ctx); // this empties the array
+				if (ctx->status != NB_OK)
+					return ctx->status;
+			}
+			ctx->tok.values[ctx->tok.size++] = x;
+			ctx->tok.values[ctx->tok.size] = 0;
+			ctx->tok.total++;
+			continue;
+		}
+
+		if (x < 0)
+			reason = NB_REJECT_NEGATIVE;
+		else if (isinf(x))
+			reason = NB_REJECT_INFINITY;
+		else
+			reason = NB_REJECT_ZERO; // 0 and nan
+		reportRejection(ctx, reason, ctx->tok.total, NULL, 0);
+	}
+	takeValues(ctx);
+	endPhase(ctx, NB_PHASE_INGEST, &start, sizeof(long double) * size, ctx->tok.total - total);
+	return ctx->status;
+}
+
+/*!	 \fn ingestCompressed
+	 \return NB_OK, NB_NOMEM, NB_INVALID, NB_IO or NB_FORMAT (damaged, or a compression this build does not decode)
+	 \param nb_context* ctx, enum compression c, const char* data, size_t size - compressed bytes in memory,
+			FILE* stream - the rest of the compressed input, NULL: data is all of it
+
+	 Tokenize the blocks of the decoder while it decompresses the next ones */
+static int ingestCompressed(nb_context* ctx, enum compression c, const char* data, size_t size, FILE* stream) {
+	const char* block;
+	size_t length;
+	int status = NB_OK;
+
+	if (!canDecompress(c))
+		return fail(ctx, NB_FORMAT);
+	struct decoder* d = startDecoder(c, data, size, stream);
+	if (d == NULL)
+		return fail(ctx, NB_NOMEM);
+	while (status == NB_OK && nextBlock(d, &block, &length))
+		status = nb_ingest_buffer(ctx, block, length);
+	int decoded = stopDecoder(d);
+
+	if (status != NB_OK)
+		return status;
+	if (decoded == DECODE_NOMEM)
+		return fail(ctx, NB_NOMEM);
+	if (decoded == DECODE_DAMAGED)
+		return fail(ctx, NB_FORMAT);
+	if (decoded == DECODE_IO)
+		return fail(ctx, NB_IO);
+	return flushPending(ctx); // the end of the decompressed input ends the last token
+}
+
+/*!	 \fn nb_ingest_stream
+	 \return NB_OK, NB_NOMEM, NB_INVALID, NB_IO, NB_FORMAT or NB_STATE
+	 \param nb_context* ctx, FILE* stream - read to the end
+
+	 Add the numbers of a stream that can not be mapped (stdin), read in large blocks.
+	 A stream that starts compressed is decompressed, see ingestCompressed. */
+int nb_ingest_stream(nb_context* ctx, FILE* stream) {
+	char* buf = (char*)malloc(INGEST_BLOCK);
+	int status = NB_OK;
+	bool first = true;
+
+	if (buf == NULL)
+		return fail(ctx, NB_NOMEM);
+
+	for (;;) {
+		struct phaseStart start = { 0, 0 };
+		startPhase(ctx, &start);
+		size_t got = fread(buf, 1, INGEST_BLOCK, stream);
+		endPhase(ctx, NB_PHASE_INGEST, &start, 0, 0); // the bytes count when they are scanned
+		if (got == 0)
+			break;
+		enum compression c = first ? detectCompression(buf, got) : COMPRESSION_NONE;
+		first = false;
+		if (c != COMPRESSION_NONE) { // the decoder reads the rest of the stream
+			status = ingestCompressed(ctx, c, buf, got, stream);
+			break;
+		}
+		status = nb_ingest_buffer(ctx, buf, got);
+		if (status != NB_OK)
+			break;
+	}
+	free(buf);
+
+	if (status == NB_OK && ferror(stream))
+		status = fail(ctx, NB_IO);
+	if (status == NB_OK)
+		status = flushPending(ctx); // end of stream ends the last token
+	return status;
+}
+
+/*!	 \fn ingestParallel
+	 \return NB_OK, NB_NOMEM or NB_INVALID
+	 \param nb_context* ctx, const char* buf, size_t len - whole input
+
+	 Tokenize with config.threads threads, their partial statistics are merged. With partialsOnly the numbers
+	 are not gathered, every thread takes its chunk a block at a time. */
+static int ingestParallel(nb_context* ctx, const char* buf, size_t len) {
+	long double* values = NULL;
+	size_t size = 0;
+	struct partial part;
+
+	int status = scanParallel(buf, len, ctx->config.threads,
+		ctx->config.onReject != NULL || ctx->config.profile ? forwardParallelRejection : NULL, ctx,
+		ctx->partialsOnly ? NULL : &values, &size, &part, ctx->tests.enabled != 0 ? &ctx->tests : NULL);
+	if (status == TOKENIZER_NOMEM)
+		return fail(ctx, NB_NOMEM);
+	if (status == TOKENIZER_INVALID)
+		return fail(ctx, NB_INVALID);
+
+	mergePartial(&ctx->stats, &part);
+	if (ctx->partialsOnly) {
+		ctx->tok.total += size;
+		return ctx->status;
+	}
+	takeQuantiles(ctx, values, size);
+	ctx->tok.total += size;
+	if (!adoptStore(&ctx->kept, values, size)) // the array is taken as it is into an empty store
+		return fail(ctx, NB_NOMEM);
+	return ctx->status;
+}
+
+/*!	 \fn ingestNbc
+	 \return NB_OK, NB_NOMEM or NB_FORMAT
+	 \param nb_context* ctx, const char* data, size_t size - mapped .nbc file
+
+	 Take the values of a .nbc file as they are in the mapping: the statistics read them in place, with their
+	 stored digits. Only the numbers kept for median and mode are copied (double values widened to long double
+	 where long double is wider, then stored as config.precision). A value that the tokenizer would not have
+	 accepted means a damaged file. */
+static int ingestNbc(nb_context* ctx, const char* data, size_t size) {
+	struct nbcView nbc;
+	long double widened[NBC_BLOCK];
+
+	if (!openNbc(data, size, &nbc))
+		return fail(ctx, NB_FORMAT);
+
+	// room for all the values, with a memory budget for the values until the next run
+	size_t keep = nbc.count;
+	if (ctx->config.memoryBudget > 0 && keep > ctx->spillAt + NBC_BLOCK)
+		keep = ctx->spillAt + NBC_BLOCK;
+	if (!ctx->config.stream && !reserveStore(&ctx->kept, ctx->kept.size + keep))
+		return fail(ctx, NB_NOMEM);
+
+	for (size_t at = 0; at < nbc.count; at += NBC_BLOCK) {
+		size_t n = nbc.count - at < NBC_BLOCK ? nbc.count - at : NBC_BLOCK;
+		const unsigned char* digits = nbc.digits != NULL ? nbc.digits + at : NULL;
+		const long double* values = widened;
+
+		if (nbc.native) {
+			values = (const long double*)nbc.values + at;
+		}
+		else {
+			const double* stored = (const double*)nbc.values + at;
+			for (size_t i = 0; i < n; i++)
+				widened[i] = stored[i];
+		}
+
+		for (size_t i = 0; i < n; i++) {
+			if (!(values[i] > 0 && values[i] <= LDBL_MAX) || (digits != NULL && (digits[i] < 1 || digits[i] > 9)))
+				return fail(ctx, NB_FORMAT);
+		}
+
+		if (digits != NULL)
+			addPartialDigits(&ctx->stats, values, digits, n);
+		else
+			addPartial(&ctx->stats, values, n);
+		if (ctx->tests.enabled != 0) // the block is still in cache
+			addDigitTests(&ctx->tests, values, n);
+		takeQuantiles(ctx, values, n);
+		if (ctx->status != NB_OK)
+			return ctx->status;
+		if (ctx->config.stream) {
+			if (ctx->tracksMode)
+				addHeavyHitters(&ctx->hitters, values, n);
+			if (ctx->config.window > 0)
+				addWindow(&ctx->window, values, n);
+		}
+		else {
+			if (!appendStore(&ctx->kept, values, n))
+				return fail(ctx, NB_NOMEM);
+			spillValues(ctx);
+			if (ctx->status != NB_OK)
+				return ctx->status;
+		}
+		ctx->tok.total += n;
+	}
+	return NB_OK;
+}
+
+/*!	 \fn nb_ingest_file
+	 \return NB_OK, NB_NOMEM, NB_INVALID, NB_IO, NB_FORMAT or NB_STATE
+	 \param nb_context* ctx, const char* fileName
+
+	 Add the numbers of a file. The file is memory-mapped and tokenized in place (split over config.threads threads
+	 unless memoryBudget, or stream that keeps more than the partial statistics), a file that can not be mapped is read as a stream. The end of the file ends its last token.
+	 A .nbc file is recognized by its header and taken without tokenizing, a gzip or zstd file by its magic number
+	 and decompressed from the mapping. */
+int nb_ingest_file(nb_context* ctx, const char* fileName) {
+	struct mappedFile view;
+	int status = NB_OK;
+
+	if (ctx->status != NB_OK)
+		return ctx->status;
+	if (ctx->finalized)
+		return NB_STATE;
+
+	if (mapFile(fileName, &view)) {
+		struct phaseStart start = { 0, 0 };
+		size_t total = ctx->tok.total;
+
+		status = flushPending(ctx);
+		enum compression c = detectCompression(view.data, view.size);
+		if (status == NB_OK && c != COMPRESSION_NONE) {
+			status = ingestCompressed(ctx, c, view.data, view.size, NULL);
+		}
+		else if (status == NB_OK && isNbc(view.data, view.size)) {
+			startPhase(ctx, &start);
+			status = ingestNbc(ctx, view.data, view.size);
+			endPhase(ctx, NB_PHASE_INGEST, &start, view.size, ctx->tok.total - total);
+		}
+		else if (status == NB_OK && ctx->config.threads > 1 && (!ctx->config.stream || ctx->partialsOnly)
+			&& ctx->config.memoryBudget == 0) {
+			startPhase(ctx, &start);
+			status = ingestParallel(ctx, view.data, view.size);
+			endPhase(ctx, NB_PHASE_INGEST, &start, view.size, ctx->tok.total - total);
+		}
+		else {
+			for (size_t at = 0; status == NB_OK && at < view.size; at += INGEST_BLOCK) {
+				size_t len = view.size - at < INGEST_BLOCK ? view.size - at : INGEST_BLOCK;
+				status = nb_ingest_buffer(ctx, view.data + at, len);
+			}
+			if (status == NB_OK)
+				status = flushPending(ctx);
+		}
+		unmapFile(&view);
+		return status;
+	}
+
+	FILE* stream;
+#ifdef _WIN32
+	if (fopen_s(&stream, fileName, "rb") != 0)
+		return fail(ctx, NB_IO);
+#else
+	if ((stream = fopen(fileName, "rb")) == NULL)
+		return fail(ctx, NB_IO);
+#endif
+	status = flushPending(ctx);
+	if (status == NB_OK)
+		status = nb_ingest_stream(ctx, stream);
+	fclose(stream);
+	return status;
+}
+
+/*!	 \fn nb_write_nbc
+	 \return NB_OK, NB_NOMEM, NB_INVALID, NB_IO (errno is set) or NB_STATE (stream, numbers beyond the memory budget,
+			 numbers not kept as long double, or after nb_finalize)
+	 \param nb_context* ctx, const char* fileName
+
+	 Write the numbers taken so far as a .nbc file, so later analyses of them need no parsing.
+	 A token left at the end of the last buffer is complete now. The context can take more numbers
+	 and be finalized as usual afterwards. */
+int nb_write_nbc(nb_context* ctx, const char* fileName) {
+	if (ctx->status != NB_OK)
+		return ctx->status;
+	if (ctx->finalized || ctx->config.stream || ctx->merged || ctx->kept.type != NB_PRECISION_LD)
+		return NB_STATE;
+	if (flushPending(ctx) != NB_OK)
+		return ctx->status;
+	if (ctx->spill.numRuns > 0)
+		return NB_STATE;
+
+	if (!writeNbc(fileName, (const long double*)ctx->kept.values, ctx->kept.size))
+		return NB_IO;
+	return NB_OK;
+}
+
+static void addKeptHitters(void* ctx, const long double a[], size_t size) {
+	addHeavyHitters((struct heavyHitters*)ctx, a, size);
+}
+
+// a sketch fed from the kept numbers
+struct sketchFeed {
+	struct kll* sketch;
+	bool ok;
+};
+
+static void addKeptSketch(void* ctx, const long double a[], size_t size) {
+	struct sketchFeed* feed = (struct sketchFeed*)ctx;
+	if (feed->ok)
+		feed->ok = addKll(feed->sketch, a, size);
+}
+
+/*!	 \fn nb_save_summary
+	 \return NB_OK, NB_NOMEM, NB_INVALID, NB_IO (errno is set) or NB_STATE (after nb_finalize or nb_merge,
+			 or a stream without the mode in config.statistics, which keeps no heavy hitters)
+	 \param nb_context* ctx, const char* fileName
+
+	 Write what a streaming analysis keeps of the numbers taken so far as a .nbs summary file.
+	 Without stream the heavy-hitters summary is made from the kept numbers (read back from the runs beyond
+	 the memory budget). The context can take more numbers and be finalized as usual afterwards. */
+int nb_save_summary(nb_context* ctx, const char* fileName) {
+	if (ctx->status != NB_OK)
+		return ctx->status;
+	if (ctx->finalized || ctx->merged || (ctx->config.stream && !ctx->tracksMode))
+		return NB_STATE;
+	if (flushPending(ctx) != NB_OK)
+		return ctx->status;
+
+	const struct kll* sketch = ctx->config.quantileError > 0 ? &ctx->sketch : NULL;
+	if (ctx->config.stream) {
+		if (!writeSummary(fileName, &ctx->stats, &ctx->hitters, sketch))
+			return NB_IO;
+		return NB_OK;
+	}
+
+	// the summaries of the kept numbers, the sketch is kept up to date with a memory budget
+	struct heavyHitters hitters;
+	struct kll kept;
+	if (!initHeavyHitters(&hitters, HEAVY_HITTERS))
+		return NB_NOMEM;
+	enum spillStatus spilled = readRuns(&ctx->spill, ctx->config.memoryBudget / 4, addKeptHitters, &hitters);
+	if (spilled != SPILL_OK) {
+		freeHeavyHitters(&hitters);
+		return spilled == SPILL_NOMEM ? NB_NOMEM : NB_IO;
+	}
+	if (sketch != NULL && ctx->config.memoryBudget == 0) {
+		struct sketchFeed feed = { &kept, initKll(&kept, ctx->sketch.k) };
+		if (feed.ok)
+			visitStore(&ctx->kept, addKeptSketch, &feed);
+		if (!feed.ok) {
+			freeKll(&kept);
+			freeHeavyHitters(&hitters);
+			return NB_NOMEM;
+		}
+		sketch = &kept;
+	}
+	visitStore(&ctx->kept, addKeptHitters, &hitters);
+	bool written = writeSummary(fileName, &ctx->stats, &hitters, sketch);
+	freeHeavyHitters(&hitters);
+	if (sketch == &kept)
+		freeKll(&kept);
+	return written ? NB_OK : NB_IO;
+}
+
+/*!	 \fn nb_load_summary
+	 \return NB_OK, NB_NOMEM, NB_IO, NB_FORMAT or NB_STATE (without stream, or after nb_finalize)
+	 \param nb_context* ctx - stream, const char* fileName - .nbs file of nb_save_summary
+
+	 Add a summary to the context as if its numbers had been taken (Chan et al. for the moments, the
+	 heavy hitters are merged keeping their bounds, the quantile sketches level by level). The order of the
+	 summaries does not change the result, up to the rounding of the moments and the sketch compactions.
+	 A summary without a sketch leaves the context without percentiles, the heavy hitters are only merged
+	 when the mode is wanted. */
+int nb_load_summary(nb_context* ctx, const char* fileName) {
+	static const int statuses[] = {
+		[SUMMARY_OK] = NB_OK,
+		[SUMMARY_NOMEM] = NB_NOMEM,
+		[SUMMARY_IO] = NB_IO,
+		[SUMMARY_FORMAT] = NB_FORMAT
+	};
+	struct summary summary;
+
+	if (ctx->status != NB_OK)
+		return ctx->status;
+	if (ctx->finalized || !ctx->config.stream)
+		return NB_STATE;
+	if (flushPending(ctx) != NB_OK)
+		return ctx->status;
+
+	struct phaseStart start = { 0, 0 };
+	startPhase(ctx, &start);
+	enum summaryStatus status = readSummary(fileName, &summary);
+	if (status == SUMMARY_OK && ctx->tracksMode && !mergeHeavyHitters(&ctx->hitters, summary.hitters, summary.numHitters, summary.bound))
+		status = SUMMARY_NOMEM;
+	if (status == SUMMARY_OK && ctx->config.quantileError > 0) {
+		if (!summary.hasSketch)
+			ctx->sketchIncomplete = ctx->sketchIncomplete || summary.stats.count > 0;
+		else if (!mergeKll(&ctx->sketch, &summary.sketch))
+			status = SUMMARY_NOMEM;
+	}
+	if (status == SUMMARY_OK) {
+		ctx->testsIncomplete = ctx->testsIncomplete || (ctx->tests.enabled != 0 && summary.stats.count > 0);
+		mergePartial(&ctx->stats, &summary.stats);
+		ctx->tok.total += summary.stats.count;
+	}
+	endPhase(ctx, NB_PHASE_MERGE, &start, 0, status == SUMMARY_OK ? summary.stats.count : 0);
+	freeSummary(&summary);
+	if (status != SUMMARY_OK)
+		return fail(ctx, statuses[status]);
+	return NB_OK;
+}
+
+/*!	 \fn nb_merge
+	 \return NB_OK, NB_STATE if dst is finalized or src is neither finalized nor merged into, or the status of src
+	 \param nb_context* dst - aggregate, const nb_context* src
+
+	 Add the count, sum, squares, range and leading digits of src to dst (Chan et al.), and with
+	 config.quantileError of dst the numbers or the quantile sketch of src.
+	 src is not changed, dst reports no median or mode afterwards. */
+int nb_merge(nb_context* dst, const nb_context* src) {
+	if (dst->status != NB_OK)
+		return dst->status;
+	if (dst->finalized)
+		return NB_STATE;
+	if (src->status != NB_OK)
+		return src->status;
+	if (!src->finalized && !src->merged)
+		return NB_STATE;
+
+	struct phaseStart start = { 0, 0 };
+	startPhase(dst, &start);
+	if (dst->config.quantileError > 0) {
+		struct sketchFeed feed = { &dst->sketch, true };
+
+		// the numbers kept so far, without a sketch of them
+		if (!dst->merged && !dst->config.stream && dst->config.memoryBudget == 0) {
+			visitStore(&dst->kept, addKeptSketch, &feed);
+			if (!feed.ok)
+				return fail(dst, NB_NOMEM);
+		}
+		if (!src->config.stream && !src->merged && src->spill.numRuns == 0) {
+			visitStore(&src->kept, addKeptSketch, &feed);
+			if (!feed.ok)
+				return fail(dst, NB_NOMEM);
+		}
+		else if (src->config.quantileError > 0 && !src->sketchIncomplete
+			&& (src->config.stream || src->merged || src->config.memoryBudget > 0)) {
+			if (!mergeKll(&dst->sketch, &src->sketch))
+				return fail(dst, NB_NOMEM);
+		}
+		else {
+			dst->sketchIncomplete = true;
+		}
+	}
+
+	if (src->tests.enabled == dst->tests.enabled && !src->testsIncomplete)
+		mergeDigitTests(&dst->tests, &src->tests);
+	else
+		dst->testsIncomplete = dst->testsIncomplete || dst->tests.enabled != 0;
+	mergePartial(&dst->stats, &src->stats);
+	dst->merged = true;
+	endPhase(dst, NB_PHASE_MERGE, &start, 0, src->stats.count);
+	return NB_OK;
+}
+
+/*!	 \fn quantileIndex
+	 \return index of percentile j in the sorted numbers (nearest rank)
+	 \param int j, size_t size - not 0 */
+static size_t quantileIndex(int j, size_t size) {
+	double rank = ceil(quantileFractions[j] * (double)size);
+	size_t index = rank < 1 ? 0 : (size_t)rank - 1;
+	return index < size ? index : size - 1;
+}
+
+/*!	 \fn exactQuantiles
+	 \return none
+	 \param struct valueStore* kept - rearranged, not empty, long double out[]
+
+	 Nearest rank percentiles of the kept numbers */
+static void exactQuantiles(struct valueStore* kept, long double out[]) {
+	size_t index[NB_NUM_QUANTILES];
+
+	for (int j = 0; j < NB_NUM_QUANTILES; j++)
+		index[j] = quantileIndex(j, kept->size);
+	storeRanks(kept, index, NB_NUM_QUANTILES, out);
+}
+
+// what the merge of the runs looks for, in one pass over the sorted numbers
+struct orderScan {
+	size_t seen;					// numbers before the current block
+	size_t wanted[NB_NUM_QUANTILES + 2];	// indices: the middle one or two, then the percentiles
+	long double found[NB_NUM_QUANTILES + 2];
+	size_t numWanted;
+	bool started;
+	long double value;				// current value and how often it occurred so far
+	size_t count;
+	struct modes* modes;			// values with the top count so far, modes->count
+	size_t modesCapacity;
+	bool nomem;
+};
+
+/*!	 \fn endValue
+	 \return none
+	 \param struct orderScan* scan
+
+	 The current value occurs no more, it may be a mode */
+static void endValue(struct orderScan* scan) {
+	struct modes* m = scan->modes;
+
+	if (scan->count > 1) {
+		m->duplicated++;
+		m->duplicates += scan->count - 1;
+	}
+	if (scan->count > m->count) {
+		m->count = scan->count;
+		m->numModes = 0;
+	}
+	if (scan->count < m->count || scan->nomem)
+		return;
+	if (m->numModes == scan->modesCapacity) {
+		size_t capacity = scan->modesCapacity == 0 ? 16 : scan->modesCapacity * 2;
+		long double* valuesMore = (long double*)realloc(m->values, sizeof(long double) * capacity);
+		if (valuesMore == NULL) {
+			scan->nomem = true;
+			return;
+		}
+		m->values = valuesMore;
+		scan->modesCapacity = capacity;
+	}
+	m->values[m->numModes++] = scan->value;
+}
+
+/*!	 \fn scanOrder
+	 \return none
+	 \param void* ctx - struct orderScan, const long double a[] - next numbers in ascending order, size_t size */
+static void scanOrder(void* ctx, const long double a[], size_t size) {
+	struct orderScan* scan = (struct orderScan*)ctx;
+
+	for (size_t i = 0; i < scan->numWanted; i++) {
+		if (scan->wanted[i] >= scan->seen && scan->wanted[i] - scan->seen < size)
+			scan->found[i] = a[scan->wanted[i] - scan->seen];
+	}
+	for (size_t i = 0; i < size; i++) {
+		if (scan->started && a[i] == scan->value) {
+			scan->count++;
+			continue;
+		}
+		if (scan->started)
+			endValue(scan);
+		scan->started = true;
+		scan->value = a[i];
+		scan->count = 1;
+	}
+	scan->seen += size;
+}
+
+/*!	 \fn orderFromRuns
+	 \return NB_OK, NB_NOMEM or NB_IO
+	 \param nb_context* ctx - with runs, struct nb_result* r
+
+	 Median, modes and percentiles of the numbers beyond the memory budget: the last kept numbers
+	 become a run too, and one merge of all the runs finds them, the same as the kept numbers would give */
+static int orderFromRuns(nb_context* ctx, struct nb_result* r) {
+	struct orderScan scan;
+	size_t size = ctx->stats.count;
+
+	if (ctx->kept.size > 0) {
+		enum spillStatus status = spillRun(&ctx->spill, (long double*)ctx->kept.values, ctx->kept.size);
+		if (status != SPILL_OK)
+			return fail(ctx, status == SPILL_NOMEM ? NB_NOMEM : NB_IO);
+		ctx->kept.size = 0;
+	}
+
+	memset(&scan, 0, sizeof(scan));
+	scan.modes = &ctx->modes;
+	ctx->modes.values = NULL;
+	ctx->modes.numModes = 0;
+	ctx->modes.count = 0;
+	ctx->modes.error = 0;
+	ctx->modes.untracked = 0;
+	ctx->modes.duplicated = 0;
+	ctx->modes.duplicates = 0;
+	scan.wanted[0] = size % 2 == 0 ? size / 2 - 1 : size / 2;
+	scan.wanted[1] = size / 2;
+	scan.numWanted = 2;
+	if (ctx->config.quantileError > 0) {
+		for (int j = 0; j < NB_NUM_QUANTILES; j++)
+			scan.wanted[scan.numWanted++] = quantileIndex(j, size);
+	}
+
+	// the kept numbers are written out, half the budget is for the merge buffers
+	enum spillStatus status = mergeRuns(&ctx->spill, ctx->config.memoryBudget / 2, scanOrder, &scan);
+	if (status != SPILL_OK)
+		return fail(ctx, status == SPILL_NOMEM ? NB_NOMEM : NB_IO);
+	if (scan.started)
+		endValue(&scan);
+	if (scan.nomem)
+		return fail(ctx, NB_NOMEM);
+	if (ctx->modes.count <= 1) // every value occurs once, no mode
+		freeModes(&ctx->modes);
+
+	r->hasMedian = true;
+	r->statisticalMedian = size % 2 == 0 ? (scan.found[0] + scan.found[1]) / 2 : scan.found[0];
+	if (ctx->config.quantileError > 0) {
+		for (int j = 0; j < NB_NUM_QUANTILES; j++)
+			r->quantiles[j] = scan.found[2 + j];
+		r->hasQuantiles = true;
+		r->quantilesExact = true;
+	}
+	return NB_OK;
+}
+
+/*!	 \fn calResult
+	 \return NB_OK, NB_NOMEM or NB_EMPTY (the context stays usable on NB_EMPTY)
+	 \param nb_context* ctx
+
+	 Calculate the statistics of config.statistics from the numbers taken so far. With stream the mode comes from
+	 the heavy-hitters summary, numbers beyond the memory budget are merged back from their runs. */
+static int calResult(nb_context* ctx) {
+	struct nb_result* r = &ctx->result;
+	struct phaseStart start = { 0, 0 };
+	unsigned wanted = ctx->config.statistics;
+	bool median = (wanted & 1u << NB_STAT_MEDIAN) != 0;
+	bool mode = (wanted & 1u << NB_STAT_MODE) != 0;
+	bool duplication = (ctx->config.digitTests & 1u << NB_TEST_DUPLICATION) != 0;
+
+	if (ctx->stats.count == 0)
+		return NB_EMPTY;
+
+	freeModes(&ctx->modes); // of an earlier snapshot
+	memset(r, 0, sizeof(*r));
+	r->statistics = wanted;
+	r->count = ctx->stats.count;
+	if (wanted & 1u << NB_STAT_MEAN)
+		r->arithmeticMean = partialMean(&ctx->stats);
+	if (wanted & 1u << NB_STAT_VARIANCE) {
+		r->variance = ctx->stats.m2 / ctx->stats.count;
+		r->standardDeviation = sqrt(r->variance);
+	}
+	if (wanted & 1u << NB_STAT_RANGE) {
+		r->rangeMin = ctx->stats.min;
+		r->rangeMax = ctx->stats.max;
+	}
+
+	if (ctx->merged) {
+		r->modeUnknown = mode;
+	}
+	else if (ctx->tracksMode) {
+		startPhase(ctx, &start);
+		if (!heavyHitterModes(&ctx->hitters, &ctx->modes))
+			return fail(ctx, NB_NOMEM);
+		r->modeUnknown = ctx->modes.numModes != 0 && ctx->modes.count - ctx->modes.error <= ctx->modes.untracked;
+		endPhase(ctx, NB_PHASE_MODE, &start, 0, ctx->hitters.size);
+	}
+	else if (ctx->config.stream) {
+		// the mode is not wanted, a stream keeps nothing more
+	}
+	else if (ctx->spill.numRuns > 0) { // one merge gives them all
+		startPhase(ctx, &start);
+		if (orderFromRuns(ctx, r) != NB_OK)
+			return ctx->status;
+		endPhase(ctx, NB_PHASE_RUNS, &start, sizeof(long double) * r->count, r->count);
+		if (!median) {
+			r->hasMedian = false;
+			r->statisticalMedian = 0;
+		}
+	}
+	else {
+		size_t bytes = storeBytes(&ctx->kept);
+		if (mode || duplication) {
+			startPhase(ctx, &start);
+			if (!storeModes(&ctx->kept, &ctx->modes))
+				return fail(ctx, NB_NOMEM);
+			endPhase(ctx, NB_PHASE_MODE, &start, bytes, r->count);
+		}
+		if (median) {
+			startPhase(ctx, &start);
+			r->hasMedian = true;
+			r->statisticalMedian = storeMedian(&ctx->kept);
+			endPhase(ctx, NB_PHASE_MEDIAN, &start, bytes, r->count);
+		}
+		if (ctx->config.quantileError > 0) {
+			startPhase(ctx, &start);
+			exactQuantiles(&ctx->kept, r->quantiles);
+			r->hasQuantiles = true;
+			r->quantilesExact = true;
+			endPhase(ctx, NB_PHASE_QUANTILES, &start, bytes, r->count);
+		}
+	}
+	if (ctx->config.quantileError > 0 && !r->quantilesExact && !ctx->sketchIncomplete) {
+		startPhase(ctx, &start);
+		if (!kllQuantiles(&ctx->sketch, quantileFractions, NB_NUM_QUANTILES, r->quantiles))
+			return fail(ctx, NB_NOMEM);
+		r->hasQuantiles = true;
+		endPhase(ctx, NB_PHASE_QUANTILES, &start, sizeof(long double) * ctx->sketch.size, ctx->sketch.size);
+	}
+	if (mode) {
+		r->modes = ctx->modes.values;
+		r->numModes = ctx->modes.numModes;
+		r->modeCount = ctx->modes.count;
+		r->modeError = ctx->modes.error;
+	}
+
+	startPhase(ctx, &start);
+	if (wanted & 1u << NB_STAT_NB) {
+		for (int i = 0; i < 9; i++)
+			r->frequency[i] = ctx->stats.fre[i];
+		calFrequencies(r->frequency, r->count, r->expected, r->actual);
+		r->NBVariance = calNBVariance(r->expected, r->actual);
+		r->NBDeviation = sqrt(r->NBVariance);
+	}
+	for (int t = 0; t < NB_NUM_DIGIT_TESTS && !ctx->testsIncomplete; t++) {
+		if (ctx->config.digitTests & 1u << t)
+			calDigitTest(&ctx->tests, (enum nb_test)t, &r->tests[t]);
+	}
+	if (duplication && !ctx->config.stream && !ctx->merged) {
+		r->hasDuplication = true;
+		r->duplicatedValues = ctx->modes.duplicated;
+		r->duplicateNumbers = ctx->modes.duplicates;
+	}
+	endPhase(ctx, NB_PHASE_BENFORD, &start, 0, r->count);
+
+	if (ctx->config.bootstrap > 0) {
+		startPhase(ctx, &start);
+		if (!bootstrapDigits(ctx->stats.fre, ctx->config.bootstrap, ctx->config.bootstrapThreads, &r->bootstrap))
+			return fail(ctx, NB_NOMEM);
+		r->hasBootstrap = true;
+		endPhase(ctx, NB_PHASE_BOOTSTRAP, &start, 0, ctx->config.bootstrap);
+	}
+	ctx->reported = true;
+	return NB_OK;
+}
+
+/*!	 \fn nb_finalize
+	 \return NB_OK, NB_NOMEM, NB_INVALID, NB_EMPTY or NB_STATE
+	 \param nb_context* ctx
+
+	 End of input, calculate everything */
+int nb_finalize(nb_context* ctx) {
+	if (ctx->status != NB_OK)
+		return ctx->status;
+	if (ctx->finalized)
+		return NB_STATE;
+	if (flushPending(ctx) != NB_OK)
+		return ctx->status;
+	ctx->finalized = true;
+
+	if (ctx->config.window > 0 && ctx->window.total < ctx->window.capacity) // never filled, report what there is
+		reportWindow(&ctx->window);
+	int status = calResult(ctx);
+	return status == NB_OK ? NB_OK : fail(ctx, status);
+}
+
+/*!	 \fn nb_snapshot
+	 \return NB_OK, NB_NOMEM, NB_EMPTY or NB_STATE (not stream, or finalized)
+	 \param nb_context* ctx
+
+	 Calculate everything from the numbers taken so far, and go on taking numbers. A token at the end of the
+	 last buffer that may still continue is not counted yet. Stream only, so that a snapshot costs the size of
+	 the summaries and not of the numbers. */
+int nb_snapshot(nb_context* ctx) {
+	if (ctx->status != NB_OK)
+		return ctx->status;
+	if (ctx->finalized || !ctx->config.stream)
+		return NB_STATE;
+	int status = calResult(ctx);
+	return status == NB_NOMEM ? fail(ctx, status) : status;
+}
+
+/*!	 \fn nb_count
+	 \return numbers taken so far
+	 \param const nb_context* ctx */
+size_t nb_count(const nb_context* ctx) {
+	return ctx->stats.count;
+}
+
+/*!	 \fn nb_result
+	 \return the result, NULL unless nb_finalize (or nb_snapshot) succeeded
+	 \param const nb_context* ctx
+
+	 Results stay valid until nb_destroy, or the next nb_snapshot */
+const struct nb_result* nb_result(const nb_context* ctx) {
+	if (!ctx->reported || ctx->status != NB_OK)
+		return NULL;
+	return &ctx->result;
+}
+
+/*!	 \fn nb_profile
+	 \return times and counters of the phases so far, NULL without config.profile
+	 \param const nb_context* ctx
+
+	 Valid until nb_destroy, the phases that did not run are all 0 */
+const struct nb_profile* nb_profile(const nb_context* ctx) {
+	if (!ctx->config.profile)
+		return NULL;
+	return &ctx->profile;
+}
@@ -5,745 +5,1442 @@
 
 	This  C console application that compiles a set of statistics on a list of numbers, then performs a NewcombBenford (abbr. NB) analysis of the data set.
 	- range [minimum value ... maximum value]
-	- arithmetic mean;  statistical median value
+	- arithmetic mean;  statistical median value
 	- variance (of a discrete random variable)
 	- standard deviation (of a finite population)
 	- mode (including multi-modal lists)
 	- frequency table
+	Several files (or --list) are analyzed at once, one line each plus the aggregate of all of them.
+	A CSV table (--csv) is analyzed per group of rows, the groups ranked by NB deviation.
+	--convert saves the numbers of a file as a .nbc file, which is analyzed later without parsing.
+	--window reports the Newcomb-Benford relationship of the most recent numbers as they come in.
+	--quantiles adds the percentiles p1 ~ p99, approximate ones (--stream, aggregates) within the given rank error.
+	--memory keeps the numbers within a budget, the rest goes to temporary files and the report stays exact.
+	--save-summary keeps a small .nbs summary of the analysis, "nbstats merge" analyzes several summaries together.
+	--precision keeps the numbers for median and percentiles as double or float, in half or a quarter of the memory (float without mode and duplication).
+	--bootstrap resamples the leading digit counts: confidence intervals and p-values of NB deviation, chi-square and MAD.
+	--tests adds the forensic digit tests: second digit, first two and last two digits, summation and number duplication.
+	--profile times every phase of the analysis and reports it on stderr as a table or JSON.
+	--format prints the report as text, JSON or CSV, formatted in memory and written at once.
+	--follow watches a growing file like tail -f: only the new bytes are read, the report is printed again as numbers come in.
+	gzip and zstd input (files and the console) is decompressed on its own thread, in a build with NBSTATS_ZLIB / NBSTATS_ZSTD.
+	--serve runs a daemon on a local socket: named data sets are created, fed, queried and dropped by its clients.
+	--stats reports only the statistics listed, and works out only those: --stats=nb needs neither the numbers nor a sort.
 */
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
 #include <math.h>
-#include <windows.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <float.h>
+#include <stdint.h>
 
-HANDLE hStdin;
-DWORD fdwSaveOldMode;
+#include "nbstats.h"
+#include "nbstats_platform.h"
+#include "nbstats_pool.h"
+#include "nbstats_render.h"
+#include "nbstats_serve.h"
+
+#define DEFAULT_RANK_ERROR	0.01	// sketch of nbstats merge without --quantiles
+#define FOLLOW_BLOCK		(1 << 16)	// bytes read at once from a followed file
+#define FOLLOW_INTERVAL		1.0		// seconds between reports of --follow without --interval and --every
+#define FOLLOW_POLL			0.1		// seconds between two looks at a followed file that did not grow
 
 // struct declaration
 struct output {
-	bool existData;				// terminate null or have data in array 
-	bool placeChk;				// table chart places check - if frequency is 100% , the value is true
-	bool exceed50;				// exceed scale 50%
-	size_t arrSize;
+	size_t arrSize;				// elements of the report
 	int stdOrFile;				// terminate get datas from stdin(1) or file(2)
-	long double arithmeticMean;
-	long double statisticalMedian;
-	long double variance;
-	long double standardDeviation;
-	long double rangeMin;
-	long double rangeMax;
-	long int modeFH;
-	long int numModes;
-	long double *modeNums;
-	long double NBVariance;
-	long double NBDeviation;
-	long int fre_array[9];		// Raw frequency table
-	double expected_array[9];	// Expected frequencies
-	double actual_array[9];		// Actual frequencies
+	const char* fileName;		// of the report (JSON and CSV), NULL: console or summaries
+	double quantileError;		// rank error of approximate percentiles
+	enum renderFormat format;	// --format
+	size_t rejected;			// negative, zero and infinite numbers printRejection reported
+	bool csvHeader;				// the CSV header is written, once even when --follow reports again
 };
 struct output data = { 0 };
 
-long double* getNumbers(int argc, char* argv[]);
-int sortNumbers(long double a[], size_t size);
-int compare_num(void const* pA, void const* pB);
-void calculateArraySize(long double p[]);
-void calculateRange(long double a[], size_t size);
-void calArithmeticMean(long double a[], size_t size);
-void calStatisticalMedian(long double a[], size_t size);
-void calVariance(long double a[], size_t size, long double mean);
-void calStandardDeviation(long double variance);
-int calMode(long double a[], size_t size);
-void frequencyTable(long double a[], size_t size);
-void calNB(double P[], double A[]);
-void printOutput();
+// --profile report format
+enum profileFormat {
+	PROFILE_NONE,
+	PROFILE_TABLE,
+	PROFILE_JSON
+};
+
+// what main times itself, around the phases of the library
+struct runProfile {
+	enum profileFormat format;
+	double startWall;
+	double startCpu;
+	struct nb_phase_profile print;	// report on the console
+	struct nb_profile library;		// phases of the library, summed over the files of a batch
+};
+struct runProfile profile = { 0 };
+
+// command line options
+struct options {
+	const char** fileNames;		// none reads the console
+	size_t numFiles;
+	const char* listName;		// file with one file name per line (--list)
+	unsigned threads;			// ingestion threads, batch workers with several files (--threads N)
+	bool stream;				// constant memory, one pass (--stream)
+	bool csv;					// grouped analysis of a CSV table (--csv)
+	const char* valueColumn;	// column of the numbers (--value-col NAME)
+	const char* groupColumn;	// column of the groups (--group-by NAME), NULL: one group
+	bool convert;				// write the numbers of the first file to the second as .nbc (--convert)
+	size_t window;				// sliding window size (--window N), 0: none
+	size_t step;				// numbers between window reports (--step M), 0: window size
+	const char* summaryName;	// write a .nbs summary (--save-summary FILE)
+	bool merge;					// the files are .nbs summaries analyzed together (nbstats merge)
+	double quantileError;		// percentiles (--quantiles EPS), 0: none
+	size_t memoryBudget;		// bytes for the kept numbers (--memory MB), 0: no limit
+	enum nb_precision precision;	// storage of the kept numbers (--precision=ld|double|float)
+	enum profileFormat profile;	// --profile[=table|json]
+	size_t bootstrap;			// resamples of the leading digit counts (--bootstrap B), 0: none
+	unsigned tests;				// forensic digit tests (--tests LIST), 1 << enum nb_test
+	enum renderFormat format;	// --format=text|json|csv
+	bool follow;				// read the new bytes of a growing file, report again (--follow)
+	double interval;			// seconds between reports of --follow (--interval S), 0: only --every
+	size_t every;				// new numbers between reports of --follow (--every N), 0: only --interval
+	const char* servePath;		// socket of the daemon (--serve PATH), NULL: no daemon
+	unsigned statistics;		// statistics of the report (--stats STATS), 1 << enum nb_stat, 0: all
+};
+
+// one line of the batch report
+struct fileResult {
+	int status;					// NB_OK or the status of the library
+	int error;					// errno with NB_IO
+	size_t invalidIndex;		// element that is not a number with NB_INVALID
+	size_t rejected;			// negative, zero and infinite numbers skipped
+	struct renderBuffer line;	// report of the file with NB_OK, rendered on the worker of the file
+};
+
+// shared by the batch workers, every worker writes only its own aggregate and the results of its tasks
+struct batch {
+	const char** fileNames;
+	bool stream;
+	double quantileError;
+	size_t memoryBudget;		// of each file
+	enum nb_precision precision;
+	bool profile;
+	size_t bootstrap;			// resamples of each file, on the worker of the file
+	unsigned tests;				// counted for every file, so that the aggregates have them
+	unsigned statistics;		// of every file and the aggregates
+	enum renderFormat format;	// of the lines of the files
+	struct nb_profile* profiles;	// one per worker, --profile only
+	struct fileResult* results;
+	nb_context** aggregates;	// one per worker
+	size_t* mergedFiles;		// files merged into each aggregate
+};
+
+void parseOptions(int argc, char* argv[], struct options* opts);
+void usageError();
+void printRejection(void* ctx, enum nb_reject reason, size_t index, const char* token, size_t length);
+int getNumbers(nb_context* ctx, const struct options* opts);
+bool readList(const char* listName, struct options* opts);
+void countRejection(void* ctx, enum nb_reject reason, size_t index, const char* token, size_t length);
+void analyzeFile(void* arg, unsigned worker, size_t task);
+void renderFileLine(struct renderBuffer* line, enum renderFormat format, const char* fileName,
+	const struct fileResult* result, const struct nb_result* r);
+const char* fileError(const struct fileResult* result, char* message, size_t size);
+int runBatch(const struct options* opts);
+int runGroups(const struct options* opts);
+int runConvert(const struct options* opts);
+int runMerge(const struct options* opts);
+int runFollow(const struct options* opts);
+int runServe(const struct options* opts);
+int saveSummary(nb_context* ctx, const char* fileName);
+void printWindow(void* ctx, const struct nb_window* w);
+size_t parseCount(const char* arg, const char* what);
+enum nb_precision parsePrecision(const char* arg);
+unsigned parseTests(const char* arg);
+unsigned parseStats(const char* arg);
+enum renderFormat parseFormat(const char* arg);
+void addProfile(struct nb_profile* dst, const struct nb_profile* src);
+void startPrint(double* wall, double* cpu);
+void endPrint(double wall, double cpu);
+void printPhase(const char* name, const struct nb_phase_profile* p, bool last);
+void printProfile();
+void reportProfile(const nb_context* ctx);
+void printBanner();
+bool printReport(const struct nb_result* r);
 
 int main(int argc, char* argv[]) {
+	struct options opts;
+	struct nb_config config = { 0 };
+
 	// 1. print program info 
-	printOutput(data);
+	parseOptions(argc, argv, &opts);
+	profile.format = opts.profile;
+	profile.startWall = wallSeconds();
+	profile.startCpu = cpuSeconds();
+	data.quantileError = opts.quantileError;
+	data.format = opts.format;
+	data.fileName = opts.numFiles == 1 && !opts.merge ? opts.fileNames[0] : NULL;
+	bool batch = opts.numFiles > 1 || opts.listName != NULL;
+	if (batch || opts.csv) // thousands of lines: one write per buffer instead of one per printf
+		setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+	if (opts.format == RENDER_TEXT && opts.servePath == NULL)
+		useUtf8Console(); // the box drawing of the text report is UTF-8, json and csv are left alone
+	if (opts.format == RENDER_TEXT)
+		printBanner();
+	if (opts.csv)
+		return runGroups(&opts);
+	if (opts.convert)
+		return runConvert(&opts);
+	if (opts.merge)
+		return runMerge(&opts);
+	if (opts.follow)
+		return runFollow(&opts);
+	if (opts.servePath != NULL)
+		return runServe(&opts);
+	if (batch)
+		return runBatch(&opts);
+
+	// 2. analysis of the nbstats library
+	config.threads = opts.threads;
+	config.stream = opts.stream;
+	config.onReject = printRejection;
+	config.window = opts.window;
+	config.step = opts.step;
+	config.onWindow = printWindow;
+	config.quantileError = opts.quantileError;
+	config.memoryBudget = opts.memoryBudget;
+	config.precision = opts.precision;
+	config.profile = opts.profile != PROFILE_NONE;
+	config.bootstrap = opts.bootstrap;
+	config.bootstrapThreads = opts.threads;
+	config.digitTests = opts.tests;
+	config.statistics = opts.statistics;
+	nb_context* ctx = nb_create(&config);
+	if (ctx == NULL) {
+		printf("Error: out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	// 3. get numbers from file or console
+	int status = getNumbers(ctx, &opts);
+	if (status == NB_OK && opts.summaryName != NULL)
+		status = saveSummary(ctx, opts.summaryName);
+	// 4. calculate range, mean, median, variance, standard deviation, mode, frequencies and NB Deviation
+	if (status == NB_OK)
+		status = nb_finalize(ctx);
 
-	// 2. get numbers from file or console
-	long double* numsArray = getNumbers(argc, argv);
-	if (numsArray == NULL) { // if didn't get any number, program will terminate
+	if (status == NB_EMPTY) { // If didn'y get any numbers
+		printf("Data set is empty! \n");
+	}
+	else if (status == NB_NOMEM) {
+		printf("Error: out of memory\n");
+	}
+	else if (status == NB_FORMAT) {
+		printf("Error: <%s> is not a valid .nbc or compressed file\n", opts.numFiles > 0 ? opts.fileNames[0] : "stdin");
+	}
+	else if (status == NB_IO && opts.memoryBudget > 0) {
+		printf("error <temporary file> ");
+		perror(" ");
+	}
+	if (status != NB_OK) { // NB_INVALID is reported by printRejection, NB_IO by saveSummary
+		reportProfile(ctx);
+		nb_destroy(ctx);
 		return EXIT_FAILURE;
 	}
-	else { // Succeed in getting numbers
-		data.existData = true;
-	}
-
-	// 3. calculate size that how many numbers we got
-	calculateArraySize(numsArray);
-	// 4. sort numbers
-	sortNumbers(numsArray, data.arrSize);
-	// 5. calculate Arithmetic Mean
-	calArithmeticMean(numsArray, data.arrSize);
-	// 6. calculate Statistical Median
-	calStatisticalMedian(numsArray, data.arrSize);
-	// 7. calculate Variance
-	calVariance(numsArray, data.arrSize, data.arithmeticMean);
-	// 8. calculate Standard Deviation
-	calStandardDeviation(data.variance);
-	// 9. calculate range
-	calculateRange(numsArray, data.arrSize);
-	// 10. calculate mode
-	calMode(numsArray, data.arrSize);
-	// 11. calculate  raw frequency, expected frequencies , actual frequencies 
-	frequencyTable(numsArray, data.arrSize);
-	// 12. calculate NB Deviation
-	calNB(data.expected_array, data.actual_array);
-	// 13. print all the statistics on a list of numbers and table/graph
-	printOutput(data);
-
-	free(numsArray);
-	free(data.modeNums);
-
-	return 0;
+
+	// 5. print all the statistics on a list of numbers and table/graph
+	bool printed = printReport(nb_result(ctx));
+
+	reportProfile(ctx);
+	nb_destroy(ctx);
+
+	return printed ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-/*!	 \fn long double* getNumbers
-	 \return numbers
-	 \param int argc, char* argv[]
-
-	 if argc is 1 get numbers from console, if argc is 2 get numbers from file
-	 If get any character(non-digits), program will terminated.				*/
-long double* getNumbers(int argc, char* argv[]) {
-	FILE* stream;
-	errno_t err;
-	bool chInNum = false; // determin the number include non-digit
-	int ch = 0;
-	size_t capacity_c = 4; // character
-	size_t capacity_l = 4; // numbers
-	size_t size = 0;
-	size_t sizeCh = 0;
-	char* chars = (char*)malloc(capacity_c + 1);
-	long double* numbers = malloc((sizeof(long double) *capacity_l));
-
-	if (argc > 2) { // error
-		printf("Error: too many command-line arguments (%d)\n", argc);
-		printf(
-			"Error: invalid command line.\n"
-			"Usage: nbstats [filename]\n"
-		);
+/*!	 \fn parseOptions
+	 \return none
+	 \param int argc, char* argv[], struct options* opts
+
+	 nbstats [--threads N | --stream | --memory MB] [--quantiles EPS] [--precision=ld|double|float] [--bootstrap B]
+			 [--tests LIST] [--stats STATS] [--format=text|json|csv] [--profile[=table|json]] [--list files.txt] [filename ...]
+	 nbstats --csv --value-col NAME [--group-by NAME] [--threads N] [filename]
+	 nbstats --convert [--threads N] in.txt out.nbc
+	 nbstats --window N [--step M] [--tests LIST] [--stats STATS] [filename]
+	 nbstats [--stream | --window N ...] --save-summary out.nbs [filename]
+	 nbstats --follow [--interval S] [--every N] [--threads N] [--quantiles EPS] [--bootstrap B] [--tests LIST]
+			 [--stats STATS] [--format=text|json|csv] filename
+	 nbstats --serve PATH [--threads N] [--quantiles EPS] [--bootstrap B] [--tests LIST] [--stats STATS]
+	 nbstats merge [--quantiles EPS] [--bootstrap B] [--stats STATS] [--format=text|json|csv] [--save-summary out.nbs]
+			 a.nbs b.nbs ...
+	 Invalid command line terminates the program. */
+void parseOptions(int argc, char* argv[], struct options* opts) {
+	opts->fileNames = (const char**)malloc(argc * sizeof(const char*));
+	opts->numFiles = 0;
+	opts->listName = NULL;
+	opts->threads = 0;
+	opts->stream = false;
+	opts->csv = false;
+	opts->valueColumn = NULL;
+	opts->groupColumn = NULL;
+	opts->convert = false;
+	opts->window = 0;
+	opts->step = 0;
+	opts->summaryName = NULL;
+	opts->quantileError = 0;
+	opts->memoryBudget = 0;
+	opts->precision = NB_PRECISION_LD;
+	opts->profile = PROFILE_NONE;
+	opts->bootstrap = 0;
+	opts->tests = 0;
+	opts->format = RENDER_TEXT;
+	opts->follow = false;
+	opts->interval = 0;
+	opts->every = 0;
+	opts->servePath = NULL;
+	opts->statistics = 0;
+	opts->merge = argc > 1 && strcmp(argv[1], "merge") == 0;
+	if (opts->fileNames == NULL) {
+		printf("Error: out of memory\n");
 		exit(EXIT_FAILURE);
 	}
-	else if (argc == 1) { //stdin
-		stream = stdin;
-		data.stdOrFile = 1;
-	}
-	else if (argc == 2) { // file
-		data.stdOrFile = 2;
-		// Open the file in binary read mode.
-		if ((err = fopen_s(&stream, argv[1], "rb")) != 0) {
-			printf("error <%s> ", argv[1]);
-			perror(" ");
-			exit(EXIT_FAILURE);
-		}
-	}
 
-	while ((ch = fgetc(stream)) != EOF) {
-		if (ch == '-') { // reject the negative number
-			chars[sizeCh++] = ch;
-			ch = fgetc(stream);
-
-			if (isdigit(ch) || ch == '.') {  // reject the negative number
-				while (isdigit(ch) || ch == '.') {
-					if (sizeCh == capacity_c) {
-						char* charsDouble = (char*)realloc(chars, (capacity_c *= 2) + 1);
-						if (charsDouble == NULL) {
-							free(chars);
-							return NULL;
-						}
-						chars = charsDouble;
-					}
-					chars[sizeCh++] = ch;
-					ch = fgetc(stream);
-				}
+	for (int i = opts->merge ? 2 : 1; i < argc; i++) {
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			char* end;
+			long threads = strtol(argv[++i], &end, 10);
+			if (*end != '\0' || threads < 1 || threads > 1024) {
+				printf("Error: invalid number of threads <%s>\n", argv[i]);
+				exit(EXIT_FAILURE);
 			}
-			else {  // terminate when input special characters
-				while (!isspace(ch)) { // characters
-					if (sizeCh == capacity_c) {
-						char* charsDouble = (char*)realloc(chars, (capacity_c *= 2) + 1);
-						if (charsDouble == NULL) {
-							free(chars);
-							return NULL;
-						}
-						chars = charsDouble;
-					}
-					chars[sizeCh++] = ch;
-					ch = fgetc(stream);
-				}
-
-				chars[sizeCh] = '\0';
-				printf("Error: failure reading element %u \n", size);
-				printf("\tLength = %u \n", sizeCh);
-				printf("\tValue = \"%s\" \n", chars);
+			opts->threads = (unsigned)threads;
+		}
+		else if (strcmp(argv[i], "--stream") == 0) {
+			opts->stream = true;
+		}
+		else if (strcmp(argv[i], "--list") == 0 && i + 1 < argc && opts->listName == NULL) {
+			opts->listName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+			opts->window = parseCount(argv[++i], "window size");
+		}
+		else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+			opts->step = parseCount(argv[++i], "step");
+		}
+		else if (strcmp(argv[i], "--convert") == 0) {
+			opts->convert = true;
+		}
+		else if (strcmp(argv[i], "--quantiles") == 0 && i + 1 < argc) {
+			char* end;
+			opts->quantileError = strtod(argv[++i], &end);
+			if (*end != '\0' || !(opts->quantileError > 0 && opts->quantileError <= 0.5)) {
+				printf("Error: invalid rank error <%s>, e.g. 0.01\n", argv[i]);
 				exit(EXIT_FAILURE);
 			}
-			chars[sizeCh] = '\0';
-			printf("Error: rejected #%u <%s>\n", size, chars);
-
-			// initialize chars array
-			sizeCh = 0;
-			chars[sizeCh] = '\0';
-		} // negativer number or character
-		else if (ch == '0') { // reject 0 BUT accept 0.00 float number
-			chars[sizeCh++] = ch;
-			ch = fgetc(stream);
-
-			while (ch != EOF && !isspace(ch)) {
-				if (sizeCh == capacity_c) {
-					char* charsDouble = (char*)realloc(chars, (capacity_c *= 2) + 1);
-					if (charsDouble == NULL) {
-						free(chars);
-						return NULL;
-					}
-					chars = charsDouble;
-				}
-				chars[sizeCh++] = ch;
-				ch = fgetc(stream);
+		}
+		else if (strcmp(argv[i], "--memory") == 0 && i + 1 < argc) {
+			size_t megabytes = parseCount(argv[++i], "memory budget (MB)");
+			if (megabytes > SIZE_MAX >> 20 || megabytes << 20 < NB_MIN_MEMORY) {
+				printf("Error: memory budget <%s> below %zu MB\n", argv[i], NB_MIN_MEMORY >> 20);
+				exit(EXIT_FAILURE);
 			}
-			// end of array
-			chars[sizeCh] = '\0';
-
-			if ((size + 1) == capacity_l) {
-				long double* numbersDouble = (long double*)realloc(numbers, (sizeof(long double) * (capacity_l *= 2)));
-				if (numbersDouble == NULL) {
-					free(numbers);
-					return NULL;
-				}
-				numbers = numbersDouble;
+			opts->memoryBudget = megabytes << 20;
+		}
+		else if (strncmp(argv[i], "--precision=", 12) == 0) {
+			opts->precision = parsePrecision(argv[i] + 12);
+		}
+		else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc) {
+			opts->precision = parsePrecision(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--bootstrap") == 0 && i + 1 < argc) {
+			opts->bootstrap = parseCount(argv[++i], "number of resamples");
+		}
+		else if (strncmp(argv[i], "--tests=", 8) == 0) {
+			opts->tests |= parseTests(argv[i] + 8);
+		}
+		else if (strcmp(argv[i], "--tests") == 0 && i + 1 < argc) {
+			opts->tests |= parseTests(argv[++i]);
+		}
+		else if (strncmp(argv[i], "--stats=", 8) == 0) {
+			opts->statistics |= parseStats(argv[i] + 8);
+		}
+		else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+			opts->statistics |= parseStats(argv[++i]);
+		}
+		else if (strncmp(argv[i], "--format=", 9) == 0) {
+			opts->format = parseFormat(argv[i] + 9);
+		}
+		else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+			opts->format = parseFormat(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--profile") == 0 || strcmp(argv[i], "--profile=table") == 0) {
+			opts->profile = PROFILE_TABLE;
+		}
+		else if (strcmp(argv[i], "--profile=json") == 0) {
+			opts->profile = PROFILE_JSON;
+		}
+		else if (strcmp(argv[i], "--save-summary") == 0 && i + 1 < argc && opts->summaryName == NULL) {
+			opts->summaryName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--follow") == 0) {
+			opts->follow = true;
+		}
+		else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+			char* end;
+			opts->interval = strtod(argv[++i], &end);
+			if (*end != '\0' || !(opts->interval >= 0.01 && opts->interval <= 86400)) {
+				printf("Error: invalid interval <%s>, seconds from 0.01 to 86400\n", argv[i]);
+				exit(EXIT_FAILURE);
 			}
+		}
+		else if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+			opts->every = parseCount(argv[++i], "number of new elements");
+		}
+		else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc && opts->servePath == NULL) {
+			opts->servePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--csv") == 0) {
+			opts->csv = true;
+		}
+		else if (strcmp(argv[i], "--value-col") == 0 && i + 1 < argc) {
+			opts->valueColumn = argv[++i];
+		}
+		else if (strcmp(argv[i], "--group-by") == 0 && i + 1 < argc) {
+			opts->groupColumn = argv[++i];
+		}
+		else if (strncmp(argv[i], "--", 2) == 0) {
+			usageError();
+		}
+		else {
+			opts->fileNames[opts->numFiles++] = argv[i];
+		}
+	}
 
-			if (atof(chars) > 0)
-				sscanf_s(chars, "%Lf", &numbers[size++]);
-			else
-				printf("Error: rejected #%u <%s>\n", size, chars);
-
-			sizeCh = 0;
-			chars[sizeCh] = '\0';
-		}
-		else if (isdigit(ch) == 0 && !isspace(ch)) { // ALPHBET or special characters
-			while (ch != EOF && !isspace(ch)) {
-				if (sizeCh == capacity_c) {
-					char* charsDouble = (char*)realloc(chars, (capacity_c *= 2) + 1);
-					if (charsDouble == NULL) {
-						free(chars);
-						return NULL;
-					}
-					chars = charsDouble;
-				}
-				chars[sizeCh++] = ch;
-				ch = fgetc(stream);
-			}
-			chars[sizeCh] = '\0';
-
-			if ((size + 1) == capacity_l) {
-				long double* numbersDouble = (long double*)realloc(numbers, (sizeof(long double) * (capacity_l *= 2)));
-				if (numbersDouble == NULL) {
-					free(numbers);
-					return NULL;
-				}
-				numbers = numbersDouble;
-			}
+	// --serve keeps stream data sets fed by its clients, the format is chosen by every query
+	if (opts->servePath != NULL && (opts->numFiles != 0 || opts->listName != NULL || opts->follow || opts->stream
+		|| opts->window != 0 || opts->memoryBudget != 0 || opts->precision != NB_PRECISION_LD || opts->summaryName != NULL
+		|| opts->profile != PROFILE_NONE || opts->format != RENDER_TEXT || opts->csv || opts->convert || opts->merge))
+		usageError();
+	// --follow reads one file as a stream, whose summaries cost the same at every report
+	if (opts->follow) {
+		if (opts->numFiles != 1 || opts->listName != NULL || opts->window != 0 || opts->summaryName != NULL
+			|| opts->profile != PROFILE_NONE)
+			usageError();
+		opts->stream = true;
+		if (opts->interval == 0 && opts->every == 0)
+			opts->interval = FOLLOW_INTERVAL;
+	}
+	else if (opts->interval != 0 || opts->every != 0) {
+		usageError();
+	}
+	// --value-col and --group-by only with --csv, which reads one table
+	if (opts->csv != (opts->valueColumn != NULL) || (opts->groupColumn != NULL && !opts->csv)
+		|| (opts->csv && (opts->numFiles > 1 || opts->listName != NULL || opts->stream || opts->quantileError != 0)))
+		usageError();
+	// --convert reads one file and writes one
+	if (opts->convert && (opts->numFiles != 2 || opts->listName != NULL || opts->stream || opts->csv || opts->quantileError != 0))
+		usageError();
+	// --window watches one stream of numbers
+	if ((opts->step != 0 && opts->window == 0)
+		|| (opts->window != 0 && (opts->numFiles > 1 || opts->listName != NULL || opts->csv || opts->convert)))
+		usageError();
+	// --memory keeps the numbers of the files it reads
+	if (opts->memoryBudget != 0 && (opts->stream || opts->csv || opts->convert || opts->merge || opts->window != 0))
+		usageError();
+	// --precision is the storage of the kept numbers, the runs of --memory and .nbc files are long double
+	if (opts->precision != NB_PRECISION_LD
+		&& (opts->stream || opts->csv || opts->convert || opts->merge || opts->window != 0 || opts->memoryBudget != 0))
+		usageError();
+	// mode and duplication count the stored numbers: float merges numbers closer than 2^-24 of their value (cents from
+	// about 1.7e5 on), double those closer than 2^-53 (more than 15 significant digits, where long double is wider)
+	if (opts->precision != NB_PRECISION_LD
+		&& (opts->statistics == 0 || (opts->statistics & 1u << NB_STAT_MODE) != 0 || (opts->tests & 1u << NB_TEST_DUPLICATION) != 0)) {
+		if (opts->precision == NB_PRECISION_FLOAT) {
+			printf("Error: --precision=float counts different numbers as one value for the mode and the duplication test,\n"
+				"       choose --stats without mode and --tests without duplication\n");
+			exit(EXIT_FAILURE);
+		}
+		if (LDBL_MANT_DIG > DBL_MANT_DIG)
+			fprintf(stderr, "Warning: --precision=double counts numbers closer than 2^-53 of their value as one value "
+				"for the mode and the duplication test\n");
+	}
+	// --profile and --bootstrap of the analyses of numbers
+	if ((opts->profile != PROFILE_NONE || opts->bootstrap != 0) && (opts->csv || opts->convert))
+		usageError();
+	// --tests counts digits while the numbers are read, summaries do not keep them
+	if (opts->tests != 0 && (opts->csv || opts->convert || opts->merge))
+		usageError();
+	// --stats of the report of numbers, a summary needs the mode (heavy hitters) of the stream
+	if (opts->statistics != 0 && (opts->csv || opts->convert
+		|| (opts->summaryName != NULL && (opts->statistics & 1u << NB_STAT_MODE) == 0)))
+		usageError();
+	// --format of the report, grouped tables and window reports are lines of text
+	if (opts->format != RENDER_TEXT && (opts->csv || opts->convert || opts->window != 0))
+		usageError();
+	// --save-summary of one analysis, merge reads summaries only
+	if ((opts->summaryName != NULL && (opts->numFiles > 1 || opts->listName != NULL || opts->csv || opts->convert) && !opts->merge)
+		|| (opts->merge && (opts->numFiles == 0 || opts->listName != NULL || opts->threads != 0 || opts->stream || opts->csv
+			|| opts->convert || opts->window != 0)))
+		usageError();
+
+	if (opts->listName != NULL && !readList(opts->listName, opts))
+		exit(EXIT_FAILURE);
+}
 
-			if (atof(chars) > 0) { // float number
-				sscanf_s(chars, "%Lf", &numbers[size++]);
-				sizeCh = 0;
-				chars[sizeCh] = '\0';
-			}
-			else { // error terminate
-				chars[sizeCh] = '\0';
-				printf("Error: failure reading element %u \n", size);
-				printf("\tLength = %u \n", sizeCh);
-				printf("\tValue = \"%s\" \n", chars);
-				exit(EXIT_FAILURE);
-			}
+/*!	 \fn parseCount
+	 \return the number, terminates the program if arg is not a positive whole number
+	 \param const char* arg, const char* what - name for the error message */
+size_t parseCount(const char* arg, const char* what) {
+	char* end;
+	unsigned long long count = strtoull(arg, &end, 10);
 
-		}  // if ALPHBET
-		else if (isdigit(ch)) { // numbers
-			while (isdigit(ch) || ch == '.' || isalpha(ch)) { // int and float number
-				if (sizeCh == capacity_c) {
-					char* charsDouble = (char*)realloc(chars, (capacity_c *= 2) + 1);
-					if (charsDouble == NULL) {
-						free(chars);
-						return NULL;
-					}
-					chars = charsDouble;
-				}
-				if ((isdigit(ch) || ch == '.') && chInNum == false) {
-					chars[sizeCh++] = ch;
-				}
-				else {
-					chInNum = true;
-				}
-
-				ch = fgetc(stream);
-			}//while
-
-			if (isspace(ch))
-				ungetc(ch, stream);
-
-			if ((size + 1) == capacity_l) {
-				long double* numbersDouble = (long double*)realloc(numbers, (sizeof(long double) * (capacity_l *= 2)));
-				if (numbersDouble == NULL) {
-					free(numbers);
-					return NULL;
-				}
-				numbers = numbersDouble;
-			}
+	if (*end != '\0' || *arg == '-' || count == 0 || count > SIZE_MAX / sizeof(long double)) {
+		printf("Error: invalid %s <%s>\n", what, arg);
+		exit(EXIT_FAILURE);
+	}
+	return (size_t)count;
+}
 
-			chars[sizeCh] = '\0';
+/*!	 \fn parsePrecision
+	 \return storage type of the kept numbers, terminates the program if arg is not ld, double or float
+	 \param const char* arg */
+enum nb_precision parsePrecision(const char* arg) {
+	if (strcmp(arg, "ld") == 0)
+		return NB_PRECISION_LD;
+	if (strcmp(arg, "double") == 0)
+		return NB_PRECISION_DOUBLE;
+	if (strcmp(arg, "float") == 0)
+		return NB_PRECISION_FLOAT;
+	printf("Error: invalid precision <%s>, ld, double or float\n", arg);
+	exit(EXIT_FAILURE);
+}
 
-			if (sizeCh > 0) {
-				long double num = 0;
-				sscanf_s(chars, "%Lf", &num);
+/*!	 \fn parseTests
+	 \return 1 << enum nb_test of every test in arg, terminates the program if a name is unknown
+	 \param const char* arg - comma separated: second, first-two, last-two, summation, duplication or all */
+unsigned parseTests(const char* arg) {
+	static const char* const names[NB_NUM_TESTS] = { "second", "first-two", "last-two", "summation", "duplication" };
+	unsigned tests = 0;
 
-				if (isinf(num)) { // inf = INFINITY skip
-					numbers[size] = 0;
-					printf("Error: rejected # %u <%s> = INFINITY\n", size++, chars);
-				}
-				else {
-					numbers[size++] = num;
-				}
+	while (true) {
+		size_t length = strcspn(arg, ",");
+		int t = 0;
 
-				sizeCh = 0;
-				capacity_c = 4;
-				chars[sizeCh] = '\0';
-			}
-		} // numbers
+		if (length == 3 && strncmp(arg, "all", 3) == 0) {
+			tests |= (1u << NB_NUM_TESTS) - 1;
+		}
 		else {
-			// Initialize
-			chInNum = false;
+			while (t < NB_NUM_TESTS && !(strlen(names[t]) == length && strncmp(arg, names[t], length) == 0))
+				t++;
+			if (t == NB_NUM_TESTS) {
+				printf("Error: invalid tests <%s>, second, first-two, last-two, summation, duplication or all\n", arg);
+				exit(EXIT_FAILURE);
+			}
+			tests |= 1u << t;
 		}
+		if (arg[length] == '\0')
+			return tests;
+		arg += length + 1;
 	}
+}
 
-	if (ch == EOF && size == 0) { // If didn'y get any numbers
-		printf("Data set is empty! \n");
-		exit(EXIT_FAILURE);
-	}
+/*!	 \fn parseStats
+	 \return 1 << enum nb_stat of every statistic in arg, terminates the program if a name is unknown
+	 \param const char* arg - comma separated: mean, variance, range, median, mode, nb or all */
+unsigned parseStats(const char* arg) {
+	static const char* const names[NB_NUM_STATS] = { "mean", "variance", "range", "median", "mode", "nb" };
+	unsigned statistics = 0;
 
-	fclose(stream);
-	free(chars);
-	numbers[size] = 0; // end of array
-	return numbers;
+	while (true) {
+		size_t length = strcspn(arg, ",");
+		int s = 0;
+
+		if (length == 3 && strncmp(arg, "all", 3) == 0) {
+			statistics |= NB_ALL_STATS;
+		}
+		else {
+			while (s < NB_NUM_STATS && !(strlen(names[s]) == length && strncmp(arg, names[s], length) == 0))
+				s++;
+			if (s == NB_NUM_STATS) {
+				printf("Error: invalid statistics <%s>, mean, variance, range, median, mode, nb or all\n", arg);
+				exit(EXIT_FAILURE);
+			}
+			statistics |= 1u << s;
+		}
+		if (arg[length] == '\0')
+			return statistics;
+		arg += length + 1;
+	}
 }
 
-/*!	 \fn sortNumbers
-	 \return 0
-	 \param long double a[] - numbers array, size_t size - how many numbers in array
+/*!	 \fn parseFormat
+	 \return format of the report, terminates the program if arg is not text, json or csv
+	 \param const char* arg */
+enum renderFormat parseFormat(const char* arg) {
+	if (strcmp(arg, "text") == 0)
+		return RENDER_TEXT;
+	if (strcmp(arg, "json") == 0)
+		return RENDER_JSON;
+	if (strcmp(arg, "csv") == 0)
+		return RENDER_CSV;
+	printf("Error: invalid format <%s>, text, json or csv\n", arg);
+	exit(EXIT_FAILURE);
+}
 
-	 Sort numbers array what get from file or console using a qsort */
-int sortNumbers(long double a[], size_t size) {
+/*!	 \fn usageError
+	 \return none, terminates the program
+	 \param none */
+void usageError() {
+	printf(
+		"Error: invalid command line.\n"
+		"Usage: nbstats [--threads N | --stream | --memory MB] [--quantiles EPS] [--precision=ld|double|float]\n"
+		"               [--bootstrap B] [--tests LIST] [--stats STATS] [--format=text|json|csv]\n"
+		"               [--profile[=table|json]] [--list files.txt] [filename ...]\n"
+		"       nbstats --csv --value-col NAME [--group-by NAME] [--threads N] [filename]\n"
+		"       nbstats --convert [--threads N] in.txt out.nbc\n"
+		"       nbstats --window N [--step M] [--tests LIST] [--stats STATS] [filename]\n"
+		"       LIST: second,first-two,last-two,summation,duplication or all\n"
+		"       STATS: mean,variance,range,median,mode,nb or all\n"
+		"       nbstats [--stream | --window N ...] --save-summary out.nbs [filename]\n"
+		"       nbstats --follow [--interval S] [--every N] [--threads N] [--quantiles EPS] [--bootstrap B]\n"
+		"               [--tests LIST] [--stats STATS] [--format=text|json|csv] filename\n"
+		"       nbstats --serve PATH [--threads N] [--quantiles EPS] [--bootstrap B] [--tests LIST] [--stats STATS]\n"
+		"       nbstats merge [--quantiles EPS] [--bootstrap B] [--stats STATS] [--format=text|json|csv]\n"
+		"                     [--save-summary out.nbs] a.nbs b.nbs ...\n"
+	);
+	exit(EXIT_FAILURE);
+}
 
-	//built-in sort
-	qsort(a, size, sizeof(long double), compare_num);
+/*!	 \fn readList
+	 \return false if the list can not be read (the error is printed)
+	 \param const char* listName, struct options* opts - file names are added
 
-	return 0;
-}
+	 One file name per line, blank lines are skipped */
+bool readList(const char* listName, struct options* opts) {
+	FILE* list = fopen(listName, "r");
+	size_t capacity = opts->numFiles;
+	char line[4096];
 
-/*!	 \fn compare_num
-	 \return
-	 \param void const* pA, void const* pB
+	if (list == NULL) {
+		printf("error <%s> ", listName);
+		perror(" ");
+		return false;
+	}
 
-	 This is the function that compares two elements. */
-int compare_num(void const* pA, void const* pB) {
-	//Gernal approach
-	long double a = *(long double const*)pA;
-	long double b = *(long double const*)pB;
+	while (fgets(line, sizeof(line), list) != NULL) {
+		size_t length = strlen(line);
+		if (length == sizeof(line) - 1 && line[length - 1] != '\n' && !feof(list)) {
+			printf("Error: file name too long in <%s>\n", listName);
+			fclose(list);
+			return false;
+		}
+		while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+			line[--length] = '\0';
+		if (length == 0)
+			continue;
+
+		if (opts->numFiles == capacity) {
+			capacity = capacity < 16 ? 16 : capacity * 2;
+			const char** grown = (const char**)realloc((void*)opts->fileNames, capacity * sizeof(const char*));
+			if (grown == NULL) {
+				printf("Error: out of memory\n");
+				fclose(list);
+				return false;
+			}
+			opts->fileNames = grown;
+		}
+		char* name = (char*)malloc(length + 1);
+		if (name == NULL) {
+			printf("Error: out of memory\n");
+			fclose(list);
+			return false;
+		}
+		memcpy(name, line, length + 1);
+		opts->fileNames[opts->numFiles++] = name;
+	}
 
-	if (a > b)
-		return 1;
-	else if (a < b)
-		return -1;
-	else
-		return 0;
+	if (ferror(list)) {
+		printf("error <%s> ", listName);
+		perror(" ");
+		fclose(list);
+		return false;
+	}
+	fclose(list);
 
+	if (opts->numFiles == 0) {
+		printf("Error: no file names in <%s>\n", listName);
+		return false;
+	}
+	return true;
 }
 
-/*!	 \fn calculateArraySize
+/*!	 \fn printRejection
 	 \return none
-	 \param long double a[] - numbers array
+	 \param void* ctx - unused, enum nb_reject reason, size_t index - element number,
+			const char* token, size_t length
+
+	 Print the messages of the console version for a rejected token, on stderr with JSON and CSV so that
+	 stdout stays machine readable */
+void printRejection(void* ctx, enum nb_reject reason, size_t index, const char* token, size_t length) {
+	FILE* out = data.format == RENDER_TEXT ? stdout : stderr;
+	(void)ctx;
+
+	switch (reason) {
+	case NB_REJECT_NEGATIVE:
+	case NB_REJECT_ZERO:
+		fprintf(out, "Error: rejected #%zu <%.*s>\n", index, (int)length, token);
+		data.rejected++;
+		break;
+	case NB_REJECT_INFINITY:
+		fprintf(out, "Error: rejected # %zu <%.*s> = INFINITY\n", index, (int)length, token);
+		data.rejected++;
+		break;
+	case NB_REJECT_INVALID:
+		fprintf(out, "Error: failure reading element %zu \n", index);
+		fprintf(out, "\tLength = %zu \n", length);
+		fprintf(out, "\tValue = \"%.*s\" \n", (int)length, token);
+		break;
+	}
+}
+
+/*!	 \fn getNumbers
+	 \return NB_OK or the status of the library
+	 \param nb_context* ctx, const struct options* opts
+
+	 Without file name get numbers from console, otherwise get numbers from file
+	 The program will terminate if the file can not be opened. */
+int getNumbers(nb_context* ctx, const struct options* opts) {
+	int status;
+
+	if (opts->numFiles == 0 && opts->window > 0) { // stdin, watched line by line as it comes in
+		char line[1 << 16];
+		int status = NB_OK;
+
+		data.stdOrFile = 1;
+		while (status == NB_OK && fgets(line, sizeof(line), stdin) != NULL)
+			status = nb_ingest_buffer(ctx, line, strlen(line));
+		return status;
+	}
+	if (opts->numFiles == 0) { //stdin
+		data.stdOrFile = 1;
+		return nb_ingest_stream(ctx, stdin);
+	}
 
-	 Calculate how many elements in numbers array */
-void calculateArraySize(long double a[]) {
-	size_t i = 0;
-	while (a[i] != 0) { // 0 is end of array in numbers array
-		i++;
+	// file
+	data.stdOrFile = 2;
+	if ((status = nb_ingest_file(ctx, opts->fileNames[0])) == NB_IO) {
+		printf("error <%s> ", opts->fileNames[0]);
+		perror(" ");
+		exit(EXIT_FAILURE);
 	}
-	//assign size of array to struct's variable arrSize
-	data.arrSize = i;
+	return status;
 }
 
-/*!	 \fn calculateRange
+/*!	 \fn countRejection
 	 \return none
-	 \param long double a[] - numbers array, size_t size - how many numbers in array
+	 \param void* ctx - struct fileResult, enum nb_reject reason, size_t index - element number,
+			const char* token, size_t length
+
+	 Batch mode reports only the number of rejected tokens of each file */
+void countRejection(void* ctx, enum nb_reject reason, size_t index, const char* token, size_t length) {
+	struct fileResult* result = (struct fileResult*)ctx;
+	(void)token;
+	(void)length;
 
-	 Determin min value and max value of numbers array(a[]) */
-void calculateRange(long double a[], size_t size) {
-	data.rangeMin = a[0];
-	data.rangeMax = a[size - 1];
+	if (reason == NB_REJECT_INVALID)
+		result->invalidIndex = index;
+	else
+		result->rejected++;
 }
 
-/*!	 \fn calArithmeticMean
+/*!	 \fn analyzeFile
 	 \return none
-	 \param long double a[] - numbers array, size_t size - how many numbers in array
+	 \param void* arg - struct batch, unsigned worker, size_t task - number of the file
+
+	 Analyze one file of the batch on the calling worker and merge it into the aggregate of the worker */
+void analyzeFile(void* arg, unsigned worker, size_t task) {
+	struct batch* b = (struct batch*)arg;
+	struct fileResult* result = &b->results[task];
+	struct nb_config config = { 0 };
+
+	config.threads = 1; // the files are the parallel work
+	config.stream = b->stream;
+	config.quantileError = b->quantileError;
+	config.memoryBudget = b->memoryBudget;
+	config.precision = b->precision;
+	config.profile = b->profile;
+	config.bootstrap = b->bootstrap;
+	config.bootstrapThreads = 1;
+	config.digitTests = b->tests;
+	config.statistics = b->statistics;
+	config.onReject = countRejection;
+	config.rejectCtx = result;
+	nb_context* ctx = nb_create(&config);
+	if (ctx == NULL) {
+		result->status = NB_NOMEM;
+		return;
+	}
 
-	 Calculate Arithmetic Mean
-	 \note The sum of all the values divided by the number of values. */
-void calArithmeticMean(long double a[], size_t size) {
-	long double sum = 0;
-	for (size_t i = 0; i < size; i++) {
-		sum += a[i];
+	result->status = nb_ingest_file(ctx, b->fileNames[task]);
+	result->error = errno;
+	if (result->status == NB_OK)
+		result->status = nb_finalize(ctx);
+
+	if (result->status == NB_OK && !initRender(&result->line, LINE_CAPACITY))
+		result->status = NB_NOMEM;
+	if (result->status == NB_OK) {
+		renderFileLine(&result->line, b->format, b->fileNames[task], result, nb_result(ctx));
+		if (nb_merge(b->aggregates[worker], ctx) == NB_OK)
+			b->mergedFiles[worker]++;
 	}
-	data.arithmeticMean = sum / size;
+	if (b->profile)
+		addProfile(&b->profiles[worker], nb_profile(ctx));
+	nb_destroy(ctx);
 }
 
-/*!	 \fn calStatisticalMedian
+/*!	 \fn renderFileLine
 	 \return none
-	 \param long double a[] - numbers array, size_t size - how many numbers in array
+	 \param struct renderBuffer* line, enum renderFormat format, const char* fileName,
+			const struct fileResult* result, const struct nb_result* r - finalized analysis of the file
+
+	 The line of the file in the batch report: the main statistics with text ("-" for the ones not available
+	 or not wanted), the whole report with JSON and CSV */
+void renderFileLine(struct renderBuffer* line, enum renderFormat format, const char* fileName,
+	const struct fileResult* result, const struct nb_result* r) {
+	struct reportInfo info = { 0 };
+
+	if (format != RENDER_TEXT) {
+		info.name = fileName;
+		info.quantileError = data.quantileError;
+		info.rejected = result->rejected;
+		renderReport(line, format, r, &info);
+		return;
+	}
 
-	 Calculate Statistical Median
-	 \note The middle value of a sorted data set of odd length,
-		   or the arithmetic mean of the two closest values to the middle of a sorted data set of even length.  */
-void calStatisticalMedian(long double a[], size_t size) {
-	long int index1 = 0;
-	long int index2 = 0;
+	appendFormat(line, "%s\t%zu\t", fileName, r->count);
+	if (r->statistics & 1u << NB_STAT_MEAN)
+		appendFormat(line, "%.6Lg\t", r->arithmeticMean);
+	else
+		appendFormat(line, "-\t");
+	if (r->hasMedian)
+		appendFormat(line, "%.6Lg\t", r->statisticalMedian);
+	else if (r->hasQuantiles && (r->statistics & 1u << NB_STAT_MEDIAN))
+		appendFormat(line, "~%.6Lg\t", r->quantiles[3]);
+	else
+		appendFormat(line, "-\t");
+	if (r->statistics & 1u << NB_STAT_VARIANCE)
+		appendFormat(line, "%.6Lg\t", r->standardDeviation);
+	else
+		appendFormat(line, "-\t");
+	if (r->statistics & 1u << NB_STAT_NB)
+		appendFormat(line, "%.5Lf%%\t%zu\t%s", r->NBDeviation * 100, result->rejected, relationship(r->NBDeviation));
+	else
+		appendFormat(line, "-\t%zu\t-", result->rejected);
+	if (r->hasBootstrap)
+		appendFormat(line, "\t%.4g", r->bootstrap.deviation.pValue);
+	appendFormat(line, "\n");
+}
 
-	if (size % 2 == 0) { //even
-		index1 = size / 2 - 1;
-		index2 = size / 2 + 1 - 1;
+/*!	 \fn fileError
+	 \return message of a file without a report
+	 \param const struct fileResult* result - status is not NB_OK, char* message, size_t size - room for the message */
+const char* fileError(const struct fileResult* result, char* message, size_t size) {
+	switch (result->status) {
+	case NB_IO:
+		return strerror(result->error);
+	case NB_INVALID:
+		snprintf(message, size, "failure reading element %zu", result->invalidIndex);
+		return message;
+	case NB_EMPTY:
+		return "data set is empty";
+	case NB_FORMAT:
+		return "not a valid .nbc or compressed file";
+	default:
+		return "out of memory";
+	}
+}
 
-		data.statisticalMedian = (a[index1] + a[index2]) / 2;
+/*!	 \fn runBatch
+	 \return EXIT_SUCCESS, or EXIT_FAILURE if any file failed
+	 \param const struct options* opts
+
+	 Analyze all the files on a work-stealing pool, print one line per file in the given order,
+	 then the statistics and table/graph of all the files together. The worker aggregates are
+	 merged at the end, so the workers never wait for each other. */
+int runBatch(const struct options* opts) {
+	struct batch b;
+	unsigned workers = opts->threads != 0 ? opts->threads : processorCount();
+	int exitCode = EXIT_SUCCESS;
+	struct nb_config config = { 0 };
+
+	if ((size_t)workers > opts->numFiles)
+		workers = (unsigned)opts->numFiles;
+
+	b.fileNames = opts->fileNames;
+	b.stream = opts->stream;
+	b.quantileError = opts->quantileError;
+	b.memoryBudget = opts->memoryBudget;
+	b.precision = opts->precision;
+	b.profile = opts->profile != PROFILE_NONE;
+	b.bootstrap = opts->bootstrap;
+	b.tests = opts->tests;
+	b.statistics = opts->statistics;
+	b.format = opts->format;
+	config.quantileError = opts->quantileError; // the aggregates keep a quantile sketch
+	config.profile = b.profile;
+	config.bootstrap = opts->bootstrap; // of the aggregate of all, on every processor
+	config.bootstrapThreads = opts->threads;
+	config.digitTests = opts->tests;
+	config.statistics = opts->statistics;
+	b.results = (struct fileResult*)calloc(opts->numFiles, sizeof(struct fileResult));
+	b.aggregates = (nb_context**)calloc(workers, sizeof(nb_context*));
+	b.mergedFiles = (size_t*)calloc(workers, sizeof(size_t));
+	b.profiles = (struct nb_profile*)calloc(workers, sizeof(struct nb_profile));
+	bool ok = b.results != NULL && b.aggregates != NULL && b.mergedFiles != NULL && b.profiles != NULL;
+	for (unsigned w = 0; ok && w < workers; w++)
+		ok = (b.aggregates[w] = nb_create(&config)) != NULL;
+	if (ok)
+		ok = runPool(workers, opts->numFiles, analyzeFile, &b);
+	if (!ok) {
+		printf("Error: out of memory\n");
+		return EXIT_FAILURE;
 	}
-	else { //odd
-		index1 = size / 2 + 1 - 1;
 
-		data.statisticalMedian = a[index1];
+	// the lines of the files in the given order, then the aggregate, in one write
+	struct renderBuffer out;
+	double wall = 0, cpu = 0;
+	startPrint(&wall, &cpu);
+	initRender(&out, REPORT_CAPACITY + opts->numFiles * LINE_CAPACITY); // out of memory fails the write
+	if (opts->format == RENDER_TEXT)
+		appendFormat(&out, "file\telements\tmean\tmedian\tstd. dev.\tNB std. dev.\trejected\tBenford relationship%s\n",
+			opts->bootstrap != 0 ? "\tNB p-value" : "");
+	else if (opts->format == RENDER_JSON)
+		appendFormat(&out, "{\"files\": [\n");
+	else
+		renderCsvHeader(&out);
+	for (size_t i = 0; i < opts->numFiles; i++) {
+		struct fileResult* r = &b.results[i];
+		char message[64];
+
+		if (opts->format == RENDER_JSON && i > 0)
+			appendFormat(&out, ",\n");
+		if (r->status == NB_OK) {
+			appendBuffer(&out, &r->line);
+		}
+		else {
+			renderError(&out, opts->format, opts->fileNames[i], fileError(r, message, sizeof(message)));
+			exitCode = EXIT_FAILURE;
+		}
+		freeRender(&r->line);
+	}
+	endPrint(wall, cpu);
+
+	// aggregate of all the files
+	nb_context* total = nb_create(&config);
+	int status = total == NULL ? NB_NOMEM : NB_OK;
+	for (unsigned w = 0; status == NB_OK && w < workers; w++) {
+		if (b.mergedFiles[w] > 0)
+			status = nb_merge(total, b.aggregates[w]);
+	}
+	if (status == NB_OK)
+		status = nb_finalize(total);
+
+	startPrint(&wall, &cpu);
+	if (opts->format == RENDER_JSON)
+		appendFormat(&out, "],\n\"aggregate\": ");
+	if (status == NB_OK) {
+		struct reportInfo info = { 0 };
+		info.name = "(all)";
+		info.aggregate = true;
+		info.quantileError = data.quantileError;
+		for (size_t i = 0; i < opts->numFiles; i++)
+			info.rejected += b.results[i].rejected;
+		data.arrSize = nb_result(total)->count;
+		renderReport(&out, opts->format, nb_result(total), &info);
 	}
+	else if (opts->format == RENDER_JSON) {
+		appendFormat(&out, "null");
+	}
+	else if (status == NB_EMPTY && opts->format == RENDER_TEXT) {
+		appendFormat(&out, "\nData set is empty! \n");
+	}
+	if (opts->format == RENDER_JSON)
+		appendFormat(&out, "}\n");
+	if (!writeRender(&out, stdout) || (status != NB_OK && status != NB_EMPTY)) {
+		printf("Error: out of memory\n");
+		exitCode = EXIT_FAILURE;
+	}
+	freeRender(&out);
+	endPrint(wall, cpu);
+	if (status != NB_OK)
+		exitCode = EXIT_FAILURE;
+
+	if (b.profile) { // the files, the merges into the worker aggregates and the aggregate of all
+		for (unsigned w = 0; w < workers; w++) {
+			addProfile(&profile.library, &b.profiles[w]);
+			addProfile(&profile.library, nb_profile(b.aggregates[w]));
+		}
+		if (total != NULL)
+			addProfile(&profile.library, nb_profile(total));
+		printProfile();
+	}
+	nb_destroy(total);
+	for (unsigned w = 0; w < workers; w++)
+		nb_destroy(b.aggregates[w]);
+	free(b.profiles);
+	free(b.mergedFiles);
+	free((void*)b.aggregates);
+	free(b.results);
+	return exitCode;
 }
 
-/*!	 \fn calVariance
-	 \return none
-	 \param long double a[] - numbers array, size_t size - how many numbers in array, long double mean - arithmetic mean
+/*!	 \fn runGroups
+	 \return EXIT_SUCCESS or EXIT_FAILURE
+	 \param const struct options* opts
+
+	 Grouped analysis of a CSV table from the file or the console, one line per group, worst
+	 Benford relationship first */
+int runGroups(const struct options* opts) {
+	struct nb_csv_config config = { 0 };
+	struct nb_group* groups = NULL;
+	size_t numGroups = 0;
+	int status;
+
+	config.valueColumn = opts->valueColumn;
+	config.groupColumn = opts->groupColumn;
+	config.threads = opts->threads;
+	if (opts->numFiles == 0)
+		status = nb_group_stream(stdin, &config, &groups, &numGroups);
+	else
+		status = nb_group_file(opts->fileNames[0], &config, &groups, &numGroups);
+
+	switch (status) {
+	case NB_OK:
+		break;
+	case NB_IO:
+		printf("error <%s> ", opts->numFiles == 0 ? "stdin" : opts->fileNames[0]);
+		perror(" ");
+		return EXIT_FAILURE;
+	case NB_COLUMN:
+		if (opts->groupColumn != NULL)
+			printf("Error: no column <%s> or <%s> in the CSV header\n", opts->valueColumn, opts->groupColumn);
+		else
+			printf("Error: no column <%s> in the CSV header\n", opts->valueColumn);
+		return EXIT_FAILURE;
+	case NB_EMPTY:
+		printf("Data set is empty! \n");
+		return EXIT_FAILURE;
+	default:
+		printf("Error: out of memory\n");
+		return EXIT_FAILURE;
+	}
 
-	 Calculate Variance
-	 \note The mean of the squared differences of each sample from the arithmetic mean. */
-void calVariance(long double a[], size_t size, long double mean) {
-	long double variance = 0;
-	for (size_t i = 0; i < size; i++) {
-		variance += pow(a[i] - mean, 2);
+	printf("rank\t%s\telements\trejected\tmean\tstd. dev.\tNB std. dev.\tBenford relationship\n",
+		opts->groupColumn != NULL ? opts->groupColumn : "group");
+	for (size_t i = 0; i < numGroups; i++) {
+		const struct nb_group* g = &groups[i];
+
+		printf("%zu\t%.*s\t%zu\t%zu\t", i + 1, (int)g->keyLength, g->key, g->count, g->rejected);
+		if (g->count == 0)
+			printf("-\t-\t-\t-\n");
+		else
+			printf("%.6Lg\t%.6Lg\t%.5Lf%%\t%s\n", g->arithmeticMean, g->standardDeviation, g->NBDeviation * 100,
+				relationship(g->NBDeviation));
 	}
 
-	data.variance = variance / size;
+	nb_free_groups(groups);
+	return EXIT_SUCCESS;
 }
-// 
-/*!	 \fn calStandardDeviation
-	 \return none
-	 \param long double variance
 
-	 Calculate Variance
-	 \note The square root of the variance.*/
-void calStandardDeviation(long double variance) {
-	data.standardDeviation = sqrt(variance);
-}
+/*!	 \fn runConvert
+	 \return EXIT_SUCCESS or EXIT_FAILURE
+	 \param const struct options* opts - the first file is read, the second written
 
-/*!	 \fn calMode
-	 \return 0
-	 \param long double a[] - numbers array, size_t size - how many numbers in array
-
-	 Calculate Mode or Multi Mode*/
-int calMode(long double a[], size_t size) {
-	size_t capacity = 4;
-	size_t i = 0;
-	long int a_index = -1;
-	long int modeF = 0; // frequency of num
-
-	data.modeNums = malloc((sizeof(long double) *capacity + 1));
-	data.modeFH = 0;
-	data.numModes = 0;
-
-	while (i < size) {
-		for (i; i < size; i++) {
-			if (a[i] == a[i + 1]) {
-				modeF++;
-			}
-			else {
-				if (modeF > data.modeFH) { // get mode
-					data.modeNums[0] = 0;
-					data.modeNums[0] = a[i];
-					data.modeFH = modeF;
-
-					// initicalize 
-					a_index = 0;
-					data.numModes = 1;
-
-					i++;
-					modeF = 0;
-					break;
-
-				}
-				else if ((modeF == data.modeFH) && modeF != 0) { // Multi mode stored
-					if (a_index == capacity) {
-						long double* modeNumsDouble = (long double*)realloc(data.modeNums, (sizeof(long double) *(capacity *= 2)));
-						if (modeNumsDouble == NULL) {
-							free(data.modeNums);
-							return 1;
-						}
-						data.modeNums = modeNumsDouble;
-					}
-
-					data.modeNums[++a_index] = a[i];
-					data.numModes++;
-					i++;
-					modeF = 0;
-					break;
-				}
-				else { // not mode num
-					i++;
-					modeF = 0;
-					break;
-				}
-			}
-		}
+	 Read the numbers of a file (with the usual rejections) and save them as a .nbc file */
+int runConvert(const struct options* opts) {
+	struct nb_config config = { 0 };
+
+	config.threads = opts->threads;
+	config.onReject = printRejection;
+	nb_context* ctx = nb_create(&config);
+	if (ctx == NULL) {
+		printf("Error: out of memory\n");
+		return EXIT_FAILURE;
 	}
 
-	return 0;
+	int status = getNumbers(ctx, opts);
+	if (status == NB_OK && (status = nb_write_nbc(ctx, opts->fileNames[1])) == NB_IO) {
+		printf("error <%s> ", opts->fileNames[1]);
+		perror(" ");
+	}
+	else if (status == NB_NOMEM) {
+		printf("Error: out of memory\n");
+	}
+	else if (status == NB_FORMAT) {
+		printf("Error: <%s> is not a valid .nbc file\n", opts->fileNames[0]);
+	}
+	else if (status == NB_OK) {
+		printf("Numbers of <%s> written to <%s>\n", opts->fileNames[0], opts->fileNames[1]);
+	}
+
+	nb_destroy(ctx);
+	return status == NB_OK ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-/*!	 \fn frequencyTable
-	 \return none
-	 \param long double a[] - numbers array, size_t size - how many numbers in array
+/*!	 \fn saveSummary
+	 \return NB_OK or the status of the library
+	 \param nb_context* ctx, const char* fileName
 
-	 Calculate raw frequency, expected frequencies , actual frequencies */
-void frequencyTable(long double a[], size_t size) {
-	long double digit = 0;
+	 Write the .nbs summary of the numbers taken, a file that can not be written is reported */
+int saveSummary(nb_context* ctx, const char* fileName) {
+	int status = nb_save_summary(ctx, fileName);
 
-	// calculate Raw frequency
-	for (size_t i = 0; i < size; i++) {
-		if (a[i] < 1) { // float number < 1
-			char str[20];
-			snprintf(str, sizeof(str), "%e", a[i]);
+	if (status == NB_IO) {
+		printf("error <%s> ", fileName);
+		perror(" ");
+	}
+	return status;
+}
 
-			int num = 0;
-			sscanf_s(str, "%d", &num);
-			data.fre_array[num - 1] += 1;
-		}
-		else if (a[i] < 10) { // if num is between 0 and 9
-			digit = a[i];
-			data.fre_array[(int)digit - 1] += 1; // index 0 base
-		}
-		else { // num > 10
-			digit = a[i] / 10;
+/*!	 \fn runMerge
+	 \return EXIT_SUCCESS or EXIT_FAILURE
+	 \param const struct options* opts - files are .nbs summaries
+
+	 Statistics and table/graph of the data sets of all the summaries together, as one streaming analysis
+	 of all their numbers would report them. The merged summary can be saved again. */
+int runMerge(const struct options* opts) {
+	struct nb_config config = { 0 };
+	int status = NB_OK;
+
+	config.stream = true;
+	config.quantileError = opts->quantileError != 0 ? opts->quantileError : DEFAULT_RANK_ERROR; // summaries may have sketches
+	config.profile = opts->profile != PROFILE_NONE;
+	config.bootstrap = opts->bootstrap;
+	config.statistics = opts->statistics;
+	data.quantileError = config.quantileError;
+	nb_context* ctx = nb_create(&config);
+	if (ctx == NULL) {
+		printf("Error: out of memory\n");
+		return EXIT_FAILURE;
+	}
 
-			if (digit == 0) {
-				digit = a[i];
-				data.fre_array[(int)digit - 1] += 1;
-			}
-			else {
-				while (digit >= 10) {
-					digit = digit / 10;
-				}
-				data.fre_array[(int)digit - 1] += 1;
-			}
+	data.stdOrFile = 2;
+	for (size_t i = 0; status == NB_OK && i < opts->numFiles; i++) {
+		status = nb_load_summary(ctx, opts->fileNames[i]);
+		if (status == NB_IO) {
+			printf("error <%s> ", opts->fileNames[i]);
+			perror(" ");
+		}
+		else if (status == NB_FORMAT) {
+			printf("Error: <%s> is not a valid .nbs file\n", opts->fileNames[i]);
 		}
 	}
+	if (status == NB_OK && opts->summaryName != NULL)
+		status = saveSummary(ctx, opts->summaryName);
+	if (status == NB_OK)
+		status = nb_finalize(ctx);
 
-	// calculate Expected frequencies
-	for (size_t i = 0; i < 9; i++) {
-		double expectNum = log10((i + 1) + 1) - log10(i + 1);
-		expectNum = expectNum * 100;
+	if (status == NB_EMPTY)
+		printf("Data set is empty! \n");
+	else if (status == NB_NOMEM)
+		printf("Error: out of memory\n");
+	if (status == NB_OK && !printReport(nb_result(ctx)))
+		status = NB_NOMEM;
+
+	reportProfile(ctx);
+	nb_destroy(ctx);
+	return status == NB_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-		data.expected_array[i] = expectNum;
+/*!	 \fn runFollow
+	 \return EXIT_FAILURE when the file can not be read or on an error of the library, runs until interrupted otherwise
+	 \param const struct options* opts - one file
+
+	 Follow a growing file like tail -f. The file stays open and only the bytes added since the last look are
+	 parsed, into one streaming analysis (a number cut in two by the writer waits for its other half).
+	 The report is printed again when there are new numbers and --interval seconds have passed or --every new
+	 numbers came in, whichever comes first. A file that got shorter was rewritten: its analysis starts over. */
+int runFollow(const struct options* opts) {
+	const char* fileName = opts->fileNames[0];
+	static char block[FOLLOW_BLOCK];
+	struct nb_config config = { 0 };
+	unsigned long long offset = 0;	// bytes of the file read
+	unsigned long long size;
+	int status = NB_OK;
+
+	config.threads = opts->threads;
+	config.stream = true;
+	config.onReject = printRejection;
+	config.quantileError = opts->quantileError;
+	config.bootstrap = opts->bootstrap;
+	config.bootstrapThreads = opts->threads;
+	config.digitTests = opts->tests;
+	config.statistics = opts->statistics;
+	FILE* in = fopen(fileName, "rb");
+	if (in == NULL) {
+		printf("error <%s> ", fileName);
+		perror(" ");
+		return EXIT_FAILURE;
 	}
+	nb_context* ctx = nb_create(&config);
+	if (ctx == NULL) {
+		printf("Error: out of memory\n");
+		fclose(in);
+		return EXIT_FAILURE;
+	}
+
+	data.stdOrFile = 2;
+	size_t reported = 0;			// numbers of the last report
+	double lastReport = wallSeconds();
+	while (status == NB_OK) {
+		size_t length = fread(block, 1, sizeof(block), in);
+		if (length > 0) {
+			offset += length;
+			status = nb_ingest_buffer(ctx, block, length);
+		}
+		else if (ferror(in)) {
+			printf("error <%s> ", fileName);
+			perror(" ");
+			status = NB_IO;
+			break;
+		}
 
-	// calculte Actual frequencies
-	for (size_t i = 0; i < 9; i++) {
-		if ((double)data.fre_array[i] / (double)size * 100 > 99) {
-			data.placeChk = true; // Actual frequencie is 100
-			data.exceed50 = true; // exceed 50%
+		size_t count = nb_count(ctx);
+		if (status == NB_OK && count > reported && ((opts->every != 0 && count - reported >= opts->every)
+			|| (opts->interval != 0 && wallSeconds() - lastReport >= opts->interval))) {
+			status = nb_snapshot(ctx);
+			if (status == NB_OK && !printReport(nb_result(ctx)))
+				status = NB_NOMEM;
+			reported = count;
+			lastReport = wallSeconds();
 		}
-		else if ((double)data.fre_array[i] / (double)size * 100 >= 50) {
-			data.exceed50 = true; // exceed 50%
-			data.placeChk = false; // not over 99%
+		if (status != NB_OK || length > 0)
+			continue;
+
+		// end of the file for now: wait for it to grow, start over if it was rewritten
+		clearerr(in);
+		if (fileSize(fileName, &size) && size < offset) {
+			FILE* out = data.format == RENDER_TEXT ? stdout : stderr;
+			fprintf(out, "<%s> got shorter, analysis started over\n", fileName);
+			fflush(out);
+			nb_destroy(ctx);
+			if ((ctx = nb_create(&config)) == NULL) {
+				status = NB_NOMEM;
+				break;
+			}
+			rewind(in);
+			offset = 0;
+			reported = 0;
+			data.rejected = 0;
+			continue;
 		}
-		data.actual_array[i] = (double)data.fre_array[i] / (double)size * 100;
+		sleepSeconds(FOLLOW_POLL);
 	}
-}
 
-/*!	 \fn calNB
-	 \return none
-	 \param double P[] - expected frequencies array, double A[] - actual frequencies array
+	if (status == NB_NOMEM)
+		printf("Error: out of memory\n");
+	nb_destroy(ctx);
+	fclose(in);
+	return EXIT_FAILURE;
+}
 
-	 Calculate NB Variance , Deviation */
-void calNB(double P[], double A[]) {
+/*!	 \fn runServe
+	 \return EXIT_SUCCESS once a client sent SHUTDOWN, EXIT_FAILURE if the socket can not be served
+	 \param const struct options* opts
 
-	// calculate NB Variance
-	for (int i = 0; i < 9; i++) {
-		data.NBVariance += pow((A[i] / P[i] - 1), 2);
-	}
-	data.NBVariance = data.NBVariance / 9;
+	 Daemon on a local socket, --quantiles, --bootstrap, --tests and --stats apply to every data set */
+int runServe(const struct options* opts) {
+	struct nb_config config = { 0 };
 
-	// calculte NB Deviation
-	data.NBDeviation = sqrt(data.NBVariance);
+	config.quantileError = opts->quantileError;
+	config.bootstrap = opts->bootstrap;
+	config.digitTests = opts->tests;
+	config.statistics = opts->statistics;
+	return serveLocal(opts->servePath, opts->threads, &config);
 }
 
-/*!	 \fn printOutput
+/*!	 \fn printWindow
 	 \return none
-	 \param struct output data
+	 \param void* ctx - unused, const struct nb_window* w
 
-	 Print all the statistics on a list of numbers and table/graph */
-void printOutput() {
-	// for Command line variations. Code_page
-	int i = 0;
-	int xPrint = 0;
-
-	if (data.exceed50 == false || data.placeChk == false)
-		xPrint = 62; // not exceed 50% 
-	else
-		xPrint = 63; // exceed 50% 
+	 One line per window report, sent at once when the numbers come from the console */
+void printWindow(void* ctx, const struct nb_window* w) {
+	static bool header = false;
+	(void)ctx;
 
-	UINT curCP = GetConsoleOutputCP();
-
-	if (!SetConsoleOutputCP(850)) {
-		puts("SetConsoleOutputCP");
-		EXIT_FAILURE;
+	if (!header) {
+		printf("elements\tmean\tstd. dev.\tNB variance\tNB std. dev.\tBenford relationship\n");
+		header = true;
 	}
+	printf("%zu-%zu\t%.6Lg\t%.6Lg\t%.5Lf%%\t%.5Lf%%\t%s\n", w->first + 1, w->first + w->count, w->arithmeticMean,
+		w->standardDeviation, w->NBVariance * 100, w->NBDeviation * 100, relationship(w->NBDeviation));
+	if (data.stdOrFile == 1)
+		fflush(stdout);
+}
 
-	if (data.existData == false) { // first comment
-		printf("Newcomb-Benford Stats (v1.0.0), \xB8""2019 Jimin Park\n");
-		printf("================================================\n");
-		if (data.stdOrFile == 1)
-			printf("Enter white-space separated real numbers. Terminate input with ^Z\n");
+/*!	 \fn addProfile
+	 \return none
+	 \param struct nb_profile* dst, const struct nb_profile* src - NULL adds nothing
+
+	 Sum the phases of two analyses, the peak memory is the larger one */
+void addProfile(struct nb_profile* dst, const struct nb_profile* src) {
+	if (src == NULL)
+		return;
+	for (int i = 0; i < NB_NUM_PHASES; i++) {
+		struct nb_phase_profile* d = &dst->phases[i];
+		const struct nb_phase_profile* p = &src->phases[i];
+		d->wallSeconds += p->wallSeconds;
+		d->cpuSeconds += p->cpuSeconds;
+		d->bytes += p->bytes;
+		d->elements += p->elements;
+		if (p->peakMemory > d->peakMemory)
+			d->peakMemory = p->peakMemory;
 	}
-	else { // after statistic
-		printf("\nStandard Analysis\n");
-		while (i < xPrint) {
-			printf("\xcd");
-			i++;
-		}
-		printf("\n");
-		i = 0;
-
-		printf("# elements = %u\n", data.arrSize);
-		printf("Range = [%.6g .. %.6g]\n", data.rangeMin, data.rangeMax);
-		printf("Arithmetic mean = %.6g\n", data.arithmeticMean);
-		printf("Arithmetic median = %.6g\n", data.statisticalMedian);
-		printf("Variance = %.6g\n", data.variance);
-		printf("Standard Deviation = %.6g\n", data.standardDeviation);
-
-		if (data.numModes == 0 || (data.numModes*(data.modeFH + 1) == data.arrSize)) { //no mode
-			printf("Mode = no mode \n");
-		}
-		else {
-			printf("Mode = { ");
-			for (int i = 0; i < data.numModes; i++) {
-				if (i == 0)
-					printf("%.6g ", data.modeNums[i]);
-				else
-					printf(", %.6g ", data.modeNums[i]);
-			}
-
-			printf("}\x9e%u\n\n", data.modeFH + 1);
-		}
+	for (int i = 0; i < 4; i++)
+		dst->rejected[i] += src->rejected[i];
+}
 
-		// Print Raw Frequency
-		for (int i = 0; i < 9; i++) {
-			printf(" [%u] = %ld\n", i + 1, data.fre_array[i]);
-		}
-		printf("\n\n");
+/*!	 \fn startPrint
+	 \return none
+	 \param double* wall, double* cpu - receive the clocks with --profile
 
-		printf("Newcomb-Benford's Law Analysis\n");
-		while (i < xPrint) {
-			printf("\xcd");
-			i++;
-		}
-		printf("\n");
-		i = 0;
+	 The report on the console starts */
+void startPrint(double* wall, double* cpu) {
+	if (profile.format != PROFILE_NONE) {
+		*wall = wallSeconds();
+		*cpu = cpuSeconds();
+	}
+}
 
-		if (data.exceed50 == false) {  // scale 0-50
-			printf("    exp dig    freq  0      10      20      30      40      50\n");
-			printf("\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4 \xda\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\n");
-		}
-		else if (data.placeChk == false) {
-			printf("    exp dig    freq  0  10  20  30  40  50  60  70  80  90 100\n");
-			printf("\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4 \xda\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\n");
-		}
-		else {
-			printf("    exp dig    freq   0  10  20  30  40  50  60  70  80  90 100\n");
-			printf("\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4 \xda\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\xc4\xc4\xc4\xc2\n");
-		}
+/*!	 \fn endPrint
+	 \return none
+	 \param double wall, double cpu - of startPrint
+
+	 Add the time since startPrint to the print phase */
+void endPrint(double wall, double cpu) {
+	if (profile.format == PROFILE_NONE)
+		return;
+	fflush(stdout);
+	profile.print.wallSeconds += wallSeconds() - wall;
+	profile.print.cpuSeconds += cpuSeconds() - cpu;
+	profile.print.elements = data.arrSize;
+	profile.print.peakMemory = peakMemory();
+}
 
+/*!	 \fn printPhase
+	 \return none
+	 \param const char* name, const struct nb_phase_profile* p, bool last - no comma after it (JSON)
 
-		for (int i = 0; i < 9; i++) {
-			// printf Expected frequencies 
-			if (i < 3)
-				printf(" %.2lf%% [%1d] =", data.expected_array[i], i + 1);
-			else
-				printf("  %.2lf%% [%1d] =", data.expected_array[i], i + 1);
+	 One line of the profile */
+void printPhase(const char* name, const struct nb_phase_profile* p, bool last) {
+	double rate = p->wallSeconds > 0 ? (double)p->elements / p->wallSeconds : 0;
 
-			// printf Actual frequencies
-			// Determine space for Command line variations
-			if (data.placeChk == true && data.actual_array[i] > 99) { // 100%
-				printf(" %.2lf%% \xb3", data.actual_array[i]);
-			}
-			else if (data.placeChk == true) {
-				printf("   %.2lf%% \xb3", data.actual_array[i]);
-			}
-			else if (data.actual_array[i] >= 10) {
-				printf(" %.2lf%% \xb3", data.actual_array[i]);
-			}
-			else {
-				printf("  %.2lf%% \xb3", data.actual_array[i]);
-			}
+	if (profile.format == PROFILE_JSON) {
+		fprintf(stderr, "    {\"phase\": \"%s\", \"wall_seconds\": %.9g, \"cpu_seconds\": %.9g, \"bytes\": %llu, "
+			"\"elements\": %zu, \"elements_per_second\": %.9g, \"peak_rss_bytes\": %zu}%s\n",
+			name, p->wallSeconds, p->cpuSeconds, p->bytes, p->elements, rate, p->peakMemory, last ? "" : ",");
+		return;
+	}
+	fprintf(stderr, "%-10s %10.4f %10.4f %15llu %13zu %13.4g %10.1f\n", name, p->wallSeconds, p->cpuSeconds, p->bytes,
+		p->elements, rate, p->peakMemory / 1048576.0);
+}
 
-			int ractangle = 0;
-			if (data.exceed50 == true)
-				ractangle = (int)(data.actual_array[i] / 2.5); // exceed 50%
-			else
-				ractangle = (int)(data.actual_array[i] / 1.25); // 0~50%
-			for (int r = 0; r < ractangle; r++) {
-				printf("\xfe");
-			}
-			printf("\n");
-		}
+/*!	 \fn printProfile
+	 \return none
+	 \param none
+
+	 --profile report on stderr, so the report on stdout stays as it is: the phases of the library (summed over
+	 all the files), printing, and the whole run. The table leaves out the phases that did not run,
+	 JSON has all of them. */
+void printProfile() {
+	static const char* const phaseNames[NB_NUM_PHASES] = { "ingest", "merge", "runs", "mode", "median", "quantiles", "benford", "bootstrap" };
+	static const char* const reasonNames[4] = { "negative", "zero", "infinity", "invalid" };
+	const struct nb_profile* lib = &profile.library;
+	struct nb_phase_profile total = { 0 };
+
+	total.wallSeconds = wallSeconds() - profile.startWall;
+	total.cpuSeconds = cpuSeconds() - profile.startCpu;
+	total.bytes = lib->phases[NB_PHASE_INGEST].bytes;
+	total.elements = data.arrSize != 0 ? data.arrSize : lib->phases[NB_PHASE_INGEST].elements;
+	total.peakMemory = peakMemory();
+
+	if (profile.format == PROFILE_JSON) {
+		fprintf(stderr, "{\n  \"phases\": [\n");
+		for (int i = 0; i < NB_NUM_PHASES; i++)
+			printPhase(phaseNames[i], &lib->phases[i], false);
+		printPhase("print", &profile.print, false);
+		printPhase("total", &total, true);
+		fprintf(stderr, "  ],\n  \"rejected\": {");
+		for (int i = 0; i < 4; i++)
+			fprintf(stderr, "\"%s\": %zu%s", reasonNames[i], lib->rejected[i], i < 3 ? ", " : "}\n}\n");
+		return;
+	}
 
-		if (data.exceed50 == false) {  // scale 0-50
-			printf("\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4 \xc0\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\n");
-		}
-		else if (data.placeChk == false) {
-			printf("\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4 \xc0\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\n");
-		}
-		else {
-			printf("\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4\xc4 \xc0\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\xc4\xc4\xc4\xc1\n");
-		}
+	fprintf(stderr, "\nProfile\n%-10s %10s %10s %15s %13s %13s %10s\n", "phase", "wall (s)", "CPU (s)", "bytes", "elements",
+		"elements/s", "peak (MB)");
+	for (int i = 0; i < NB_NUM_PHASES; i++) {
+		if (lib->phases[i].peakMemory != 0) // ran
+			printPhase(phaseNames[i], &lib->phases[i], false);
+	}
+	if (profile.print.peakMemory != 0)
+		printPhase("print", &profile.print, false);
+	printPhase("total", &total, true);
+	fprintf(stderr, "rejected: ");
+	for (int i = 0; i < 4; i++)
+		fprintf(stderr, "%s %zu%s", reasonNames[i], lib->rejected[i], i < 3 ? ", " : "\n");
+}
 
-		printf("Variance = %.5Lf%%\n", data.NBVariance * 100);
-		printf("Std. Dev. = %.5Lf%%\n", data.NBDeviation * 100);
+/*!	 \fn reportProfile
+	 \return none
+	 \param const nb_context* ctx - the analysis, finalized or failed
+
+	 --profile of a single analysis */
+void reportProfile(const nb_context* ctx) {
+	if (profile.format == PROFILE_NONE)
+		return;
+	addProfile(&profile.library, nb_profile(ctx));
+	printProfile();
+}
 
-		// NB relationship analysis
-		if (0 <= data.NBDeviation && data.NBDeviation < 0.1)
-			printf("There is a very strong Benford relationship.\n");
-		else if (0.1 <= data.NBDeviation && data.NBDeviation < 0.2)
-			printf("There is a strong Benford relationship.\n");
-		else if (0.2 <= data.NBDeviation && data.NBDeviation < 0.35)
-			printf("There is a moderate Benford relationship.\n");
-		else if (0.35 <= data.NBDeviation && data.NBDeviation < 0.5)
-			printf("There is a weak Benford relationship.\n");
-		else if (0.5 <= data.NBDeviation)
-			printf("There is not a Benford relationship.\n");
+/*!	 \fn printBanner
+	 \return none
+	 \param none
 
-		while (i < xPrint) {
-			printf("\xcd");
-			i++;
-		}
-		printf("\n");
+	 Name of the program before the text report */
+void printBanner() {
+	struct renderBuffer b;
 
+	if (initRender(&b, LINE_CAPACITY)) {
+		renderBanner(&b, data.stdOrFile == 1);
+		writeRender(&b, stdout);
+		freeRender(&b);
 	}
+}
 
-	if (!SetConsoleOutputCP(curCP)) {
-		puts("SetConsoleOutputCP");
-		EXIT_FAILURE;
+/*!	 \fn printReport
+	 \return false if out of memory (the error is printed)
+	 \param const struct nb_result* r - finalized analysis
+
+	 Print all the statistics on a list of numbers and table/graph (or JSON, CSV), formatted in memory and
+	 written at once */
+bool printReport(const struct nb_result* r) {
+	struct renderBuffer b;
+	struct reportInfo info = { 0 };
+	double wall = 0, cpu = 0;
+
+	startPrint(&wall, &cpu);
+	data.arrSize = r->count;
+	info.name = data.fileName;
+	info.quantileError = data.quantileError;
+	info.rejected = data.rejected;
+	initRender(&b, REPORT_CAPACITY); // out of memory fails the write
+	if (data.format == RENDER_CSV && !data.csvHeader) {
+		renderCsvHeader(&b);
+		data.csvHeader = true;
 	}
-}
\ No newline at end of file
+	renderReport(&b, data.format, r, &info);
+	if (data.format == RENDER_JSON)
+		appendFormat(&b, "\n");
+	bool ok = writeRender(&b, stdout);
+	freeRender(&b);
+	endPrint(wall, cpu);
+	if (!ok)
+		printf("Error: out of memory\n");
+	return ok;
+}
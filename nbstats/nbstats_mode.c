@@ -0,0 +1,319 @@
+/*!	\file		nbstats_mode.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Mode by counting in an open addressing hash table keyed on the bit pattern of the value,
+	one pass over unsorted numbers. For the streaming mode a Space-Saving summary keeps the
+	most frequent values in bounded memory.
+*/
+#include "nbstats_mode.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_sort.h"
+
+#ifndef LDBL_KEY_BYTES
+#define LDBL_KEY_BYTES	((int)sizeof(long double))
+#endif
+
+#define INITIAL_TABLE	1024
+
+// long double: findModes, the hash and the table are shared with the heavy hitters
+#define NUMBER			long double
+#define NAME(name)		name
+#define KEY_BYTES		LDBL_KEY_BYTES
+#include "nbstats_mode.inc"
+#undef NUMBER
+#undef NAME
+#undef KEY_BYTES
+
+// double: findModesDouble
+#define NUMBER			double
+#define NAME(name)		name##Double
+#define KEY_BYTES		8
+#include "nbstats_mode.inc"
+#undef NUMBER
+#undef NAME
+#undef KEY_BYTES
+
+// float: findModesFloat
+#define NUMBER			float
+#define NAME(name)		name##Float
+#define KEY_BYTES		4
+#include "nbstats_mode.inc"
+#undef NUMBER
+#undef NAME
+#undef KEY_BYTES
+
+/*!	 \fn freeModes
+	 \return none
+	 \param struct modes* m
+
+	 Release the mode values */
+void freeModes(struct modes* m) {
+	free(m->values);
+	m->values = NULL;
+	m->numModes = 0;
+}
+
+static void heapSwap(struct heavyHitters* h, size_t i, size_t j) {
+	size_t t = h->heap[i];
+	h->heap[i] = h->heap[j];
+	h->heap[j] = t;
+	h->slots[h->heap[i]].heapPos = i;
+	h->slots[h->heap[j]].heapPos = j;
+}
+
+static void heapDown(struct heavyHitters* h, size_t pos) {
+	for (;;) {
+		size_t child = 2 * pos + 1;
+		if (child >= h->size)
+			return;
+		if (child + 1 < h->size && h->slots[h->heap[child + 1]].count < h->slots[h->heap[child]].count)
+			child++;
+		if (h->slots[h->heap[child]].count >= h->slots[h->heap[pos]].count)
+			return;
+		heapSwap(h, pos, child);
+		pos = child;
+	}
+}
+
+static void heapUp(struct heavyHitters* h, size_t pos) {
+	while (pos > 0) {
+		size_t parent = (pos - 1) / 2;
+		if (h->slots[h->heap[parent]].count <= h->slots[h->heap[pos]].count)
+			return;
+		heapSwap(h, pos, parent);
+		pos = parent;
+	}
+}
+
+// position of value in the index, or of the empty entry where it would go
+static size_t indexFind(const struct heavyHitters* h, long double value) {
+	size_t i = hashValue(value) & h->indexMask;
+	while (h->index[i] != 0 && h->slots[h->index[i] - 1].value != value)
+		i = (i + 1) & h->indexMask;
+	return i;
+}
+
+// remove the entry at i, later entries of the same run move back so lookups still find them
+static void indexRemove(struct heavyHitters* h, size_t i) {
+	size_t j = i;
+	for (;;) {
+		j = (j + 1) & h->indexMask;
+		if (h->index[j] == 0)
+			break;
+		size_t home = hashValue(h->slots[h->index[j] - 1].value) & h->indexMask;
+		bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+		if (stays)
+			continue;
+		h->index[i] = h->index[j];
+		i = j;
+	}
+	h->index[i] = 0;
+}
+
+/*!	 \fn initHeavyHitters
+	 \return false if out of memory
+	 \param struct heavyHitters* h, size_t capacity - distinct values kept
+
+	 Empty Space-Saving summary. Every value occurring more than n / capacity times is kept,
+	 and its count is at most n / capacity too high. */
+bool initHeavyHitters(struct heavyHitters* h, size_t capacity) {
+	size_t indexSize = 1;
+	while (indexSize < capacity * 2)
+		indexSize <<= 1;
+
+	h->capacity = capacity;
+	h->size = 0;
+	h->indexMask = indexSize - 1;
+	h->replaced = false;
+	h->floor = 0;
+	h->slots = (struct heavyHitter*)malloc(sizeof(struct heavyHitter) * capacity);
+	h->heap = (size_t*)malloc(sizeof(size_t) * capacity);
+	h->index = (size_t*)calloc(indexSize, sizeof(size_t));
+
+	if (h->slots == NULL || h->heap == NULL || h->index == NULL) {
+		freeHeavyHitters(h);
+		return false;
+	}
+	return true;
+}
+
+/*!	 \fn freeHeavyHitters
+	 \return none
+	 \param struct heavyHitters* h
+
+	 Release the summary */
+void freeHeavyHitters(struct heavyHitters* h) {
+	free(h->slots);
+	free(h->heap);
+	free(h->index);
+	h->slots = NULL;
+	h->heap = NULL;
+	h->index = NULL;
+	h->size = 0;
+}
+
+/*!	 \fn addHeavyHitters
+	 \return none
+	 \param struct heavyHitters* h, const long double a[], size_t size
+
+	 Count a block of numbers. A value that is not tracked while the summary is full replaces the
+	 least counted one and inherits its count (as error). */
+void addHeavyHitters(struct heavyHitters* h, const long double a[], size_t size) {
+	for (size_t n = 0; n < size; n++) {
+		long double value = a[n];
+		size_t i = indexFind(h, value);
+		size_t s;
+
+		if (h->index[i] != 0) { // tracked
+			s = h->index[i] - 1;
+			h->slots[s].count++;
+			heapDown(h, h->slots[s].heapPos);
+			continue;
+		}
+
+		if (h->size < h->capacity) { // free slot
+			s = h->size++;
+			h->slots[s].value = value;
+			h->slots[s].count = 1;
+			h->slots[s].error = 0;
+			h->slots[s].heapPos = s;
+			h->heap[s] = s;
+			h->index[i] = s + 1;
+			heapUp(h, s);
+			continue;
+		}
+
+		// replace the minimum
+		s = h->heap[0];
+		indexRemove(h, indexFind(h, h->slots[s].value));
+		h->slots[s].value = value;
+		h->slots[s].error = h->slots[s].count;
+		h->slots[s].count++;
+		h->index[indexFind(h, value)] = s + 1;
+		heapDown(h, 0);
+		h->replaced = true;
+	}
+}
+
+/*!	 \fn heavyHitterModes
+	 \return false if out of memory
+	 \param const struct heavyHitters* h, struct modes* out
+
+	 Approximate modes: the tracked values with the highest count.
+	 Exact as long as the summary never had to replace a value. */
+bool heavyHitterModes(const struct heavyHitters* h, struct modes* out) {
+	out->error = 0;
+	out->untracked = 0;
+	if (h->size == 0) {
+		out->values = NULL;
+		out->numModes = 0;
+		out->count = 0;
+		out->duplicated = 0;
+		out->duplicates = 0;
+		return true;
+	}
+
+	struct countEntry* table = (struct countEntry*)malloc(sizeof(struct countEntry) * h->size);
+	if (table == NULL)
+		return false;
+	for (size_t i = 0; i < h->size; i++) {
+		table[i].value = h->slots[i].value;
+		table[i].count = h->slots[i].count;
+	}
+	bool ok = collectModes(table, h->size, out);
+	free(table);
+	if (!ok)
+		return false;
+
+	for (size_t i = 0; i < h->size; i++) {
+		if (h->slots[i].count == out->count && h->slots[i].error > out->error)
+			out->error = h->slots[i].error;
+	}
+	if (h->size == h->capacity && out->error != 0) // a replaced value had at most the smallest count
+		out->untracked = h->slots[h->heap[0]].count;
+	if (h->floor > out->untracked)
+		out->untracked = h->floor;
+	return true;
+}
+
+/*!	 \fn heavyHitterBound
+	 \return how often a value that is not tracked can occur at most
+	 \param const struct heavyHitters* h */
+size_t heavyHitterBound(const struct heavyHitters* h) {
+	size_t bound = h->floor;
+	if (h->replaced && h->size > 0 && h->slots[h->heap[0]].count > bound)
+		bound = h->slots[h->heap[0]].count;
+	return bound;
+}
+
+static int compareHitters(const void* a, const void* b) {
+	const struct heavyHitter* x = (const struct heavyHitter*)a;
+	const struct heavyHitter* y = (const struct heavyHitter*)b;
+
+	if (x->count != y->count)
+		return x->count > y->count ? -1 : 1;
+	return x->value < y->value ? -1 : x->value > y->value;
+}
+
+/*!	 \fn mergeHeavyHitters
+	 \return false if out of memory (h is unchanged then)
+	 \param struct heavyHitters* h, const struct heavyHitter src[] - tracked values of another summary,
+			size_t size, size_t srcBound - heavyHitterBound of the other summary
+
+	 Merge another summary into h (Agarwal et al., mergeable summaries). A value missing from one side
+	 counts that side's bound, both as count and as error, and the capacity largest counts are kept.
+	 Counts stay upper bounds and count - error lower bounds, in any order of merging. */
+bool mergeHeavyHitters(struct heavyHitters* h, const struct heavyHitter src[], size_t size, size_t srcBound) {
+	size_t bound = heavyHitterBound(h);
+	size_t n = h->size;
+
+	struct heavyHitter* all = (struct heavyHitter*)malloc(sizeof(struct heavyHitter) * (h->size + size + 1));
+	if (all == NULL)
+		return false;
+
+	// values of h at their slot numbers, as if src did not have them
+	for (size_t s = 0; s < h->size; s++) {
+		all[s] = h->slots[s];
+		all[s].count += srcBound;
+		all[s].error += srcBound;
+	}
+	for (size_t j = 0; j < size; j++) {
+		size_t i = indexFind(h, src[j].value);
+		if (h->index[i] != 0) {
+			struct heavyHitter* both = &all[h->index[i] - 1];
+			both->count += src[j].count - srcBound;
+			both->error += src[j].error - srcBound;
+		}
+		else {
+			all[n] = src[j];
+			all[n].count += bound;
+			all[n].error += bound;
+			n++;
+		}
+	}
+
+	qsort(all, n, sizeof(struct heavyHitter), compareHitters);
+	size_t keep = n < h->capacity ? n : h->capacity;
+	size_t dropped = keep < n ? all[keep].count : 0;
+
+	memset(h->index, 0, sizeof(size_t) * (h->indexMask + 1));
+	h->size = 0;
+	for (size_t s = 0; s < keep; s++) {
+		h->slots[s] = all[s];
+		h->slots[s].heapPos = s;
+		h->heap[s] = s;
+		h->index[indexFind(h, all[s].value)] = s + 1;
+		h->size++;
+		heapUp(h, s);
+	}
+	free(all);
+
+	h->floor = bound + srcBound > dropped ? bound + srcBound : dropped;
+	h->replaced = false;
+	return true;
+}
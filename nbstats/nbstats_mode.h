@@ -0,0 +1,57 @@
+/*!	\file		nbstats_mode.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Mode without sorting: exact counting in a hash table (for long double, double and float), and a bounded memory
+	heavy-hitters summary (Space-Saving) for the streaming mode.
+*/
+#ifndef NBSTATS_MODE_H
+#define NBSTATS_MODE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// values that occur most often
+struct modes {
+	long double* values;	// ascending
+	size_t numModes;		// 0 if every value occurs once
+	size_t count;			// occurrences of each mode
+	size_t error;			// count may be too high by this much (heavy hitters only)
+	size_t untracked;		// values not in the summary occur at most this often (heavy hitters only)
+	size_t duplicated;		// values that occur more than once (number duplication test)
+	size_t duplicates;		// occurrences of them after the first
+};
+
+bool findModes(const long double a[], size_t size, struct modes* out);
+bool findModesDouble(const double a[], size_t size, struct modes* out);
+bool findModesFloat(const float a[], size_t size, struct modes* out);
+void freeModes(struct modes* m);
+
+struct heavyHitter {
+	long double value;
+	size_t count;			// estimated occurrences (never below the true count)
+	size_t error;			// count - error is a lower bound
+	size_t heapPos;
+};
+
+// Space-Saving summary of at most capacity distinct values
+struct heavyHitters {
+	size_t capacity;
+	size_t size;
+	struct heavyHitter* slots;
+	size_t* heap;			// slot numbers, min-heap on count
+	size_t* index;			// hash of value -> slot number + 1 (0 = empty)
+	size_t indexMask;
+	bool replaced;			// a value was replaced, untracked values occur at most as often as the minimum
+	size_t floor;			// untracked values of merged summaries occur at most this often
+};
+
+bool initHeavyHitters(struct heavyHitters* h, size_t capacity);
+void freeHeavyHitters(struct heavyHitters* h);
+void addHeavyHitters(struct heavyHitters* h, const long double a[], size_t size);
+bool heavyHitterModes(const struct heavyHitters* h, struct modes* out);
+size_t heavyHitterBound(const struct heavyHitters* h);
+bool mergeHeavyHitters(struct heavyHitters* h, const struct heavyHitter src[], size_t size, size_t srcBound);
+
+#endif
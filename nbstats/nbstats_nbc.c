@@ -0,0 +1,160 @@
+/*!	\file		nbstats_nbc.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Writing and checking .nbc binary column files. A build writes its long double as it is when that is
+	wider than double, so nothing is lost; such a file can only be read by a build with the same long double.
+	Files of double values are read by every build.
+*/
+#include "nbstats_nbc.h"
+
+#include <errno.h>
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "nbstats_digits.h"
+
+#define WRITE_BLOCK		4096	// values converted and written at a time
+
+/*!	 \fn isNbc
+	 \return true if the data starts like a .nbc file
+	 \param const char* data, size_t size - whole file */
+bool isNbc(const char* data, size_t size) {
+	return size >= sizeof(struct nbcHeader) && memcmp(data, NBC_MAGIC, sizeof(NBC_MAGIC)) == 0;
+}
+
+/*!	 \fn openNbc
+	 \return false if the file is damaged, incomplete or holds a long double this build does not have
+	 \param const char* data, size_t size - whole file (mapped, so the values are aligned), struct nbcView* view
+
+	 Check the header, the sizes and the footer, and locate the values and digits in place */
+bool openNbc(const char* data, size_t size, struct nbcView* view) {
+	struct nbcHeader header;
+	struct nbcFooter footer;
+
+	if (!isNbc(data, size) || size < sizeof(header) + sizeof(footer))
+		return false;
+	memcpy(&header, data, sizeof(header));
+	if (header.version != NBC_VERSION || header.byteOrder != NBC_BYTE_ORDER)
+		return false;
+
+	if (header.valueSize == sizeof(long double) && header.mantissaDigits == LDBL_MANT_DIG)
+		view->native = true;
+	else if (header.valueSize == sizeof(double) && header.mantissaDigits == DBL_MANT_DIG)
+		view->native = false;
+	else
+		return false;
+
+	// sizes without overflow: count is checked against the file size first
+	size_t room = size - sizeof(header) - sizeof(footer);
+	size_t perValue = header.valueSize + ((header.flags & NBC_DIGITS) ? 1 : 0);
+	if (header.count > room / perValue)
+		return false;
+	size_t count = (size_t)header.count;
+	size_t digitsAt = sizeof(header) + count * header.valueSize;
+	size_t footerAt = digitsAt + ((header.flags & NBC_DIGITS) ? count : 0);
+	footerAt = (footerAt + 7) & ~(size_t)7;
+	if (footerAt + sizeof(footer) != size)
+		return false;
+
+	memcpy(&footer, data + footerAt, sizeof(footer));
+	if (footer.count != header.count || memcmp(footer.magic, NBC_END, sizeof(NBC_END)) != 0)
+		return false;
+
+	view->values = data + sizeof(header);
+	view->count = count;
+	view->digits = (header.flags & NBC_DIGITS) ? (const unsigned char*)data + digitsAt : NULL;
+	return true;
+}
+
+/*!	 \fn writeNbc
+	 \return false if the file could not be written (errno is set)
+	 \param const char* fileName, const long double a[] - accepted numbers, size_t size - how many numbers in array
+
+	 Write the numbers and their leading digits as a .nbc file */
+bool writeNbc(const char* fileName, const long double a[], size_t size) {
+	static const unsigned char zeros[8] = { 0 };
+	struct nbcHeader header;
+	struct nbcFooter footer;
+	bool native = LDBL_MANT_DIG > DBL_MANT_DIG;
+	size_t valueSize = native ? sizeof(long double) : sizeof(double);
+	double block[WRITE_BLOCK];
+	unsigned char digits[WRITE_BLOCK];
+	bool ok = true;
+
+	FILE* out;
+#ifdef _WIN32
+	if (fopen_s(&out, fileName, "wb") != 0)
+		return false;
+#else
+	if ((out = fopen(fileName, "wb")) == NULL)
+		return false;
+#endif
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, NBC_MAGIC, sizeof(NBC_MAGIC));
+	header.version = NBC_VERSION;
+	header.byteOrder = NBC_BYTE_ORDER;
+	header.valueSize = (uint32_t)valueSize;
+	header.mantissaDigits = native ? LDBL_MANT_DIG : DBL_MANT_DIG;
+	header.flags = NBC_DIGITS;
+	header.count = size;
+	ok = fwrite(&header, sizeof(header), 1, out) == 1;
+
+	// values
+	long double min = size > 0 ? a[0] : 0;
+	long double max = min;
+	for (size_t at = 0; ok && at < size; at += WRITE_BLOCK) {
+		size_t n = size - at < WRITE_BLOCK ? size - at : WRITE_BLOCK;
+		for (size_t i = 0; i < n; i++) {
+			min = a[at + i] < min ? a[at + i] : min;
+			max = a[at + i] > max ? a[at + i] : max;
+		}
+		if (native) {
+			ok = fwrite(a + at, sizeof(long double), n, out) == n;
+		}
+		else {
+			for (size_t i = 0; i < n; i++)
+				block[i] = (double)a[at + i];
+			ok = fwrite(block, sizeof(double), n, out) == n;
+		}
+	}
+
+	// leading digits, then padding up to the footer
+	for (size_t at = 0; ok && at < size; at += WRITE_BLOCK) {
+		size_t n = size - at < WRITE_BLOCK ? size - at : WRITE_BLOCK;
+		for (size_t i = 0; i < n; i++)
+			digits[i] = (unsigned char)fastLeadingDigit(a[at + i]);
+		ok = fwrite(digits, 1, n, out) == n;
+	}
+	size_t padding = (8 - (sizeof(header) + size * valueSize + size) % 8) % 8;
+	if (ok && padding > 0)
+		ok = fwrite(zeros, 1, padding, out) == padding;
+
+	memset(&footer, 0, sizeof(footer));
+	footer.count = size;
+	if (native) {
+		memcpy(footer.min, &min, sizeof(long double));
+		memcpy(footer.max, &max, sizeof(long double));
+	}
+	else {
+		double d = (double)min;
+		memcpy(footer.min, &d, sizeof(double));
+		d = (double)max;
+		memcpy(footer.max, &d, sizeof(double));
+	}
+	memcpy(footer.magic, NBC_END, sizeof(NBC_END));
+	if (ok)
+		ok = fwrite(&footer, sizeof(footer), 1, out) == 1;
+
+	if (fclose(out) != 0)
+		ok = false;
+	if (!ok) { // no partial file is left, keep the errno of the failure
+		int error = errno;
+		remove(fileName);
+		errno = error;
+	}
+	return ok;
+}
@@ -0,0 +1,58 @@
+/*!	\file		nbstats_nbc.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	.nbc binary column file: the accepted numbers of a data set, stored so they can be analyzed
+	again straight from a memory mapping, without parsing.
+
+	offset 0		struct nbcHeader (64 bytes)
+	offset 64		count values, 8 bytes (IEEE double) or the long double of the writing build
+	then			count leading digit bytes (1 ~ 9), if NBC_DIGITS is set
+	then			struct nbcFooter (48 bytes), at the next multiple of 8
+*/
+#ifndef NBSTATS_NBC_H
+#define NBSTATS_NBC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NBC_MAGIC		"NBSTATS"		// 8 bytes with the terminating null
+#define NBC_END			"NBCEND"
+#define NBC_VERSION		1
+#define NBC_BYTE_ORDER	0x01020304u		// reads differently on a machine of the other byte order
+#define NBC_DIGITS		0x1u			// flags: a leading digit byte per value follows the values
+
+struct nbcHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t valueSize;			// 8, or sizeof(long double)
+	uint32_t mantissaDigits;	// 53 (double), or LDBL_MANT_DIG
+	uint32_t flags;
+	uint32_t reserved;
+	uint64_t count;
+	uint8_t padding[24];
+};
+
+struct nbcFooter {
+	uint64_t count;				// same as the header, the file was completely written
+	uint8_t min[16];			// smallest and largest value in the format of the values
+	uint8_t max[16];
+	char magic[8];
+};
+
+// values of a mapped .nbc file
+struct nbcView {
+	const void* values;
+	size_t count;
+	bool native;				// values are long double of this build, otherwise double
+	const unsigned char* digits;	// NULL if not stored
+};
+
+bool isNbc(const char* data, size_t size);
+bool openNbc(const char* data, size_t size, struct nbcView* view);
+bool writeNbc(const char* fileName, const long double a[], size_t size);
+
+#endif
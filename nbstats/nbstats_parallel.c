@@ -0,0 +1,261 @@
+/*!	\file		nbstats_parallel.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Multi-threaded ingestion: the input is split into chunks after white-space, every worker tokenizes
+	its chunk and gathers the partial statistics of it, the partials are merged at the end.
+	A worker starts outside of a number with letters; the rare chunk whose predecessor ended inside one
+	(letters, then punctuation, then tokens up to the split) is scanned again once that is known.
+	When the numbers themselves are not wanted every worker takes its chunk a block at a time, in constant memory.
+	Rejection messages are held back and reported in input order with their element numbers,
+	so the output is the same as the single-threaded scan.
+*/
+#include "nbstats_parallel.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_platform.h"
+
+#define MIN_CHUNK	(1 << 16)	// no thread for less than 64KB of input
+#define SCAN_BLOCK	(1 << 20)	// input tokenized at a time when the numbers are not gathered
+
+// rejected token, index is relative to the chunk
+struct rejection {
+	enum rejectReason reason;
+	size_t index;
+	const char* token;
+	size_t length;
+};
+
+struct chunk {
+	const char* begin;
+	size_t len;
+	struct tokenizer tok;
+	struct partial stats;
+	struct digitTests tests;
+	bool countTests;			// forensic digit tests wanted
+	bool gather;				// the numbers are kept in tok until the chunks are joined
+	bool inNumber;				// starts inside a number with letters (chInNum at the end of the chunk before)
+	struct rejection* rejections;
+	size_t numRejections;
+	size_t capRejections;
+	int status;
+	struct thread thread;
+};
+
+static inline bool isSpaceCh(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+/*!	 \fn findSplit
+	 \return offset of the first chunk boundary at or after from (len if there is none)
+	 \param const char* buf, size_t len - input, size_t from
+
+	 A chunk starts right after a white-space character. No token of the single-threaded scan goes past
+	 white-space, which it either skips or takes as the end of the token before, so the chunk before ends
+	 with that character in the same state as the single-threaded scan: its chInNum tells where the next
+	 chunk starts. */
+static size_t findSplit(const char* buf, size_t len, size_t from) {
+	for (size_t w = from; w < len; w++) {
+		if (isSpaceCh(buf[w]))
+			return w + 1;
+	}
+	return len;
+}
+
+/*!	 \fn recordRejection
+	 \return none
+	 \param void* ctx - struct chunk, enum rejectReason reason, size_t index, const char* token, size_t length
+
+	 Reject handler of the workers, keeps the rejection until the chunks before are counted */
+static void recordRejection(void* ctx, enum rejectReason reason, size_t index, const char* token, size_t length) {
+	struct chunk* c = (struct chunk*)ctx;
+
+	if (c->numRejections == c->capRejections) {
+		size_t capacity = c->capRejections == 0 ? 16 : c->capRejections * 2;
+		struct rejection* rejectionsDouble = (struct rejection*)realloc(c->rejections, sizeof(struct rejection) * capacity);
+		if (rejectionsDouble == NULL) {
+			c->status = TOKENIZER_NOMEM;
+			return;
+		}
+		c->rejections = rejectionsDouble;
+		c->capRejections = capacity;
+	}
+
+	struct rejection* r = &c->rejections[c->numRejections++];
+	r->reason = reason;
+	r->index = index;
+	r->token = token;
+	r->length = length;
+}
+
+/*!	 \fn scanPart
+	 \return none, c->status
+	 \param struct chunk* c, const char* buf, size_t len - the chunk or a block of it that ends a token
+
+	 Tokenize and add the partial statistics of the numbers */
+static void scanPart(struct chunk* c, const char* buf, size_t len) {
+	size_t used = 0;
+
+	int status = scanNumbers(&c->tok, buf, len, true, &used);
+	if (c->status == TOKENIZER_OK)
+		c->status = status;
+	if (c->status == TOKENIZER_OK && c->countTests)
+		addPartialTests(&c->stats, &c->tests, c->tok.values, c->tok.size);
+	else if (c->status == TOKENIZER_OK)
+		addPartial(&c->stats, c->tok.values, c->tok.size);
+}
+
+/*!	 \fn scanChunk
+	 \return none
+	 \param void* arg - struct chunk
+
+	 Worker: tokenize one chunk and gather its partial statistics. Without gather the chunk is split
+	 like the input, and the numbers of every block are dropped once added. */
+static void scanChunk(void* arg) {
+	struct chunk* c = (struct chunk*)arg;
+
+	if (!initTokenizer(&c->tok)) {
+		c->status = TOKENIZER_NOMEM;
+		return;
+	}
+	c->tok.onReject = recordRejection;
+	c->tok.rejectCtx = c;
+	c->tok.chInNum = c->inNumber;
+
+	if (c->gather) {
+		scanPart(c, c->begin, c->len);
+		return;
+	}
+	for (size_t at = 0; at < c->len && c->status == TOKENIZER_OK;) {
+		size_t end = c->len - at > SCAN_BLOCK ? findSplit(c->begin, c->len, at + SCAN_BLOCK) : c->len;
+		scanPart(c, c->begin + at, end - at);
+		c->tok.size = 0;
+		c->tok.values[0] = 0;
+		at = end;
+	}
+}
+
+/*!	 \fn rescanChunk
+	 \return none
+	 \param struct chunk* c - scanned, bool inNumber - chInNum at the end of the chunk before
+
+	 Forget what the worker found and tokenize the chunk again from the right state, on the calling thread */
+static void rescanChunk(struct chunk* c, bool inNumber) {
+	freeTokenizer(&c->tok);
+	initPartial(&c->stats);
+	if (c->countTests)
+		initDigitTests(&c->tests, c->tests.enabled);
+	c->numRejections = 0;
+	c->status = TOKENIZER_OK;
+	c->inNumber = inNumber;
+	scanChunk(c);
+}
+
+/*!	 \fn scanParallel
+	 \return TOKENIZER_OK, TOKENIZER_NOMEM or TOKENIZER_INVALID
+	 \param const char* buf, size_t len - whole input, unsigned threads - number of workers,
+			rejectHandler onReject, void* rejectCtx - receives the rejections in input order,
+			long double** values - all accepted numbers (0 at the end of array), NULL: not gathered,
+			size_t* size - # accepted numbers,
+			struct partial* stats - count, sum, sum of squares, range and raw frequency of values,
+			struct digitTests* tests - the forensic digit tests of values are added, NULL: none
+
+	 Tokenize buf with several threads */
+int scanParallel(const char* buf, size_t len, unsigned threads, rejectHandler onReject, void* rejectCtx,
+	long double** values, size_t* size, struct partial* stats, struct digitTests* tests) {
+	int status = TOKENIZER_OK;
+
+	if (threads > len / MIN_CHUNK + 1)
+		threads = (unsigned)(len / MIN_CHUNK + 1);
+	if (threads == 0)
+		threads = 1;
+
+	struct chunk* chunks = (struct chunk*)calloc(threads, sizeof(struct chunk));
+	if (chunks == NULL)
+		return TOKENIZER_NOMEM;
+
+	// split at white-space near every 1/threads of the input
+	size_t begin = 0;
+	for (unsigned i = 0; i < threads; i++) {
+		size_t end = len;
+		if (i + 1 < threads) {
+			end = findSplit(buf, len, len / threads * (i + 1));
+			if (end < begin)
+				end = begin;
+		}
+		chunks[i].begin = buf + begin;
+		chunks[i].len = end - begin;
+		chunks[i].gather = values != NULL;
+		initPartial(&chunks[i].stats);
+		if (tests != NULL) {
+			initDigitTests(&chunks[i].tests, tests->enabled);
+			chunks[i].countTests = true;
+		}
+		begin = end;
+	}
+
+	// the first chunk runs on this thread
+	for (unsigned i = 1; i < threads; i++) {
+		if (!startThread(&chunks[i].thread, scanChunk, &chunks[i]))
+			scanChunk(&chunks[i]);
+	}
+	scanChunk(&chunks[0]);
+	for (unsigned i = 1; i < threads; i++)
+		joinThread(&chunks[i].thread);
+	for (unsigned i = 1; i < threads && chunks[i - 1].status == TOKENIZER_OK; i++) {
+		if (chunks[i - 1].tok.chInNum != chunks[i].inNumber)
+			rescanChunk(&chunks[i], chunks[i - 1].tok.chInNum);
+	}
+
+	// report in input order, stop at the first failure as the single-threaded scan does
+	size_t total = 0;
+	unsigned used = 0;
+	initPartial(stats);
+	for (unsigned i = 0; i < threads; i++) {
+		struct chunk* c = &chunks[i];
+		for (size_t r = 0; r < c->numRejections; r++) {
+			if (onReject != NULL)
+				onReject(rejectCtx, c->rejections[r].reason, total + c->rejections[r].index, c->rejections[r].token, c->rejections[r].length);
+		}
+		if (c->status != TOKENIZER_OK) {
+			status = c->status;
+			break;
+		}
+		mergePartial(stats, &c->stats);
+		if (tests != NULL)
+			mergeDigitTests(tests, &c->tests);
+		total += c->tok.total;
+		used++;
+	}
+
+	if (status == TOKENIZER_OK && values == NULL) {
+		*size = total;
+	}
+	else if (status == TOKENIZER_OK) {
+		// the first chunk's array grows to take the others
+		long double* all = (long double*)realloc(chunks[0].tok.values, sizeof(long double) * (total + 1));
+		if (all == NULL) {
+			status = TOKENIZER_NOMEM;
+		}
+		else {
+			size_t at = chunks[0].tok.size;
+			for (unsigned i = 1; i < used; i++) {
+				memcpy(all + at, chunks[i].tok.values, sizeof(long double) * chunks[i].tok.size);
+				at += chunks[i].tok.size;
+			}
+			all[total] = 0; // end of array
+			chunks[0].tok.values = NULL;
+			*values = all;
+			*size = total;
+		}
+	}
+
+	for (unsigned i = 0; i < threads; i++) {
+		freeTokenizer(&chunks[i].tok);
+		free(chunks[i].rejections);
+	}
+	free(chunks);
+	return status;
+}
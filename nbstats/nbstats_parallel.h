@@ -0,0 +1,20 @@
+/*!	\file		nbstats_parallel.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Multi-threaded ingestion of an in-memory (mapped) input.
+*/
+#ifndef NBSTATS_PARALLEL_H
+#define NBSTATS_PARALLEL_H
+
+#include <stddef.h>
+
+#include "nbstats_digits.h"
+#include "nbstats_stats.h"
+#include "nbstats_tokenizer.h"
+
+int scanParallel(const char* buf, size_t len, unsigned threads, rejectHandler onReject, void* rejectCtx,
+	long double** values, size_t* size, struct partial* stats, struct digitTests* tests);
+
+#endif
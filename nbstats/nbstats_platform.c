@@ -0,0 +1,723 @@
+/*!	\file		nbstats_platform.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Operating system services: memory-mapped input files, worker threads and their locks, clocks and memory use,
+	sleeping, local sockets, the code page of the Windows console.
+*/
+#include "nbstats_platform.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>	// before windows.h, which would bring the old winsock.h
+#include <afunix.h>
+#include <windows.h>
+#include <process.h>
+#include <psapi.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/*!	 \fn mapFile
+	 \return true if the whole file is mapped, false otherwise (empty file, too large, no permission ...)
+	 \param const char* fileName, struct mappedFile* view - receives the mapping
+
+	 Map a file read-only into memory so the tokenizer can scan it in place.
+	 \note An empty file can not be mapped, the caller falls back to reading the stream. */
+bool mapFile(const char* fileName, struct mappedFile* view) {
+	view->data = NULL;
+	view->size = 0;
+	view->file = NULL;
+	view->mapping = NULL;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || (unsigned long long)size.QuadPart > SIZE_MAX) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL) {
+		CloseHandle(file);
+		return false;
+	}
+
+	const char* data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == NULL) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	view->data = data;
+	view->size = (size_t)size.QuadPart;
+	view->file = file;
+	view->mapping = mapping;
+#else
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0 || (unsigned long long)st.st_size > SIZE_MAX) {
+		close(fd);
+		return false;
+	}
+
+	void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+	madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	view->data = (const char*)data;
+	view->size = (size_t)st.st_size;
+	view->file = (void*)(intptr_t)fd;
+#endif
+	return true;
+}
+
+/*!	 \fn unmapFile
+	 \return none
+	 \param struct mappedFile* view
+
+	 Release a mapping made by mapFile */
+void unmapFile(struct mappedFile* view) {
+	if (view->data == NULL)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(view->data);
+	CloseHandle((HANDLE)view->mapping);
+	CloseHandle((HANDLE)view->file);
+#else
+	munmap((void*)view->data, view->size);
+	close((int)(intptr_t)view->file);
+#endif
+	view->data = NULL;
+	view->size = 0;
+}
+
+/*!	 \fn fileSize
+	 \return true if the size is known, false otherwise (no such file, no permission ...)
+	 \param const char* fileName, unsigned long long* size - receives the size in bytes */
+bool fileSize(const char* fileName, unsigned long long* size) {
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(fileName, GetFileExInfoStandard, &attributes))
+		return false;
+	*size = (unsigned long long)attributes.nFileSizeHigh << 32 | attributes.nFileSizeLow;
+#else
+	struct stat st;
+	if (stat(fileName, &st) != 0)
+		return false;
+	*size = (unsigned long long)st.st_size;
+#endif
+	return true;
+}
+
+#ifdef _WIN32
+static unsigned __stdcall threadMain(void* arg) {
+	struct thread* t = (struct thread*)arg;
+	t->proc(t->arg);
+	return 0;
+}
+#else
+static void* threadMain(void* arg) {
+	struct thread* t = (struct thread*)arg;
+	t->proc(t->arg);
+	return NULL;
+}
+#endif
+
+/*!	 \fn startThread
+	 \return true if the thread is running
+	 \param struct thread* t, threadProc proc, void* arg
+
+	 Run proc(arg) on a new thread */
+bool startThread(struct thread* t, threadProc proc, void* arg) {
+	t->proc = proc;
+	t->arg = arg;
+	t->handle = NULL;
+
+#ifdef _WIN32
+	uintptr_t handle = _beginthreadex(NULL, 0, threadMain, t, 0, NULL);
+	if (handle == 0)
+		return false;
+	t->handle = (void*)handle;
+#else
+	pthread_t* handle = (pthread_t*)malloc(sizeof(pthread_t));
+	if (handle == NULL)
+		return false;
+	if (pthread_create(handle, NULL, threadMain, t) != 0) {
+		free(handle);
+		return false;
+	}
+	t->handle = handle;
+#endif
+	return true;
+}
+
+/*!	 \fn joinThread
+	 \return none
+	 \param struct thread* t
+
+	 Wait for a thread started by startThread to finish */
+void joinThread(struct thread* t) {
+	if (t->handle == NULL)
+		return;
+
+#ifdef _WIN32
+	WaitForSingleObject((HANDLE)t->handle, INFINITE);
+	CloseHandle((HANDLE)t->handle);
+#else
+	pthread_join(*(pthread_t*)t->handle, NULL);
+	free(t->handle);
+#endif
+	t->handle = NULL;
+}
+
+/*!	 \fn initMutex
+	 \return false if out of resources
+	 \param struct mutex* m
+
+	 Create an unlocked mutex */
+bool initMutex(struct mutex* m) {
+#ifdef _WIN32
+	CRITICAL_SECTION* cs = (CRITICAL_SECTION*)malloc(sizeof(CRITICAL_SECTION));
+	if (cs == NULL)
+		return false;
+	InitializeCriticalSection(cs);
+	m->handle = cs;
+#else
+	pthread_mutex_t* mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
+	if (mutex == NULL)
+		return false;
+	if (pthread_mutex_init(mutex, NULL) != 0) {
+		free(mutex);
+		return false;
+	}
+	m->handle = mutex;
+#endif
+	return true;
+}
+
+/*!	 \fn freeMutex
+	 \return none
+	 \param struct mutex* m - not locked
+
+	 Release a mutex made by initMutex */
+void freeMutex(struct mutex* m) {
+	if (m->handle == NULL)
+		return;
+#ifdef _WIN32
+	DeleteCriticalSection((CRITICAL_SECTION*)m->handle);
+#else
+	pthread_mutex_destroy((pthread_mutex_t*)m->handle);
+#endif
+	free(m->handle);
+	m->handle = NULL;
+}
+
+/*!	 \fn lockMutex
+	 \return none
+	 \param struct mutex* m
+
+	 Wait until m is free and take it */
+void lockMutex(struct mutex* m) {
+#ifdef _WIN32
+	EnterCriticalSection((CRITICAL_SECTION*)m->handle);
+#else
+	pthread_mutex_lock((pthread_mutex_t*)m->handle);
+#endif
+}
+
+/*!	 \fn unlockMutex
+	 \return none
+	 \param struct mutex* m - locked by this thread
+
+	 Release m */
+void unlockMutex(struct mutex* m) {
+#ifdef _WIN32
+	LeaveCriticalSection((CRITICAL_SECTION*)m->handle);
+#else
+	pthread_mutex_unlock((pthread_mutex_t*)m->handle);
+#endif
+}
+
+/*!	 \fn initCondition
+	 \return false if out of resources
+	 \param struct condition* c */
+bool initCondition(struct condition* c) {
+#ifdef _WIN32
+	CONDITION_VARIABLE* cv = (CONDITION_VARIABLE*)malloc(sizeof(CONDITION_VARIABLE));
+	if (cv == NULL)
+		return false;
+	InitializeConditionVariable(cv);
+	c->handle = cv;
+#else
+	pthread_cond_t* cond = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
+	if (cond == NULL)
+		return false;
+	if (pthread_cond_init(cond, NULL) != 0) {
+		free(cond);
+		return false;
+	}
+	c->handle = cond;
+#endif
+	return true;
+}
+
+/*!	 \fn freeCondition
+	 \return none
+	 \param struct condition* c - nobody waits on it
+
+	 Release a condition made by initCondition */
+void freeCondition(struct condition* c) {
+	if (c->handle == NULL)
+		return;
+#ifndef _WIN32
+	pthread_cond_destroy((pthread_cond_t*)c->handle);
+#endif
+	free(c->handle);
+	c->handle = NULL;
+}
+
+/*!	 \fn waitCondition
+	 \return none
+	 \param struct condition* c, struct mutex* m - locked by this thread, locked again on return
+
+	 Release m until c is woken (or spuriously), the caller checks its state again */
+void waitCondition(struct condition* c, struct mutex* m) {
+#ifdef _WIN32
+	SleepConditionVariableCS((CONDITION_VARIABLE*)c->handle, (CRITICAL_SECTION*)m->handle, INFINITE);
+#else
+	pthread_cond_wait((pthread_cond_t*)c->handle, (pthread_mutex_t*)m->handle);
+#endif
+}
+
+/*!	 \fn wakeCondition
+	 \return none
+	 \param struct condition* c
+
+	 Wake every thread waiting on c */
+void wakeCondition(struct condition* c) {
+#ifdef _WIN32
+	WakeAllConditionVariable((CONDITION_VARIABLE*)c->handle);
+#else
+	pthread_cond_broadcast((pthread_cond_t*)c->handle);
+#endif
+}
+
+/*!	 \fn processorCount
+	 \return number of logical processors (at least 1)
+	 \param none
+
+	 How many threads can run at the same time */
+unsigned processorCount(void) {
+#ifdef _WIN32
+	DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+	return count > 0 ? (unsigned)count : 1;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (unsigned)count : 1;
+#endif
+}
+
+/*!	 \fn processorHasAvx2
+	 \return true if the processor and the operating system support AVX2
+	 \param none
+
+	 Asked from the operating system every time, nothing is cached so any thread may call it */
+bool processorHasAvx2(void) {
+#ifdef _WIN32
+#ifndef PF_AVX2_INSTRUCTIONS_AVAILABLE
+#define PF_AVX2_INSTRUCTIONS_AVAILABLE	40
+#endif
+	return IsProcessorFeaturePresent(PF_AVX2_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined(__x86_64__) || defined(__i386__)
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	return false;
+#endif
+}
+
+#ifdef _WIN32
+static UINT consoleCodePage;	// output code page of the console before useUtf8Console
+
+/*!	 \fn restoreConsole
+	 \return none
+	 \param none
+
+	 atexit: the console gets its code page back, after the UTF-8 still buffered is written */
+static void restoreConsole(void) {
+	fflush(stdout);
+	SetConsoleOutputCP(consoleCodePage);
+}
+
+/*!	 \fn restoreOnSignal
+	 \return FALSE, the default handler still ends the process
+	 \param DWORD event - Ctrl+C, Ctrl+Break or the console closing
+
+	 Console handler: the code page comes back also when the process is ended from the console */
+static BOOL WINAPI restoreOnSignal(DWORD event) {
+	(void)event;
+	SetConsoleOutputCP(consoleCodePage);
+	return FALSE;
+}
+#endif
+
+/*!	 \fn useUtf8Console
+	 \return none
+	 \param none
+
+	 The Windows console shows the output as UTF-8, the encoding of the text report everywhere, until the process
+	 exits. Nothing to do elsewhere, or when stdout is not the console (a redirection gets the UTF-8 as it is). */
+void useUtf8Console(void) {
+#ifdef _WIN32
+	DWORD mode;
+	if (!GetConsoleMode(GetStdHandle(STD_OUTPUT_HANDLE), &mode))
+		return;
+	consoleCodePage = GetConsoleOutputCP();
+	if (consoleCodePage != 0 && consoleCodePage != CP_UTF8 && SetConsoleOutputCP(CP_UTF8)) {
+		atexit(restoreConsole);
+		SetConsoleCtrlHandler(restoreOnSignal, TRUE);
+	}
+#endif
+}
+
+/*!	 \fn wallSeconds
+	 \return seconds since some fixed point in the past
+	 \param none
+
+	 Monotonic clock, only differences of two calls mean anything */
+double wallSeconds(void) {
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+/*!	 \fn cpuSeconds
+	 \return processor time of the process so far, all threads (user and kernel)
+	 \param none */
+double cpuSeconds(void) {
+#ifdef _WIN32
+	FILETIME created, exited, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+		return 0;
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return (double)(k.QuadPart + u.QuadPart) * 1e-7; // 100 ns units
+#else
+	struct timespec now;
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0)
+		return 0;
+	return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+/*!	 \fn peakMemory
+	 \return largest resident set (working set on Windows) of the process so far in bytes, 0 if unknown
+	 \param none */
+size_t peakMemory(void) {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return (size_t)usage.ru_maxrss; // bytes
+#else
+	return (size_t)usage.ru_maxrss * 1024; // kilobytes
+#endif
+#endif
+}
+
+/*!	 \fn sleepSeconds
+	 \return none
+	 \param double seconds - millisecond resolution
+
+	 Let the processor go while waiting for a file to grow */
+void sleepSeconds(double seconds) {
+	if (seconds <= 0)
+		return;
+#ifdef _WIN32
+	Sleep((DWORD)(seconds * 1000));
+#else
+	struct timespec wait;
+	wait.tv_sec = (time_t)seconds;
+	wait.tv_nsec = (long)((seconds - (double)wait.tv_sec) * 1e9);
+	nanosleep(&wait, NULL);
+#endif
+}
+
+#ifdef _WIN32
+typedef SOCKET nativeSocket;
+#define NO_SOCKET		INVALID_SOCKET
+#define closeNative		closesocket
+#define lastSocketError	WSAGetLastError()
+#define ERROR_IN_USE	WSAEADDRINUSE
+#define ERROR_REFUSED	WSAECONNREFUSED
+#define ERROR_AGAIN(e)	((e) == WSAEWOULDBLOCK)
+#else
+typedef int nativeSocket;
+#define NO_SOCKET		(-1)
+#define closeNative		close
+#define lastSocketError	errno
+#define ERROR_IN_USE	EADDRINUSE
+#define ERROR_REFUSED	ECONNREFUSED
+#define ERROR_AGAIN(e)	((e) == EAGAIN || (e) == EWOULDBLOCK || (e) == EINTR)
+#endif
+
+/*!	 \fn setNonBlocking
+	 \return false if the socket can not be made non-blocking
+	 \param nativeSocket s */
+static bool setNonBlocking(nativeSocket s) {
+#ifdef _WIN32
+	u_long on = 1;
+	return ioctlsocket(s, FIONBIO, &on) == 0;
+#else
+	int flags = fcntl(s, F_GETFL, 0);
+	if (flags < 0 || fcntl(s, F_SETFL, flags | O_NONBLOCK) != 0)
+		return false;
+#ifdef SO_NOSIGPIPE
+	int on = 1;
+	setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on)); // a peer that went away must not end the daemon
+#endif
+	return true;
+#endif
+}
+
+/*!	 \fn isStale
+	 \return true if nobody listens on the socket file (left by a daemon that did not end normally)
+	 \param const struct sockaddr_un* address */
+static bool isStale(const struct sockaddr_un* address) {
+	nativeSocket probe = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (probe == NO_SOCKET)
+		return false;
+	bool stale = connect(probe, (const struct sockaddr*)address, sizeof(*address)) != 0 && lastSocketError == ERROR_REFUSED;
+	closeNative(probe);
+	return stale;
+}
+
+/*!	 \fn startSockets
+	 \return false if the sockets of Windows can not be started
+	 \param none */
+static bool startSockets(void) {
+#ifdef _WIN32
+	static bool started = false;
+	WSADATA wsa;
+	if (!started && WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+		return false;
+	started = true;
+#endif
+	return true;
+}
+
+/*!	 \fn listenLocal
+	 \return false if the socket can not be created (path too long, in use by a running daemon, no permission ...)
+	 \param const char* path - socket file, intptr_t* listener - receives the listening socket
+
+	 A socket file that nobody listens on any more is replaced */
+bool listenLocal(const char* path, intptr_t* listener) {
+	struct sockaddr_un address;
+	size_t length = strlen(path);
+
+	if (!startSockets() || length >= sizeof(address.sun_path))
+		return false;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	memcpy(address.sun_path, path, length);
+
+	nativeSocket s = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (s == NO_SOCKET)
+		return false;
+	int bound = bind(s, (const struct sockaddr*)&address, sizeof(address));
+	if (bound != 0 && lastSocketError == ERROR_IN_USE && isStale(&address)) {
+		removeLocal(path);
+		bound = bind(s, (const struct sockaddr*)&address, sizeof(address));
+	}
+	if (bound != 0 || listen(s, SOMAXCONN) != 0 || !setNonBlocking(s)) {
+		closeNative(s);
+		return false;
+	}
+	*listener = (intptr_t)s;
+	return true;
+}
+
+/*!	 \fn acceptLocal
+	 \return false if no connection is waiting (or it failed)
+	 \param intptr_t listener, intptr_t* client - receives the non-blocking connection */
+bool acceptLocal(intptr_t listener, intptr_t* client) {
+	nativeSocket s = accept((nativeSocket)listener, NULL, NULL);
+
+	if (s == NO_SOCKET)
+		return false;
+	if (!setNonBlocking(s)) {
+		closeNative(s);
+		return false;
+	}
+	*client = (intptr_t)s;
+	return true;
+}
+
+/*!	 \fn pairLocal
+	 \return false if the sockets can not be created
+	 \param intptr_t* readEnd, intptr_t* writeEnd - receive two connected non-blocking sockets
+
+	 A thread wakes another one waiting in pollLocal on readEnd by sending a byte to writeEnd.
+	 \note Windows has no socketpair, the two ends are connected over the loopback interface */
+bool pairLocal(intptr_t* readEnd, intptr_t* writeEnd) {
+	nativeSocket ends[2] = { NO_SOCKET, NO_SOCKET };
+
+	if (!startSockets())
+		return false;
+#ifdef _WIN32
+	struct sockaddr_in address;
+	int length = sizeof(address);
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0; // any free port
+
+	nativeSocket listener = socket(AF_INET, SOCK_STREAM, 0);
+	bool ok = listener != NO_SOCKET
+		&& bind(listener, (const struct sockaddr*)&address, sizeof(address)) == 0 && listen(listener, 1) == 0
+		&& getsockname(listener, (struct sockaddr*)&address, &length) == 0
+		&& (ends[1] = socket(AF_INET, SOCK_STREAM, 0)) != NO_SOCKET
+		&& connect(ends[1], (const struct sockaddr*)&address, sizeof(address)) == 0
+		&& (ends[0] = accept(listener, NULL, NULL)) != NO_SOCKET;
+	if (listener != NO_SOCKET)
+		closeNative(listener);
+#else
+	bool ok = socketpair(AF_UNIX, SOCK_STREAM, 0, ends) == 0;
+#endif
+	if (!ok || !setNonBlocking(ends[0]) || !setNonBlocking(ends[1])) {
+		if (ends[0] != NO_SOCKET)
+			closeNative(ends[0]);
+		if (ends[1] != NO_SOCKET)
+			closeNative(ends[1]);
+		return false;
+	}
+	*readEnd = (intptr_t)ends[0];
+	*writeEnd = (intptr_t)ends[1];
+	return true;
+}
+
+/*!	 \fn receiveLocal
+	 \return bytes received, 0 if the peer closed the connection or on an error, -1 if nothing is there yet
+	 \param intptr_t socket, char* buf, size_t len */
+ptrdiff_t receiveLocal(intptr_t socket, char* buf, size_t len) {
+#ifdef _WIN32
+	int received = recv((nativeSocket)socket, buf, len > INT_MAX ? INT_MAX : (int)len, 0);
+#else
+	ssize_t received = recv((nativeSocket)socket, buf, len, 0);
+#endif
+	if (received < 0)
+		return ERROR_AGAIN(lastSocketError) ? -1 : 0;
+	return (ptrdiff_t)received;
+}
+
+/*!	 \fn sendLocal
+	 \return bytes sent, 0 if the socket can take nothing now, -1 on an error (the peer went away)
+	 \param intptr_t socket, const char* buf, size_t len */
+ptrdiff_t sendLocal(intptr_t socket, const char* buf, size_t len) {
+#ifdef _WIN32
+	int sent = send((nativeSocket)socket, buf, len > INT_MAX ? INT_MAX : (int)len, 0);
+#elif defined(MSG_NOSIGNAL)
+	ssize_t sent = send((nativeSocket)socket, buf, len, MSG_NOSIGNAL);
+#else
+	ssize_t sent = send((nativeSocket)socket, buf, len, 0);
+#endif
+	if (sent < 0)
+		return ERROR_AGAIN(lastSocketError) ? 0 : -1;
+	return (ptrdiff_t)sent;
+}
+
+/*!	 \fn closeLocal
+	 \return none
+	 \param intptr_t socket */
+void closeLocal(intptr_t socket) {
+	closeNative((nativeSocket)socket);
+}
+
+/*!	 \fn removeLocal
+	 \return none
+	 \param const char* path - socket file */
+void removeLocal(const char* path) {
+#ifdef _WIN32
+	DeleteFileA(path);
+#else
+	unlink(path);
+#endif
+}
+
+/*!	 \fn pollLocal
+	 \return sockets with an event, 0 on a timeout or an interrupted wait, -1 on an error
+	 \param struct pollEntry* entries, size_t count, int timeout - milliseconds, -1: no limit
+
+	 Wait until one of the sockets can be read or written as wanted */
+int pollLocal(struct pollEntry* entries, size_t count, int timeout) {
+#ifdef _WIN32
+	WSAPOLLFD* fds = (WSAPOLLFD*)malloc(count * sizeof(WSAPOLLFD));
+#else
+	struct pollfd* fds = (struct pollfd*)malloc(count * sizeof(struct pollfd));
+#endif
+	if (fds == NULL)
+		return -1;
+	for (size_t i = 0; i < count; i++) {
+		fds[i].fd = (nativeSocket)entries[i].socket;
+		fds[i].events = (short)((entries[i].wantRead ? POLLIN : 0) | (entries[i].wantWrite ? POLLOUT : 0));
+		fds[i].revents = 0;
+	}
+#ifdef _WIN32
+	int events = WSAPoll(fds, (ULONG)count, timeout);
+#else
+	int events = poll(fds, (nfds_t)count, timeout);
+	if (events < 0 && errno == EINTR)
+		events = 0;
+#endif
+	for (size_t i = 0; i < count; i++) {
+		entries[i].readable = (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0 && entries[i].wantRead;
+		entries[i].writable = (fds[i].revents & (POLLOUT | POLLHUP | POLLERR)) != 0 && entries[i].wantWrite;
+	}
+	free(fds);
+	return events;
+}
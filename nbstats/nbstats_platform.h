@@ -0,0 +1,89 @@
+/*!	\file		nbstats_platform.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Thin wrappers over the operating system services nbstats needs (file mapping, threads, locks and conditions, processor features,
+	clocks and memory use for profiling, waiting for a growing file, local sockets of the daemon).
+	Windows uses the Win32 API, everything else uses POSIX.
+*/
+#ifndef NBSTATS_PLATFORM_H
+#define NBSTATS_PLATFORM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// read-only view of a whole file
+struct mappedFile {
+	const char* data;
+	size_t size;
+	void* file;			// HANDLE (Windows) or file descriptor (POSIX)
+	void* mapping;		// file mapping HANDLE (Windows only)
+};
+
+bool mapFile(const char* fileName, struct mappedFile* view);
+void unmapFile(struct mappedFile* view);
+bool fileSize(const char* fileName, unsigned long long* size);
+
+typedef void (*threadProc)(void* arg);
+
+// worker thread, must stay in place until joinThread
+struct thread {
+	void* handle;
+	threadProc proc;
+	void* arg;
+};
+
+bool startThread(struct thread* t, threadProc proc, void* arg);
+void joinThread(struct thread* t);
+unsigned processorCount(void);
+
+// lock for short critical sections
+struct mutex {
+	void* handle;		// CRITICAL_SECTION (Windows) or pthread_mutex_t (POSIX)
+};
+
+bool initMutex(struct mutex* m);
+void freeMutex(struct mutex* m);
+void lockMutex(struct mutex* m);
+void unlockMutex(struct mutex* m);
+
+// wait of one thread for another, always with the same mutex
+struct condition {
+	void* handle;		// CONDITION_VARIABLE (Windows) or pthread_cond_t (POSIX)
+};
+
+bool initCondition(struct condition* c);
+void freeCondition(struct condition* c);
+void waitCondition(struct condition* c, struct mutex* m);
+void wakeCondition(struct condition* c);
+
+bool processorHasAvx2(void);
+void useUtf8Console(void);
+
+double wallSeconds(void);
+double cpuSeconds(void);
+size_t peakMemory(void);
+void sleepSeconds(double seconds);
+
+// socket of pollLocal, the results are set by pollLocal
+struct pollEntry {
+	intptr_t socket;
+	bool wantRead;
+	bool wantWrite;
+	bool readable;		// also when the peer closed or on an error, receiveLocal tells which
+	bool writable;
+};
+
+// non-blocking local (Unix domain) stream sockets
+bool listenLocal(const char* path, intptr_t* listener);
+bool acceptLocal(intptr_t listener, intptr_t* client);
+bool pairLocal(intptr_t* readEnd, intptr_t* writeEnd);
+ptrdiff_t receiveLocal(intptr_t socket, char* buf, size_t len);
+ptrdiff_t sendLocal(intptr_t socket, const char* buf, size_t len);
+void closeLocal(intptr_t socket);
+void removeLocal(const char* path);
+int pollLocal(struct pollEntry* entries, size_t count, int timeout);
+
+#endif
@@ -0,0 +1,151 @@
+/*!	\file		nbstats_pool.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Work-stealing thread pool. Every worker starts with an equal range of the task numbers and takes
+	tasks from the front of its own range. A worker whose range is empty steals the back half of the
+	range of another worker, so uneven tasks (a few large files among many small ones) still keep
+	every worker busy. Each range has its own lock, the owner and a thief only meet on one range.
+*/
+#include "nbstats_pool.h"
+
+#include <stdlib.h>
+
+#include "nbstats_platform.h"
+
+struct workRange {
+	struct mutex lock;
+	size_t begin;			// next task of the owner
+	size_t end;				// thieves take from here backwards
+};
+
+struct worker {
+	struct pool* pool;
+	unsigned index;
+	struct thread thread;
+};
+
+struct pool {
+	unsigned threads;
+	struct workRange* ranges;
+	taskProc proc;
+	void* arg;
+};
+
+/*!	 \fn takeOwn
+	 \return false if the range is empty
+	 \param struct workRange* r, size_t* task
+
+	 Next task from the front of the own range */
+static bool takeOwn(struct workRange* r, size_t* task) {
+	bool found = false;
+
+	lockMutex(&r->lock);
+	if (r->begin < r->end) {
+		*task = r->begin++;
+		found = true;
+	}
+	unlockMutex(&r->lock);
+	return found;
+}
+
+/*!	 \fn steal
+	 \return false if every range is empty
+	 \param struct pool* p, unsigned self, size_t* task
+
+	 Take the back half of the first non-empty range after self, run its first task now and keep the rest */
+static bool steal(struct pool* p, unsigned self, size_t* task) {
+	for (unsigned n = 1; n < p->threads; n++) {
+		struct workRange* victim = &p->ranges[(self + n) % p->threads];
+		size_t begin = 0;
+		size_t end = 0;
+
+		lockMutex(&victim->lock);
+		if (victim->begin < victim->end) {
+			end = victim->end;
+			begin = end - (end - victim->begin + 1) / 2;
+			victim->end = begin;
+		}
+		unlockMutex(&victim->lock);
+
+		if (begin < end) {
+			struct workRange* own = &p->ranges[self];
+			lockMutex(&own->lock);
+			own->begin = begin + 1;
+			own->end = end;
+			unlockMutex(&own->lock);
+			*task = begin;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*!	 \fn workerMain
+	 \return none
+	 \param void* arg - struct worker
+
+	 Run tasks until there is nothing left to take or steal */
+static void workerMain(void* arg) {
+	struct worker* w = (struct worker*)arg;
+	struct pool* p = w->pool;
+	size_t task;
+
+	while (takeOwn(&p->ranges[w->index], &task) || steal(p, w->index, &task))
+		p->proc(p->arg, w->index, task);
+}
+
+/*!	 \fn runPool
+	 \return false if out of memory (no task has run then)
+	 \param unsigned threads - workers, size_t tasks, taskProc proc, void* arg
+
+	 Run proc for every task number on threads workers and wait for all of them.
+	 Worker 0 is the calling thread, a worker that can not be started leaves its tasks to be stolen. */
+bool runPool(unsigned threads, size_t tasks, taskProc proc, void* arg) {
+	struct pool p;
+	bool ok = true;
+
+	if (threads == 0)
+		threads = 1;
+	if (threads > tasks)
+		threads = tasks > 0 ? (unsigned)tasks : 1;
+
+	p.threads = threads;
+	p.proc = proc;
+	p.arg = arg;
+	p.ranges = (struct workRange*)calloc(threads, sizeof(struct workRange));
+	struct worker* workers = (struct worker*)calloc(threads, sizeof(struct worker));
+	if (p.ranges == NULL || workers == NULL) {
+		free(p.ranges);
+		free(workers);
+		return false;
+	}
+
+	unsigned initialized = 0;
+	for (; initialized < threads; initialized++) {
+		struct workRange* r = &p.ranges[initialized];
+		if (!initMutex(&r->lock)) {
+			ok = false;
+			break;
+		}
+		r->begin = tasks / threads * initialized;
+		r->end = initialized + 1 == threads ? tasks : tasks / threads * (initialized + 1);
+		workers[initialized].pool = &p;
+		workers[initialized].index = initialized;
+	}
+
+	if (ok) {
+		for (unsigned i = 1; i < threads; i++)
+			startThread(&workers[i].thread, workerMain, &workers[i]);
+		workerMain(&workers[0]);
+		for (unsigned i = 1; i < threads; i++)
+			joinThread(&workers[i].thread);
+	}
+
+	for (unsigned i = 0; i < initialized; i++)
+		freeMutex(&p.ranges[i].lock);
+	free(p.ranges);
+	free(workers);
+	return ok;
+}
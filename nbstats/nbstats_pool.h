@@ -0,0 +1,19 @@
+/*!	\file		nbstats_pool.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Work-stealing thread pool for a fixed number of independent tasks (one file each in batch mode).
+*/
+#ifndef NBSTATS_POOL_H
+#define NBSTATS_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// runs task number task (0 .. tasks-1) on worker number worker (0 .. threads-1)
+typedef void (*taskProc)(void* arg, unsigned worker, size_t task);
+
+bool runPool(unsigned threads, size_t tasks, taskProc proc, void* arg);
+
+#endif
@@ -0,0 +1,260 @@
+/*!	\file		nbstats_quantile.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	KLL sketch: numbers go into level 0. A level that reaches its capacity is sorted and every second
+	item of it moves up one level, where it stands for twice as many numbers. Capacities shrink by 2/3
+	per level downwards from k at the top, so the sketch holds about 3k items whatever the count,
+	and the rank of a value is off by less than about 2 / k of the count (with high probability).
+	Which half moves up is random (a fixed seed, so a run is repeatable).
+*/
+#include "nbstats_quantile.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_sort.h"
+
+#define KLL_SEED		0x9E3779B97F4A7C15ULL
+
+/*!	 \fn kllParameter
+	 \return k for the rank error
+	 \param double rankError - fraction of the count, e.g. 0.01 */
+size_t kllParameter(double rankError) {
+	double k = ceil(2 / rankError);
+	if (!(k >= KLL_MIN_K)) // also nan
+		return KLL_MIN_K;
+	if (k > KLL_MAX_K)
+		return KLL_MAX_K;
+	return (size_t)k;
+}
+
+/*!	 \fn levelCapacity
+	 \return items level h holds before it is compacted
+	 \param const struct kll* s, size_t h */
+static size_t levelCapacity(const struct kll* s, size_t h) {
+	double capacity = (double)s->k;
+	for (size_t depth = s->numLevels - 1 - h; depth > 0 && capacity > 2; depth--)
+		capacity *= 2.0 / 3.0;
+	capacity = ceil(capacity);
+	return capacity > 2 ? (size_t)capacity : 2;
+}
+
+/*!	 \fn addLevel
+	 \return false if out of memory
+	 \param struct kll* s
+
+	 A new top level, the capacities of the levels below shrink */
+static bool addLevel(struct kll* s) {
+	struct kllLevel* levelsMore = (struct kllLevel*)realloc(s->levels, sizeof(struct kllLevel) * (s->numLevels + 1));
+	if (levelsMore == NULL)
+		return false;
+	s->levels = levelsMore;
+	memset(&s->levels[s->numLevels], 0, sizeof(struct kllLevel));
+	s->numLevels++;
+
+	s->maxSize = 0;
+	for (size_t h = 0; h < s->numLevels; h++)
+		s->maxSize += levelCapacity(s, h);
+	return true;
+}
+
+/*!	 \fn reserve
+	 \return false if out of memory
+	 \param struct kllLevel* level, size_t size - items it has to hold */
+static bool reserve(struct kllLevel* level, size_t size) {
+	if (size <= level->capacity)
+		return true;
+
+	size_t capacity = level->capacity == 0 ? 16 : level->capacity;
+	while (capacity < size)
+		capacity *= 2;
+	long double* itemsDouble = (long double*)realloc(level->items, sizeof(long double) * capacity);
+	if (itemsDouble == NULL)
+		return false;
+	level->items = itemsDouble;
+	level->capacity = capacity;
+	return true;
+}
+
+/*!	 \fn initKll
+	 \return false if out of memory
+	 \param struct kll* s, size_t k - see kllParameter */
+bool initKll(struct kll* s, size_t k) {
+	memset(s, 0, sizeof(*s));
+	s->k = k < KLL_MIN_K ? KLL_MIN_K : k;
+	s->random = KLL_SEED;
+	if (!addLevel(s) || !reserve(&s->levels[0], levelCapacity(s, 0))) {
+		freeKll(s);
+		return false;
+	}
+	return true;
+}
+
+/*!	 \fn freeKll
+	 \return none
+	 \param struct kll* s */
+void freeKll(struct kll* s) {
+	for (size_t h = 0; h < s->numLevels; h++)
+		free(s->levels[h].items);
+	free(s->levels);
+	s->levels = NULL;
+	s->numLevels = 0;
+	s->size = 0;
+}
+
+/*!	 \fn randomBit
+	 \return 0 or 1
+	 \param struct kll* s
+
+	 xorshift64 */
+static inline size_t randomBit(struct kll* s) {
+	s->random ^= s->random << 13;
+	s->random ^= s->random >> 7;
+	s->random ^= s->random << 17;
+	return (size_t)(s->random >> 63);
+}
+
+/*!	 \fn compress
+	 \return false if out of memory
+	 \param struct kll* s - size has reached maxSize
+
+	 Compact the lowest full level into the one above it, until the sketch is below maxSize again.
+	 An odd item stays behind, the count of the sketch does not change. */
+static bool compress(struct kll* s) {
+	for (size_t h = 0; h < s->numLevels && s->size >= s->maxSize; h++) {
+		struct kllLevel* level = &s->levels[h];
+		if (level->size < levelCapacity(s, h))
+			continue;
+		if (h + 1 == s->numLevels && !addLevel(s))
+			return false;
+		level = &s->levels[h];
+		struct kllLevel* up = &s->levels[h + 1];
+
+		size_t pairs = level->size / 2;
+		if (!reserve(up, up->size + pairs))
+			return false;
+		qsort(level->items, level->size, sizeof(long double), compareNumbers);
+		for (size_t i = randomBit(s); i < 2 * pairs; i += 2)
+			up->items[up->size++] = level->items[i];
+		if (level->size % 2 != 0)
+			level->items[0] = level->items[level->size - 1];
+		level->size %= 2;
+		s->size -= pairs;
+	}
+	return true;
+}
+
+/*!	 \fn addKll
+	 \return false if out of memory (the numbers not taken are lost to the sketch)
+	 \param struct kll* s, const long double a[], size_t size */
+bool addKll(struct kll* s, const long double a[], size_t size) {
+	for (size_t at = 0; at < size; ) {
+		struct kllLevel* bottom = &s->levels[0];
+		size_t room = s->size < s->maxSize ? s->maxSize - s->size : 0;
+		size_t n = size - at < room ? size - at : room;
+
+		if (!reserve(bottom, bottom->size + n))
+			return false;
+		memcpy(bottom->items + bottom->size, a + at, sizeof(long double) * n);
+		bottom->size += n;
+		s->size += n;
+		s->count += n;
+		at += n;
+		if (s->size >= s->maxSize && !compress(s))
+			return false;
+	}
+	return true;
+}
+
+/*!	 \fn addKllLevel
+	 \return false if out of memory
+	 \param struct kll* s, size_t level, const long double items[], size_t size - each stands for 2^level numbers
+
+	 Put items of a stored or merged sketch on their level */
+bool addKllLevel(struct kll* s, size_t level, const long double items[], size_t size) {
+	while (s->numLevels <= level) {
+		if (!addLevel(s))
+			return false;
+	}
+	if (size == 0)
+		return true;
+	struct kllLevel* l = &s->levels[level];
+	if (!reserve(l, l->size + size))
+		return false;
+	memcpy(l->items + l->size, items, sizeof(long double) * size);
+	l->size += size;
+	s->size += size;
+	s->count += (uint64_t)size << level;
+	return true;
+}
+
+/*!	 \fn mergeKll
+	 \return false if out of memory
+	 \param struct kll* dst, const struct kll* src
+
+	 dst summarizes the numbers of both, with the rank error of the larger of the two */
+bool mergeKll(struct kll* dst, const struct kll* src) {
+	for (size_t h = 0; h < src->numLevels; h++) {
+		if (!addKllLevel(dst, h, src->levels[h].items, src->levels[h].size))
+			return false;
+	}
+	while (dst->size >= dst->maxSize) {
+		size_t before = dst->size;
+		if (!compress(dst))
+			return false;
+		if (dst->size == before) // only odd items left below the capacities
+			break;
+	}
+	return true;
+}
+
+// an item and the numbers it stands for
+struct weighted {
+	long double value;
+	uint64_t weight;
+};
+
+static int compareWeighted(const void* a, const void* b) {
+	long double x = ((const struct weighted*)a)->value;
+	long double y = ((const struct weighted*)b)->value;
+	return x < y ? -1 : x > y;
+}
+
+/*!	 \fn kllQuantiles
+	 \return false if out of memory or the sketch is empty
+	 \param const struct kll* s, const double q[] - ascending fractions (0, 1], size_t n, long double out[]
+
+	 The smallest item whose weighted rank reaches q * count, for every q (nearest rank) */
+bool kllQuantiles(const struct kll* s, const double q[], size_t n, long double out[]) {
+	if (s->count == 0)
+		return false;
+
+	struct weighted* all = (struct weighted*)malloc(sizeof(struct weighted) * s->size);
+	if (all == NULL)
+		return false;
+	size_t size = 0;
+	for (size_t h = 0; h < s->numLevels; h++) {
+		for (size_t i = 0; i < s->levels[h].size; i++) {
+			all[size].value = s->levels[h].items[i];
+			all[size].weight = (uint64_t)1 << h;
+			size++;
+		}
+	}
+	qsort(all, size, sizeof(struct weighted), compareWeighted);
+
+	uint64_t rank = 0;
+	size_t at = 0;
+	for (size_t j = 0; j < n; j++) {
+		double target = ceil(q[j] * (double)s->count);
+		if (target < 1)
+			target = 1;
+		while (at + 1 < size && (double)(rank + all[at].weight) < target)
+			rank += all[at++].weight;
+		out[j] = all[at].value;
+	}
+	free(all);
+	return true;
+}
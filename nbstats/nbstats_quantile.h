@@ -0,0 +1,44 @@
+/*!	\file		nbstats_quantile.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Quantiles in one pass and bounded memory: a KLL sketch (Karnin, Lang, Liberty).
+	Sketches of parts of a data set merge into a sketch of the whole.
+*/
+#ifndef NBSTATS_QUANTILE_H
+#define NBSTATS_QUANTILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define KLL_MIN_K		8
+#define KLL_MAX_K		(1 << 20)
+
+// compactor of one level, each of its items stands for 2^level numbers
+struct kllLevel {
+	long double* items;
+	size_t size;
+	size_t capacity;		// allocated
+};
+
+struct kll {
+	size_t k;				// capacity of the top level, the rank error stays below about 2 / k
+	size_t numLevels;
+	struct kllLevel* levels;
+	size_t size;			// items held on all levels
+	size_t maxSize;			// compaction starts at this many items
+	uint64_t count;			// numbers summarized
+	uint64_t random;		// xorshift state choosing which half a compaction keeps
+};
+
+size_t kllParameter(double rankError);
+bool initKll(struct kll* s, size_t k);
+void freeKll(struct kll* s);
+bool addKll(struct kll* s, const long double a[], size_t size);
+bool mergeKll(struct kll* dst, const struct kll* src);
+bool addKllLevel(struct kll* s, size_t level, const long double items[], size_t size);
+bool kllQuantiles(const struct kll* s, const double q[], size_t n, long double out[]);
+
+#endif
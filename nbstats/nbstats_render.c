@@ -0,0 +1,786 @@
+/*!	\file		nbstats_render.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Report renderer. Every report is formatted into a buffer that is allocated once for the report (and grows only
+	for reports larger than expected), then written with a single fwrite. The box drawing of the text report is
+	appended as whole runs of glyphs, not character by character, in UTF-8 on every system (nbstats switches the
+	Windows console to UTF-8 with useUtf8Console, the renderer itself calls no console API).
+	JSON is one object per report, CSV one row per report under a header that never changes, so a report that
+	lacks a statistic (no bootstrap, no digit tests) leaves its fields empty.
+*/
+#include "nbstats_render.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUMBER_DIGITS	17		// JSON and CSV numbers, always enough to read a double back exactly
+#define HEAVY_LINE		62		// width of the double lines of the text report
+
+// box drawing of the text report
+struct glyphs {
+	const char* heavy;			// double horizontal line
+	const char* line;			// horizontal line
+	const char* top;			// top left corner of the scale
+	const char* topTick;
+	const char* bottom;			// bottom left corner of the scale
+	const char* bottomTick;
+	const char* axis;			// vertical line before the bars
+	const char* bar;			// one block of a bar
+	const char* times;			// multiplication sign of the mode count
+	const char* copyright;
+};
+
+static const struct glyphs glyphs = { "\xe2\x95\x90", "\xe2\x94\x80", "\xe2\x94\x8c", "\xe2\x94\xac", "\xe2\x94\x94",
+	"\xe2\x94\xb4", "\xe2\x94\x82", "\xe2\x96\xa0", "\xc3\x97", "\xc2\xa9" };
+
+// JSON names of the digit tests, by enum nb_test
+static const char* const testNames[NB_NUM_DIGIT_TESTS] = { "second", "first_two", "last_two", "summation" };
+
+// columns of the CSV report
+static const char* const csvColumns[] = {
+	"file", "status", "elements", "rejected", "min", "max", "mean", "median", "median_approximate", "variance",
+	"std_dev", "modes", "mode_count", "mode_error", "p1", "p5", "p25", "p50", "p75", "p95", "p99", "percentiles_exact",
+	"d1", "d2", "d3", "d4", "d5", "d6", "d7", "d8", "d9", "nb_variance", "nb_std_dev", "relationship",
+	"bootstrap_resamples", "nb_std_dev_low", "nb_std_dev_high", "nb_p_value", "chi_square", "chi_square_low",
+	"chi_square_high", "chi_square_p_value", "mad", "mad_low", "mad_high", "mad_p_value",
+	"second_chi_square", "second_mad", "second_nb_std_dev", "first_two_chi_square", "first_two_mad",
+	"first_two_nb_std_dev", "last_two_chi_square", "last_two_mad", "last_two_nb_std_dev", "summation_chi_square",
+	"summation_mad", "summation_nb_std_dev", "duplicated_values", "duplicate_numbers"
+};
+#define CSV_COLUMNS		(sizeof(csvColumns) / sizeof(csvColumns[0]))
+
+/*!	 \fn reserve
+	 \return false if out of memory (the buffer is marked failed)
+	 \param struct renderBuffer* b, size_t more - bytes to append, besides the terminating null */
+static bool reserve(struct renderBuffer* b, size_t more) {
+	if (b->failed)
+		return false;
+	if (b->capacity - b->size > more)
+		return true;
+
+	size_t capacity = b->capacity;
+	while (capacity - b->size <= more)
+		capacity *= 2;
+	char* data = (char*)realloc(b->data, capacity);
+	if (data == NULL) {
+		b->failed = true;
+		return false;
+	}
+	b->data = data;
+	b->capacity = capacity;
+	return true;
+}
+
+/*!	 \fn initRender
+	 \return false if out of memory
+	 \param struct renderBuffer* b, size_t capacity - bytes the usual report takes */
+bool initRender(struct renderBuffer* b, size_t capacity) {
+	b->data = (char*)malloc(capacity);
+	b->size = 0;
+	b->capacity = capacity;
+	b->failed = b->data == NULL;
+	if (b->failed)
+		return false;
+	b->data[0] = '\0';
+	return true;
+}
+
+/*!	 \fn freeRender
+	 \return none
+	 \param struct renderBuffer* b */
+void freeRender(struct renderBuffer* b) {
+	free(b->data);
+	b->data = NULL;
+	b->size = 0;
+	b->capacity = 0;
+}
+
+/*!	 \fn appendFormat
+	 \return none, out of memory marks the buffer failed
+	 \param struct renderBuffer* b, const char* format, ... - as printf */
+void appendFormat(struct renderBuffer* b, const char* format, ...) {
+	va_list args;
+
+	if (b->failed)
+		return;
+	va_start(args, format);
+	int length = vsnprintf(b->data + b->size, b->capacity - b->size, format, args);
+	va_end(args);
+	if (length < 0) {
+		b->failed = true;
+		return;
+	}
+	if ((size_t)length >= b->capacity - b->size) { // did not fit, once more after growing
+		if (!reserve(b, (size_t)length))
+			return;
+		va_start(args, format);
+		vsnprintf(b->data + b->size, b->capacity - b->size, format, args);
+		va_end(args);
+	}
+	b->size += (size_t)length;
+}
+
+/*!	 \fn appendRepeat
+	 \return none
+	 \param struct renderBuffer* b, const char* glyph - one character in any encoding, size_t times */
+void appendRepeat(struct renderBuffer* b, const char* glyph, size_t times) {
+	size_t length = strlen(glyph);
+
+	if (!reserve(b, length * times))
+		return;
+	for (size_t i = 0; i < times; i++, b->size += length)
+		memcpy(b->data + b->size, glyph, length);
+	b->data[b->size] = '\0';
+}
+
+/*!	 \fn appendBuffer
+	 \return none
+	 \param struct renderBuffer* b, const struct renderBuffer* src - a failed one fails b too */
+void appendBuffer(struct renderBuffer* b, const struct renderBuffer* src) {
+	if (src->failed)
+		b->failed = true;
+	if (!reserve(b, src->size))
+		return;
+	memcpy(b->data + b->size, src->data, src->size);
+	b->size += src->size;
+	b->data[b->size] = '\0';
+}
+
+/*!	 \fn appendJsonString
+	 \return none
+	 \param struct renderBuffer* b, const char* s - NULL is null
+
+	 s in quotes, with quotes, backslashes and control characters escaped */
+void appendJsonString(struct renderBuffer* b, const char* s) {
+	if (s == NULL) {
+		appendFormat(b, "null");
+		return;
+	}
+	appendFormat(b, "\"");
+	for (; *s != '\0'; s++) {
+		unsigned char c = (unsigned char)*s;
+		if (c == '"' || c == '\\')
+			appendFormat(b, "\\%c", c);
+		else if (c < 0x20)
+			appendFormat(b, "\\u%04x", c);
+		else
+			appendFormat(b, "%c", c);
+	}
+	appendFormat(b, "\"");
+}
+
+/*!	 \fn appendCsvField
+	 \return none
+	 \param struct renderBuffer* b, const char* s - NULL is an empty field
+
+	 s as it is, or in quotes with the quotes doubled if it has a separator, a quote or a line break */
+void appendCsvField(struct renderBuffer* b, const char* s) {
+	if (s == NULL)
+		return;
+	if (strpbrk(s, ",\"\r\n") == NULL) {
+		appendFormat(b, "%s", s);
+		return;
+	}
+	appendFormat(b, "\"");
+	for (; *s != '\0'; s++) {
+		if (*s == '"')
+			appendFormat(b, "\"\"");
+		else
+			appendFormat(b, "%c", *s);
+	}
+	appendFormat(b, "\"");
+}
+
+/*!	 \fn writeRender
+	 \return false if the buffer failed or could not be written
+	 \param struct renderBuffer* b - emptied for the next report, FILE* out
+
+	 Everything formatted so far in one write */
+bool writeRender(struct renderBuffer* b, FILE* out) {
+	bool ok = !b->failed && fwrite(b->data, 1, b->size, out) == b->size && fflush(out) == 0;
+
+	b->size = 0;
+	if (b->data != NULL)
+		b->data[0] = '\0';
+	return ok;
+}
+
+/*!	 \fn clearRender
+	 \return none
+	 \param struct renderBuffer* b
+
+	 Empty the buffer for the next text, one that could not grow tries again */
+void clearRender(struct renderBuffer* b) {
+	b->size = 0;
+	if (b->data != NULL) {
+		b->data[0] = '\0';
+		b->failed = false;
+	}
+}
+
+/*!	 \fn relationship
+	 \return strength of the Benford relationship in one word
+	 \param long double NBDeviation
+
+	 The same bands as the NB relationship analysis of the text report */
+const char* relationship(long double NBDeviation) {
+	if (NBDeviation < 0.1)
+		return "very strong";
+	if (NBDeviation < 0.2)
+		return "strong";
+	if (NBDeviation < 0.35)
+		return "moderate";
+	if (NBDeviation < 0.5)
+		return "weak";
+	return "none";
+}
+
+/*!	 \fn renderBanner
+	 \return none
+	 \param struct renderBuffer* b, bool console - the numbers are typed in */
+void renderBanner(struct renderBuffer* b, bool console) {
+	appendFormat(b, "Newcomb-Benford Stats (v1.0.0), %s2019 Jimin Park\n", glyphs.copyright);
+	appendFormat(b, "================================================\n");
+#ifdef _WIN32
+	if (console)
+		appendFormat(b, "Enter white-space separated real numbers. Terminate input with ^Z\n");
+#else
+	if (console)
+		appendFormat(b, "Enter white-space separated real numbers. Terminate input with ^D\n");
+#endif
+}
+
+/*!	 \fn shows
+	 \return true if the statistic was worked out for the report
+	 \param const struct nb_result* r, enum nb_stat statistic */
+static bool shows(const struct nb_result* r, enum nb_stat statistic) {
+	return (r->statistics & 1u << statistic) != 0;
+}
+
+/*!	 \fn medianOf
+	 \return false if the report has no median
+	 \param const struct nb_result* r, const struct reportInfo* info, long double* median, bool* approximate */
+static bool medianOf(const struct nb_result* r, const struct reportInfo* info, long double* median, bool* approximate) {
+	*approximate = shows(r, NB_STAT_MEDIAN) && r->hasQuantiles && !r->quantilesExact;
+	if (!shows(r, NB_STAT_MEDIAN))
+		return false;
+	else if (*approximate)
+		*median = r->quantiles[3];
+	else if (info->aggregate || !r->hasMedian)
+		return false;
+	else
+		*median = r->statisticalMedian;
+	return true;
+}
+
+/*!	 \fn hasMode
+	 \return true if some values occur more often than the others
+	 \param const struct nb_result* r */
+static bool hasMode(const struct nb_result* r) {
+	return r->numModes != 0 && r->numModes * r->modeCount != r->count;
+}
+
+/*!	 \fn renderDigitTest
+	 \return none
+	 \param struct renderBuffer* b, const char* name, const struct nb_digit_test* t - nothing unless computed,
+			bool counts - the bins count numbers (chi-square), not the sums of the summation test
+
+	 Statistics of one forensic digit test, then the expected and actual frequency of every digit (pair) */
+static void renderDigitTest(struct renderBuffer* b, const char* name, const struct nb_digit_test* t, bool counts) {
+	if (!t->computed)
+		return;
+
+	appendFormat(b, "\n%s (%zu numbers)\n", name, t->count);
+	if (counts)
+		appendFormat(b, "Chi-square = %.4f (%zu degrees of freedom)\n", t->chiSquare, t->bins - 1);
+	appendFormat(b, "MAD = %.6f\n", t->MAD);
+	appendFormat(b, "Std. Dev. = %.5Lf%%\n", t->NBDeviation * 100);
+	for (size_t i = 0; i < t->bins; i++) {
+		appendFormat(b, "  [%02d] %6.2f%% %6.2f%%", t->first + (int)i, t->expected[i] * 100, t->actual[i] * 100);
+		if (i % 5 == 4 || i + 1 == t->bins)
+			appendFormat(b, "\n");
+	}
+}
+
+/*!	 \fn renderText
+	 \return none
+	 \param struct renderBuffer* b, const struct nb_result* r, const struct reportInfo* info
+
+	 All the statistics on a list of numbers and table/graph */
+static void renderText(struct renderBuffer* b, const struct nb_result* r, const struct reportInfo* info) {
+	bool exceed50 = false;		// exceed scale 50%
+	bool placeChk = false;		// table chart places check - if frequency is 100% , the value is true
+	long double median;
+	bool approximate;
+
+	for (int i = 0; i < 9; i++) {
+		if (r->actual[i] > 99)
+			placeChk = true;
+		if (r->actual[i] >= 50)
+			exceed50 = true;
+	}
+	size_t xPrint = exceed50 && placeChk ? HEAVY_LINE + 1 : HEAVY_LINE;
+	size_t dashes = exceed50 && placeChk ? 21 : 20;
+
+	appendFormat(b, "\nStandard Analysis\n");
+	appendRepeat(b, glyphs.heavy, xPrint);
+	appendFormat(b, "\n");
+
+	appendFormat(b, "# elements = %zu\n", r->count);
+	if (shows(r, NB_STAT_RANGE))
+		appendFormat(b, "Range = [%.6Lg .. %.6Lg]\n", r->rangeMin, r->rangeMax);
+	if (shows(r, NB_STAT_MEAN))
+		appendFormat(b, "Arithmetic mean = %.6Lg\n", r->arithmeticMean);
+	if (shows(r, NB_STAT_MEDIAN)) {
+		if (!medianOf(r, info, &median, &approximate))
+			appendFormat(b, "Arithmetic median = not available (%s)\n", info->aggregate ? "aggregate" : "--stream");
+		else if (approximate)
+			appendFormat(b, "Arithmetic median = %.6Lg (approximate, rank error %g%%)\n", median, info->quantileError * 100);
+		else
+			appendFormat(b, "Arithmetic median = %.6Lg\n", median);
+	}
+	if (shows(r, NB_STAT_VARIANCE)) {
+		appendFormat(b, "Variance = %.6Lg\n", r->variance);
+		appendFormat(b, "Standard Deviation = %.6Lg\n", r->standardDeviation);
+	}
+	if (r->hasQuantiles) {
+		appendFormat(b, "Percentiles p1 / p5 / p25 / p50 / p75 / p95 / p99%s = ", r->quantilesExact ? "" : " (approximate)");
+		for (int i = 0; i < NB_NUM_QUANTILES; i++)
+			appendFormat(b, i == 0 ? "%.6Lg" : " / %.6Lg", r->quantiles[i]);
+		appendFormat(b, "\n");
+	}
+
+	if (shows(r, NB_STAT_MODE)) {
+		if (info->aggregate) { // the files keep no values or counts to merge
+			appendFormat(b, "Mode = not available (aggregate)\n");
+		}
+		else if (r->modeUnknown) { // the guaranteed count does not beat values the summary dropped
+			appendFormat(b, "Mode = not available (--stream, too many distinct values)\n");
+		}
+		else if (!hasMode(r)) {
+			appendFormat(b, "Mode = no mode \n");
+		}
+		else {
+			if (!r->hasMedian && r->modeError != 0) // counts from the heavy-hitters summary
+				appendFormat(b, "Mode (approximate, frequency -%zu at most) = { ", r->modeError);
+			else
+				appendFormat(b, "Mode = { ");
+			for (size_t i = 0; i < r->numModes; i++)
+				appendFormat(b, i == 0 ? "%.6Lg " : ", %.6Lg ", r->modes[i]);
+			appendFormat(b, "}%s%zu\n\n", glyphs.times, r->modeCount);
+		}
+	}
+
+	if (shows(r, NB_STAT_NB)) {
+		// Raw Frequency
+		for (int i = 0; i < 9; i++)
+			appendFormat(b, " [%d] = %ld\n", i + 1, r->frequency[i]);
+		appendFormat(b, "\n\n");
+
+		appendFormat(b, "Newcomb-Benford's Law Analysis\n");
+		appendRepeat(b, glyphs.heavy, xPrint);
+		appendFormat(b, "\n");
+
+		if (!exceed50) // scale 0-50
+			appendFormat(b, "    exp dig    freq  0      10      20      30      40      50\n");
+		else if (!placeChk)
+			appendFormat(b, "    exp dig    freq  0  10  20  30  40  50  60  70  80  90 100\n");
+		else
+			appendFormat(b, "    exp dig    freq   0  10  20  30  40  50  60  70  80  90 100\n");
+		appendRepeat(b, glyphs.line, dashes);
+		appendFormat(b, " %s", glyphs.top);
+		for (int tick = 0; tick < 10; tick++) {
+			appendRepeat(b, glyphs.line, 3);
+			appendFormat(b, "%s", glyphs.topTick);
+		}
+		appendFormat(b, "\n");
+
+		for (int i = 0; i < 9; i++) {
+			// Expected frequencies, then actual ones in the columns of the scale
+			appendFormat(b, i < 3 ? " %.2f%% [%1d] =" : "  %.2f%% [%1d] =", r->expected[i], i + 1);
+			if (placeChk && r->actual[i] > 99) // 100%
+				appendFormat(b, " %.2f%% %s", r->actual[i], glyphs.axis);
+			else if (placeChk)
+				appendFormat(b, "   %.2f%% %s", r->actual[i], glyphs.axis);
+			else if (r->actual[i] >= 10)
+				appendFormat(b, " %.2f%% %s", r->actual[i], glyphs.axis);
+			else
+				appendFormat(b, "  %.2f%% %s", r->actual[i], glyphs.axis);
+
+			int rectangle = exceed50 ? (int)(r->actual[i] / 2.5) : (int)(r->actual[i] / 1.25);
+			appendRepeat(b, glyphs.bar, rectangle > 0 ? (size_t)rectangle : 0);
+			appendFormat(b, "\n");
+		}
+
+		appendRepeat(b, glyphs.line, dashes);
+		appendFormat(b, " %s", glyphs.bottom);
+		for (int tick = 0; tick < 10; tick++) {
+			appendRepeat(b, glyphs.line, 3);
+			appendFormat(b, "%s", glyphs.bottomTick);
+		}
+		appendFormat(b, "\n");
+
+		appendFormat(b, "Variance = %.5Lf%%\n", r->NBVariance * 100);
+		appendFormat(b, "Std. Dev. = %.5Lf%%\n", r->NBDeviation * 100);
+
+		// NB relationship analysis
+		if (0 <= r->NBDeviation && r->NBDeviation < 0.1)
+			appendFormat(b, "There is a very strong Benford relationship.\n");
+		else if (0.1 <= r->NBDeviation && r->NBDeviation < 0.2)
+			appendFormat(b, "There is a strong Benford relationship.\n");
+		else if (0.2 <= r->NBDeviation && r->NBDeviation < 0.35)
+			appendFormat(b, "There is a moderate Benford relationship.\n");
+		else if (0.35 <= r->NBDeviation && r->NBDeviation < 0.5)
+			appendFormat(b, "There is a weak Benford relationship.\n");
+		else if (0.5 <= r->NBDeviation)
+			appendFormat(b, "There is not a Benford relationship.\n");
+	}
+
+	if (r->hasBootstrap) { // the bands above are the same at any count, the resamples are not
+		const struct nb_bootstrap* s = &r->bootstrap;
+		appendFormat(b, "\nBootstrap (%zu resamples, %g%% confidence)\n", s->resamples, NB_BOOTSTRAP_LEVEL * 100);
+		appendFormat(b, "Std. Dev. = %.5f%% [%.5f%% .. %.5f%%], p = %.4g\n", s->deviation.observed * 100,
+			s->deviation.low * 100, s->deviation.high * 100, s->deviation.pValue);
+		appendFormat(b, "Chi-square = %.4f [%.4f .. %.4f], p = %.4g\n", s->chiSquare.observed, s->chiSquare.low,
+			s->chiSquare.high, s->chiSquare.pValue);
+		appendFormat(b, "MAD = %.6f [%.6f .. %.6f], p = %.4g\n", s->mad.observed, s->mad.low, s->mad.high, s->mad.pValue);
+		if (s->deviation.pValue < 1 - NB_BOOTSTRAP_LEVEL)
+			appendFormat(b, "The deviation from the Newcomb-Benford law is significant (p < %g).\n", 1 - NB_BOOTSTRAP_LEVEL);
+		else
+			appendFormat(b, "The deviation from the Newcomb-Benford law is not significant (p >= %g).\n", 1 - NB_BOOTSTRAP_LEVEL);
+	}
+
+	renderDigitTest(b, "Second digit test", &r->tests[NB_TEST_SECOND], true);
+	renderDigitTest(b, "First two digits test", &r->tests[NB_TEST_FIRST_TWO], true);
+	renderDigitTest(b, "Last two digits test", &r->tests[NB_TEST_LAST_TWO], true);
+	renderDigitTest(b, "Summation test", &r->tests[NB_TEST_SUMMATION], false);
+	if (r->hasDuplication) {
+		appendFormat(b, "\nNumber duplication test\n");
+		appendFormat(b, "Duplicated values = %zu, repeated numbers = %zu (%.4f%%)\n", r->duplicatedValues,
+			r->duplicateNumbers, r->count != 0 ? 100.0 * r->duplicateNumbers / r->count : 0.0);
+	}
+
+	appendRepeat(b, glyphs.heavy, xPrint);
+	appendFormat(b, "\n");
+}
+
+/*!	 \fn appendNumber
+	 \return none
+	 \param struct renderBuffer* b, long double x, bool json - JSON has no infinity or NaN, they are null
+
+	 The fewest digits (DBL_DIG ~ NUMBER_DIGITS) that read back as the same double, 1272.515 rather than
+	 1272.5149999999999 */
+static void appendNumber(struct renderBuffer* b, long double x, bool json) {
+	char number[48];
+
+	if (!isfinite(x)) {
+		appendFormat(b, json ? "null" : "%Lg", x);
+		return;
+	}
+	for (int digits = DBL_DIG; digits <= NUMBER_DIGITS; digits++) {
+		snprintf(number, sizeof(number), "%.*Lg", digits, x);
+		if ((double)strtold(number, NULL) == (double)x)
+			break;
+	}
+	appendFormat(b, "%s", number);
+}
+
+/*!	 \fn appendJsonNumber
+	 \return none
+	 \param struct renderBuffer* b, long double x, bool available - otherwise null */
+static void appendJsonNumber(struct renderBuffer* b, long double x, bool available) {
+	if (available)
+		appendNumber(b, x, true);
+	else
+		appendFormat(b, "null");
+}
+
+/*!	 \fn appendJsonArray
+	 \return none
+	 \param struct renderBuffer* b, const double a[], size_t n */
+static void appendJsonArray(struct renderBuffer* b, const double a[], size_t n) {
+	appendFormat(b, "[");
+	for (size_t i = 0; i < n; i++) {
+		if (i > 0)
+			appendFormat(b, ", ");
+		appendNumber(b, a[i], true);
+	}
+	appendFormat(b, "]");
+}
+
+/*!	 \fn appendJsonStat
+	 \return none
+	 \param struct renderBuffer* b, const char* name, const struct nb_bootstrap_stat* s, bool last */
+static void appendJsonStat(struct renderBuffer* b, const char* name, const struct nb_bootstrap_stat* s, bool last) {
+	appendFormat(b, "\"%s\": {\"observed\": ", name);
+	appendNumber(b, s->observed, true);
+	appendFormat(b, ", \"low\": ");
+	appendNumber(b, s->low, true);
+	appendFormat(b, ", \"high\": ");
+	appendNumber(b, s->high, true);
+	appendFormat(b, ", \"p_value\": ");
+	appendNumber(b, s->pValue, true);
+	appendFormat(b, last ? "}" : "}, ");
+}
+
+/*!	 \fn renderJson
+	 \return none
+	 \param struct renderBuffer* b, const struct nb_result* r, const struct reportInfo* info
+
+	 The report as one JSON object, statistics that are not available or not wanted are null */
+static void renderJson(struct renderBuffer* b, const struct nb_result* r, const struct reportInfo* info) {
+	long double median;
+	bool approximate;
+
+	appendFormat(b, "{\"file\": ");
+	appendJsonString(b, info->name);
+	appendFormat(b, ", \"elements\": %zu, \"rejected\": %zu, \"min\": ", r->count, info->rejected);
+	appendJsonNumber(b, r->rangeMin, shows(r, NB_STAT_RANGE));
+	appendFormat(b, ", \"max\": ");
+	appendJsonNumber(b, r->rangeMax, shows(r, NB_STAT_RANGE));
+	appendFormat(b, ", \"mean\": ");
+	appendJsonNumber(b, r->arithmeticMean, shows(r, NB_STAT_MEAN));
+	appendFormat(b, ", \"median\": ");
+	if (medianOf(r, info, &median, &approximate))
+		appendNumber(b, median, true);
+	else
+		appendFormat(b, "null");
+	appendFormat(b, ", \"median_approximate\": %s, \"variance\": ", approximate ? "true" : "false");
+	appendJsonNumber(b, r->variance, shows(r, NB_STAT_VARIANCE));
+	appendFormat(b, ", \"std_dev\": ");
+	appendJsonNumber(b, r->standardDeviation, shows(r, NB_STAT_VARIANCE));
+
+	appendFormat(b, ",\n \"percentiles\": ");
+	if (r->hasQuantiles) {
+		static const int percents[NB_NUM_QUANTILES] = { 1, 5, 25, 50, 75, 95, 99 };
+		appendFormat(b, "{\"exact\": %s", r->quantilesExact ? "true" : "false");
+		for (int i = 0; i < NB_NUM_QUANTILES; i++) {
+			appendFormat(b, ", \"p%d\": ", percents[i]);
+			appendNumber(b, r->quantiles[i], true);
+		}
+		appendFormat(b, "}");
+	}
+	else {
+		appendFormat(b, "null");
+	}
+
+	appendFormat(b, ",\n \"modes\": ");
+	if (info->aggregate || r->modeUnknown || !shows(r, NB_STAT_MODE)) {
+		appendFormat(b, "null");
+	}
+	else {
+		appendFormat(b, "[");
+		for (size_t i = 0; hasMode(r) && i < r->numModes; i++) {
+			if (i > 0)
+				appendFormat(b, ", ");
+			appendNumber(b, r->modes[i], true);
+		}
+		appendFormat(b, "]");
+	}
+	appendFormat(b, ", \"mode_count\": %zu, \"mode_error\": %zu", hasMode(r) ? r->modeCount : 0, r->modeError);
+
+	if (shows(r, NB_STAT_NB)) {
+		appendFormat(b, ",\n \"frequency\": [");
+		for (int i = 0; i < 9; i++)
+			appendFormat(b, i == 0 ? "%ld" : ", %ld", r->frequency[i]);
+		appendFormat(b, "], \"expected\": ");
+		appendJsonArray(b, r->expected, 9);
+		appendFormat(b, ", \"actual\": ");
+		appendJsonArray(b, r->actual, 9);
+		appendFormat(b, ",\n \"nb_variance\": ");
+		appendNumber(b, r->NBVariance, true);
+		appendFormat(b, ", \"nb_std_dev\": ");
+		appendNumber(b, r->NBDeviation, true);
+		appendFormat(b, ", \"relationship\": \"%s\"", relationship(r->NBDeviation));
+	}
+	else {
+		appendFormat(b, ",\n \"frequency\": null, \"expected\": null, \"actual\": null,\n \"nb_variance\": null,"
+			" \"nb_std_dev\": null, \"relationship\": null");
+	}
+
+	appendFormat(b, ",\n \"bootstrap\": ");
+	if (r->hasBootstrap) {
+		appendFormat(b, "{\"resamples\": %zu, \"level\": %g, ", r->bootstrap.resamples, NB_BOOTSTRAP_LEVEL);
+		appendJsonStat(b, "nb_std_dev", &r->bootstrap.deviation, false);
+		appendJsonStat(b, "chi_square", &r->bootstrap.chiSquare, false);
+		appendJsonStat(b, "mad", &r->bootstrap.mad, true);
+		appendFormat(b, "}");
+	}
+	else {
+		appendFormat(b, "null");
+	}
+
+	appendFormat(b, ",\n \"tests\": {");
+	bool first = true;
+	for (int t = 0; t < NB_NUM_DIGIT_TESTS; t++) {
+		const struct nb_digit_test* d = &r->tests[t];
+		if (!d->computed)
+			continue;
+		appendFormat(b, "%s\n  \"%s\": {\"count\": %zu, \"first\": %d, \"chi_square\": ", first ? "" : ",", testNames[t],
+			d->count, d->first);
+		if (t != NB_TEST_SUMMATION)
+			appendNumber(b, d->chiSquare, true);
+		else
+			appendFormat(b, "null");
+		appendFormat(b, ", \"mad\": ");
+		appendNumber(b, d->MAD, true);
+		appendFormat(b, ", \"nb_std_dev\": ");
+		appendNumber(b, d->NBDeviation, true);
+		appendFormat(b, ",\n   \"expected\": ");
+		appendJsonArray(b, d->expected, d->bins);
+		appendFormat(b, ",\n   \"actual\": ");
+		appendJsonArray(b, d->actual, d->bins);
+		appendFormat(b, "}");
+		first = false;
+	}
+	appendFormat(b, "},\n \"duplication\": ");
+	if (r->hasDuplication)
+		appendFormat(b, "{\"duplicated_values\": %zu, \"duplicate_numbers\": %zu}", r->duplicatedValues, r->duplicateNumbers);
+	else
+		appendFormat(b, "null");
+	appendFormat(b, "}");
+}
+
+/*!	 \fn renderCsvHeader
+	 \return none
+	 \param struct renderBuffer* b
+
+	 The first line of CSV output, the same for every analysis */
+void renderCsvHeader(struct renderBuffer* b) {
+	for (size_t i = 0; i < CSV_COLUMNS; i++)
+		appendFormat(b, i == 0 ? "%s" : ",%s", csvColumns[i]);
+	appendFormat(b, "\n");
+}
+
+/*!	 \fn appendCsvNumber
+	 \return none
+	 \param struct renderBuffer* b, long double x, bool available - otherwise the field is empty
+
+	 A separator, then the number */
+static void appendCsvNumber(struct renderBuffer* b, long double x, bool available) {
+	appendFormat(b, ",");
+	if (available)
+		appendNumber(b, x, false);
+}
+
+/*!	 \fn renderCsv
+	 \return none
+	 \param struct renderBuffer* b, const struct nb_result* r, const struct reportInfo* info
+
+	 The report as one row under renderCsvHeader */
+static void renderCsv(struct renderBuffer* b, const struct nb_result* r, const struct reportInfo* info) {
+	long double median = 0;
+	bool approximate;
+	bool modes = !info->aggregate && !r->modeUnknown && shows(r, NB_STAT_MODE);
+
+	appendCsvField(b, info->name);
+	appendFormat(b, ",ok,%zu,%zu", r->count, info->rejected);
+	appendCsvNumber(b, r->rangeMin, shows(r, NB_STAT_RANGE));
+	appendCsvNumber(b, r->rangeMax, shows(r, NB_STAT_RANGE));
+	appendCsvNumber(b, r->arithmeticMean, shows(r, NB_STAT_MEAN));
+	bool hasMedian = medianOf(r, info, &median, &approximate);
+	appendCsvNumber(b, median, hasMedian);
+	appendFormat(b, ",%d", approximate ? 1 : 0);
+	appendCsvNumber(b, r->variance, shows(r, NB_STAT_VARIANCE));
+	appendCsvNumber(b, r->standardDeviation, shows(r, NB_STAT_VARIANCE));
+
+	appendFormat(b, ",");
+	for (size_t i = 0; modes && hasMode(r) && i < r->numModes; i++) { // one field, the values separated by spaces
+		if (i > 0)
+			appendFormat(b, " ");
+		appendNumber(b, r->modes[i], false);
+	}
+	if (modes)
+		appendFormat(b, ",%zu,%zu", hasMode(r) ? r->modeCount : 0, r->modeError);
+	else
+		appendFormat(b, ",,");
+	for (int i = 0; i < NB_NUM_QUANTILES; i++)
+		appendCsvNumber(b, r->quantiles[i], r->hasQuantiles);
+	appendFormat(b, r->hasQuantiles ? ",%d" : ",", r->quantilesExact ? 1 : 0);
+	for (int i = 0; i < 9; i++)
+		appendCsvNumber(b, r->frequency[i], shows(r, NB_STAT_NB));
+	appendCsvNumber(b, r->NBVariance, shows(r, NB_STAT_NB));
+	appendCsvNumber(b, r->NBDeviation, shows(r, NB_STAT_NB));
+	appendFormat(b, ",%s", shows(r, NB_STAT_NB) ? relationship(r->NBDeviation) : "");
+
+	const struct nb_bootstrap* s = &r->bootstrap;
+	if (r->hasBootstrap)
+		appendFormat(b, ",%zu", s->resamples);
+	else
+		appendFormat(b, ",");
+	appendCsvNumber(b, s->deviation.low, r->hasBootstrap);
+	appendCsvNumber(b, s->deviation.high, r->hasBootstrap);
+	appendCsvNumber(b, s->deviation.pValue, r->hasBootstrap);
+	const struct nb_bootstrap_stat* stats[2] = { &s->chiSquare, &s->mad };
+	for (int i = 0; i < 2; i++) {
+		appendCsvNumber(b, stats[i]->observed, r->hasBootstrap);
+		appendCsvNumber(b, stats[i]->low, r->hasBootstrap);
+		appendCsvNumber(b, stats[i]->high, r->hasBootstrap);
+		appendCsvNumber(b, stats[i]->pValue, r->hasBootstrap);
+	}
+
+	for (int t = 0; t < NB_NUM_DIGIT_TESTS; t++) {
+		const struct nb_digit_test* d = &r->tests[t];
+		appendCsvNumber(b, d->chiSquare, d->computed && t != NB_TEST_SUMMATION);
+		appendCsvNumber(b, d->MAD, d->computed);
+		appendCsvNumber(b, d->NBDeviation, d->computed);
+	}
+	if (r->hasDuplication)
+		appendFormat(b, ",%zu,%zu\n", r->duplicatedValues, r->duplicateNumbers);
+	else
+		appendFormat(b, ",,\n");
+}
+
+/*!	 \fn renderReport
+	 \return none, out of memory marks the buffer failed
+	 \param struct renderBuffer* b, enum renderFormat format, const struct nb_result* r - finalized analysis,
+			const struct reportInfo* info
+
+	 Text: the statistics and the table/graph. JSON: one object without a line break after it.
+	 CSV: one row under renderCsvHeader. */
+void renderReport(struct renderBuffer* b, enum renderFormat format, const struct nb_result* r, const struct reportInfo* info) {
+	switch (format) {
+	case RENDER_JSON:
+		renderJson(b, r, info);
+		break;
+	case RENDER_CSV:
+		renderCsv(b, r, info);
+		break;
+	default:
+		renderText(b, r, info);
+		break;
+	}
+}
+
+/*!	 \fn renderError
+	 \return none
+	 \param struct renderBuffer* b, enum renderFormat format, const char* name - file, const char* error - message
+
+	 A file that has no report, in place of its report: a line of text, a JSON object or a CSV row with the
+	 message as status and the other fields empty */
+void renderError(struct renderBuffer* b, enum renderFormat format, const char* name, const char* error) {
+	switch (format) {
+	case RENDER_JSON:
+		appendFormat(b, "{\"file\": ");
+		appendJsonString(b, name);
+		appendFormat(b, ", \"error\": ");
+		appendJsonString(b, error);
+		appendFormat(b, "}");
+		break;
+	case RENDER_CSV:
+		appendCsvField(b, name);
+		appendFormat(b, ",");
+		appendCsvField(b, error);
+		appendRepeat(b, ",", CSV_COLUMNS - 2);
+		appendFormat(b, "\n");
+		break;
+	default:
+		appendFormat(b, "%s\terror: %s\n", name, error);
+		break;
+	}
+}
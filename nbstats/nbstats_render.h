@@ -0,0 +1,61 @@
+/*!	\file		nbstats_render.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Report renderer: the whole report is formatted into one buffer, which is then written at once.
+	Text is the console report (box drawing in UTF-8, the Windows console is switched to it), JSON and CSV are
+	for programs that read the results.
+*/
+#ifndef NBSTATS_RENDER_H
+#define NBSTATS_RENDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "nbstats.h"
+
+#define REPORT_CAPACITY	(1 << 14)	// a report with every digit test fits without growing
+#define LINE_CAPACITY	(1 << 8)	// one line of a batch
+
+// --format of the report
+enum renderFormat {
+	RENDER_TEXT,
+	RENDER_JSON,
+	RENDER_CSV
+};
+
+// text formatted so far, grows when a report does not fit
+struct renderBuffer {
+	char* data;
+	size_t size;
+	size_t capacity;
+	bool failed;				// out of memory, the text is incomplete
+};
+
+// what the report shows besides the result
+struct reportInfo {
+	const char* name;			// file of the report (JSON and CSV), NULL: console or summaries
+	bool aggregate;				// merged statistics of several files, no median or mode
+	double quantileError;		// rank error of approximate percentiles
+	size_t rejected;			// negative, zero and infinite numbers skipped
+};
+
+bool initRender(struct renderBuffer* b, size_t capacity);
+void freeRender(struct renderBuffer* b);
+void appendFormat(struct renderBuffer* b, const char* format, ...);
+void appendRepeat(struct renderBuffer* b, const char* glyph, size_t times);
+void appendBuffer(struct renderBuffer* b, const struct renderBuffer* src);
+void appendJsonString(struct renderBuffer* b, const char* s);
+void appendCsvField(struct renderBuffer* b, const char* s);
+bool writeRender(struct renderBuffer* b, FILE* out);
+void clearRender(struct renderBuffer* b);
+
+const char* relationship(long double NBDeviation);
+void renderBanner(struct renderBuffer* b, bool console);
+void renderCsvHeader(struct renderBuffer* b);
+void renderReport(struct renderBuffer* b, enum renderFormat format, const struct nb_result* r, const struct reportInfo* info);
+void renderError(struct renderBuffer* b, enum renderFormat format, const char* name, const char* error);
+
+#endif
@@ -0,0 +1,875 @@
+/*!	\file		nbstats_serve.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Analysis daemon (--serve): named data sets kept in the process, fed and queried over a local (Unix domain)
+	socket, so that a small analysis costs a round trip instead of a process start. One request per line,
+	every answer starts with OK or ERR:
+
+		CREATE name					OK
+		APPEND name numbers ...		OK count rejected	(count: numbers of the data set, rejected: of this batch)
+		QUERY name [json|csv|text]	OK bytes, followed by the report of that many bytes (JSON by default)
+		DROP name					OK
+		LIST						OK bytes, followed by one name per line
+		SHUTDOWN					OK, the daemon stops
+
+	The event loop waits on all the connections at once and hands every connection with complete requests to
+	the workers, started once for the whole run: a worker answers all the requests of one connection so that
+	they keep their order, and a lock per data set keeps two connections from using one context at once.
+	The loop keeps waiting on the other connections meanwhile, a slow QUERY only holds its own client; the
+	worker queues the connection back and wakes the loop through a socket pair that is waited on with the rest. Every data set is a stream context,
+	which keeps summaries instead of the numbers: a QUERY costs the same at any count.
+	The numbers of an APPEND are tokenized before they are taken, a token that is not a number refuses the
+	whole batch and the data set stays as it was.
+*/
+#include "nbstats_serve.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_platform.h"
+#include "nbstats_render.h"
+#include "nbstats_tokenizer.h"
+
+#define RECEIVE_BLOCK	(1 << 16)	// bytes asked from a socket at once
+#define MAX_REQUEST		(1 << 26)	// longest request (64MB of numbers), a longer one closes the connection
+#define MAX_NAME		255			// characters of a data set name
+#define INITIAL_SLOTS	64			// power of two
+
+struct dataset {
+	char* name;
+	size_t length;
+	size_t hash;
+	nb_context* ctx;
+	size_t rejected;		// negative, zero and infinite numbers of all its batches
+	struct mutex lock;		// one request at a time on the context
+	size_t refs;			// the table and the requests using it, under the table lock
+};
+
+// hash table of data sets, open addressing with linear probing
+struct datasetTable {
+	struct dataset** slots;	// NULL is empty
+	size_t mask;			// number of slots - 1
+	size_t size;
+	struct mutex lock;
+};
+
+struct connection {
+	intptr_t socket;
+	char* in;				// received requests not yet served, the last one may be incomplete
+	size_t inSize;
+	size_t inCapacity;
+	bool complete;			// in holds at least one whole request
+	struct renderBuffer out;	// answers not yet sent
+	size_t sent;			// bytes of out already sent
+	bool closing;			// peer gone or request too long: close once out is sent
+	bool busy;				// with the workers, the loop leaves it alone until it comes back
+	struct connection* next;	// in the queue or the done list
+};
+
+// what a worker needs for itself, one each
+struct serveWorker {
+	struct thread thread;
+	struct server* server;
+	struct tokenizer tok;	// numbers of an APPEND
+	size_t rejected;
+	size_t invalidIndex;	// first token that is not a number, SIZE_MAX: none
+	struct renderBuffer report;	// of a QUERY or LIST, before its length is known
+};
+
+struct server {
+	struct nb_config config;	// of every data set
+	unsigned threads;
+	struct serveWorker* workers;
+	struct datasetTable table;
+	struct connection** connections;
+	size_t numConnections;
+	size_t capacity;
+	struct connection** polled;	// connection of every poll entry after the first two
+	struct pollEntry* polls;	// listener, wake socket, then the connections that are not busy
+	size_t numBusy;				// connections with the workers
+	bool stopping;				// SHUTDOWN, set under the table lock
+	bool draining;				// the loop saw stopping: no more requests for the workers
+	struct mutex queueLock;		// of the queue, the done list and quit
+	struct condition queued;	// a connection was queued or quit was set
+	struct connection* queueHead;	// connections with whole requests, first come first served
+	struct connection* queueTail;
+	struct connection* done;	// served, their answers are for the loop to send
+	bool quit;					// the workers return
+	intptr_t wakeRead;			// waited on by the loop
+	intptr_t wakeWrite;			// a worker sends a byte when done was empty
+};
+
+/*!	 \fn hashName
+	 \return hash of the data set name (FNV-1a)
+	 \param const char* name, size_t length */
+static size_t hashName(const char* name, size_t length) {
+	uint64_t h = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < length; i++) {
+		h ^= (unsigned char)name[i];
+		h *= 1099511628211ULL;
+	}
+	return (size_t)h;
+}
+
+/*!	 \fn findSlot
+	 \return slot of the data set, or the empty slot where it would go
+	 \param const struct datasetTable* t, const char* name, size_t length, size_t hash */
+static size_t findSlot(const struct datasetTable* t, const char* name, size_t length, size_t hash) {
+	size_t i = hash & t->mask;
+
+	for (; t->slots[i] != NULL; i = (i + 1) & t->mask) {
+		const struct dataset* d = t->slots[i];
+		if (d->hash == hash && d->length == length && memcmp(d->name, name, length) == 0)
+			break;
+	}
+	return i;
+}
+
+/*!	 \fn growSlots
+	 \return false if out of memory (the table is unchanged)
+	 \param struct datasetTable* t
+
+	 Double the slots and place every data set again */
+static bool growSlots(struct datasetTable* t) {
+	size_t count = (t->mask + 1) * 2;
+	struct dataset** slots = (struct dataset**)calloc(count, sizeof(struct dataset*));
+
+	if (slots == NULL)
+		return false;
+	for (size_t s = 0; s <= t->mask; s++) {
+		struct dataset* d = t->slots[s];
+		if (d == NULL)
+			continue;
+		size_t i = d->hash & (count - 1);
+		while (slots[i] != NULL)
+			i = (i + 1) & (count - 1);
+		slots[i] = d;
+	}
+	free(t->slots);
+	t->slots = slots;
+	t->mask = count - 1;
+	return true;
+}
+
+/*!	 \fn removeSlot
+	 \return none
+	 \param struct datasetTable* t, size_t i - occupied slot
+
+	 Empty a slot and move back the data sets after it that probed past it, so no search stops early */
+static void removeSlot(struct datasetTable* t, size_t i) {
+	t->slots[i] = NULL;
+	t->size--;
+	for (size_t j = (i + 1) & t->mask; t->slots[j] != NULL; j = (j + 1) & t->mask) {
+		size_t home = t->slots[j]->hash & t->mask;
+		bool between = i < j ? home > i && home <= j : home > i || home <= j; // home in (i, j]: stays
+		if (!between) {
+			t->slots[i] = t->slots[j];
+			t->slots[j] = NULL;
+			i = j;
+		}
+	}
+}
+
+/*!	 \fn freeDataset
+	 \return none
+	 \param struct dataset* d */
+static void freeDataset(struct dataset* d) {
+	nb_destroy(d->ctx);
+	freeMutex(&d->lock);
+	free(d->name);
+	free(d);
+}
+
+/*!	 \fn acquireDataset
+	 \return the data set, NULL if there is none of that name
+	 \param struct server* s, const char* name, size_t length
+
+	 The data set stays until releaseDataset, even if it is dropped meanwhile */
+static struct dataset* acquireDataset(struct server* s, const char* name, size_t length) {
+	struct datasetTable* t = &s->table;
+
+	lockMutex(&t->lock);
+	struct dataset* d = t->slots[findSlot(t, name, length, hashName(name, length))];
+	if (d != NULL)
+		d->refs++;
+	unlockMutex(&t->lock);
+	return d;
+}
+
+/*!	 \fn releaseDataset
+	 \return none
+	 \param struct server* s, struct dataset* d - from acquireDataset */
+static void releaseDataset(struct server* s, struct dataset* d) {
+	lockMutex(&s->table.lock);
+	bool last = --d->refs == 0;
+	unlockMutex(&s->table.lock);
+	if (last)
+		freeDataset(d);
+}
+
+/*!	 \fn validName
+	 \return true if the name can be a data set name
+	 \param const char* name, size_t length */
+static bool validName(const char* name, size_t length) {
+	if (length == 0 || length > MAX_NAME)
+		return false;
+	for (size_t i = 0; i < length; i++) {
+		unsigned char c = (unsigned char)name[i];
+		if (c < 0x20 || c == 0x7f)
+			return false;
+	}
+	return true;
+}
+
+/*!	 \fn nextWord
+	 \return first character of the next word, the word is empty at the end of the request
+	 \param const char** p - moves past the word, const char* end, size_t* length - of the word */
+static const char* nextWord(const char** p, const char* end, size_t* length) {
+	while (*p < end && (**p == ' ' || **p == '\t'))
+		(*p)++;
+	const char* word = *p;
+	while (*p < end && **p != ' ' && **p != '\t')
+		(*p)++;
+	*length = (size_t)(*p - word);
+	return word;
+}
+
+/*!	 \fn isWord
+	 \return true if the word is keyword
+	 \param const char* word, size_t length, const char* keyword */
+static bool isWord(const char* word, size_t length, const char* keyword) {
+	return strlen(keyword) == length && memcmp(word, keyword, length) == 0;
+}
+
+/*!	 \fn serveCreate
+	 \return none
+	 \param struct server* s, struct connection* c, const char* name, size_t length */
+static void serveCreate(struct server* s, struct connection* c, const char* name, size_t length) {
+	struct datasetTable* t = &s->table;
+	struct dataset* d = (struct dataset*)calloc(1, sizeof(struct dataset));
+
+	if (!validName(name, length)) {
+		free(d);
+		appendFormat(&c->out, "ERR invalid data set name\n");
+		return;
+	}
+	if (d == NULL || (d->name = (char*)malloc(length + 1)) == NULL || (d->ctx = nb_create(&s->config)) == NULL
+		|| !initMutex(&d->lock)) {
+		if (d != NULL) {
+			nb_destroy(d->ctx);
+			free(d->name);
+		}
+		free(d);
+		appendFormat(&c->out, "ERR out of memory\n");
+		return;
+	}
+	memcpy(d->name, name, length);
+	d->name[length] = '\0';
+	d->length = length;
+	d->hash = hashName(name, length);
+	d->refs = 1; // the table's
+
+	lockMutex(&t->lock);
+	if ((t->size + 1) * 2 > t->mask + 1 && !growSlots(t)) {
+		unlockMutex(&t->lock);
+		freeDataset(d);
+		appendFormat(&c->out, "ERR out of memory\n");
+		return;
+	}
+	size_t i = findSlot(t, name, length, d->hash);
+	bool exists = t->slots[i] != NULL;
+	if (!exists) {
+		t->slots[i] = d;
+		t->size++;
+	}
+	unlockMutex(&t->lock);
+
+	if (exists) {
+		freeDataset(d);
+		appendFormat(&c->out, "ERR data set %.*s exists\n", (int)length, name);
+		return;
+	}
+	appendFormat(&c->out, "OK\n");
+}
+
+/*!	 \fn serveDrop
+	 \return none
+	 \param struct server* s, struct connection* c, const char* name, size_t length
+
+	 The data set goes when the last request using it is done */
+static void serveDrop(struct server* s, struct connection* c, const char* name, size_t length) {
+	struct datasetTable* t = &s->table;
+
+	lockMutex(&t->lock);
+	size_t i = findSlot(t, name, length, hashName(name, length));
+	struct dataset* d = t->slots[i];
+	if (d != NULL)
+		removeSlot(t, i);
+	unlockMutex(&t->lock);
+
+	if (d == NULL) {
+		appendFormat(&c->out, "ERR no data set %.*s\n", (int)length, name);
+		return;
+	}
+	releaseDataset(s, d); // the table's reference
+	appendFormat(&c->out, "OK\n");
+}
+
+/*!	 \fn countRejection
+	 \return none
+	 \param void* ctx - struct serveWorker, enum rejectReason reason, size_t index - element number,
+			const char* token, size_t length */
+static void countRejection(void* ctx, enum rejectReason reason, size_t index, const char* token, size_t length) {
+	struct serveWorker* w = (struct serveWorker*)ctx;
+	(void)token;
+	(void)length;
+
+	if (reason == REJECT_INVALID)
+		w->invalidIndex = index;
+	else
+		w->rejected++;
+}
+
+/*!	 \fn serveAppend
+	 \return none
+	 \param struct server* s, struct serveWorker* w, struct connection* c, const char* name, size_t length,
+			const char* numbers, size_t size - rest of the request
+
+	 The batch is tokenized outside the lock of the data set, which is only held while the numbers are taken */
+static void serveAppend(struct server* s, struct serveWorker* w, struct connection* c, const char* name, size_t length,
+	const char* numbers, size_t size) {
+	struct tokenizer* t = &w->tok;
+	size_t used;
+
+	struct dataset* d = acquireDataset(s, name, length);
+	if (d == NULL) {
+		appendFormat(&c->out, "ERR no data set %.*s\n", (int)length, name);
+		return;
+	}
+	t->chInNum = false;
+	t->total = 0;
+	t->size = 0;
+	t->values[0] = 0;
+	w->rejected = 0;
+	w->invalidIndex = SIZE_MAX;
+	int scanned = scanNumbers(t, numbers, size, true, &used);
+
+	int status = NB_OK;
+	size_t count = 0;
+	if (scanned == TOKENIZER_OK) {
+		lockMutex(&d->lock);
+		status = nb_ingest_values(d->ctx, t->values, t->size);
+		d->rejected += w->rejected;
+		count = nb_count(d->ctx);
+		unlockMutex(&d->lock);
+	}
+	releaseDataset(s, d);
+
+	if (scanned == TOKENIZER_INVALID)
+		appendFormat(&c->out, "ERR element %zu is not a number, batch refused\n", w->invalidIndex + 1);
+	else if (scanned == TOKENIZER_NOMEM || status != NB_OK)
+		appendFormat(&c->out, "ERR out of memory\n");
+	else
+		appendFormat(&c->out, "OK %zu %zu\n", count, w->rejected);
+}
+
+/*!	 \fn serveQuery
+	 \return none
+	 \param struct server* s, struct serveWorker* w, struct connection* c, const char* name, size_t length,
+			const char* format, size_t formatLength - empty: JSON
+
+	 The report of what the data set has taken so far, the data set goes on taking numbers */
+static void serveQuery(struct server* s, struct serveWorker* w, struct connection* c, const char* name, size_t length,
+	const char* format, size_t formatLength) {
+	enum renderFormat f;
+	struct reportInfo info = { 0 };
+
+	if (formatLength == 0 || isWord(format, formatLength, "json"))
+		f = RENDER_JSON;
+	else if (isWord(format, formatLength, "csv"))
+		f = RENDER_CSV;
+	else if (isWord(format, formatLength, "text"))
+		f = RENDER_TEXT;
+	else {
+		appendFormat(&c->out, "ERR invalid format, json, csv or text\n");
+		return;
+	}
+	struct dataset* d = acquireDataset(s, name, length);
+	if (d == NULL) {
+		appendFormat(&c->out, "ERR no data set %.*s\n", (int)length, name);
+		return;
+	}
+
+	clearRender(&w->report);
+	lockMutex(&d->lock);
+	int status = nb_snapshot(d->ctx);
+	if (status == NB_OK) { // the result is only valid until the next snapshot, it is rendered under the lock
+		info.name = d->name;
+		info.quantileError = s->config.quantileError;
+		info.rejected = d->rejected;
+		if (f == RENDER_CSV)
+			renderCsvHeader(&w->report);
+		renderReport(&w->report, f, nb_result(d->ctx), &info);
+		if (f == RENDER_JSON)
+			appendFormat(&w->report, "\n");
+	}
+	unlockMutex(&d->lock);
+	releaseDataset(s, d);
+
+	if (status == NB_EMPTY)
+		appendFormat(&c->out, "ERR data set %.*s is empty\n", (int)length, name);
+	else if (status != NB_OK || w->report.failed)
+		appendFormat(&c->out, "ERR out of memory\n");
+	else {
+		appendFormat(&c->out, "OK %zu\n", w->report.size);
+		appendBuffer(&c->out, &w->report);
+	}
+}
+
+/*!	 \fn serveList
+	 \return none
+	 \param struct server* s, struct serveWorker* w, struct connection* c */
+static void serveList(struct server* s, struct serveWorker* w, struct connection* c) {
+	struct datasetTable* t = &s->table;
+
+	clearRender(&w->report);
+	lockMutex(&t->lock);
+	for (size_t i = 0; i <= t->mask; i++) {
+		if (t->slots[i] != NULL)
+			appendFormat(&w->report, "%s\n", t->slots[i]->name);
+	}
+	unlockMutex(&t->lock);
+
+	if (w->report.failed)
+		appendFormat(&c->out, "ERR out of memory\n");
+	else {
+		appendFormat(&c->out, "OK %zu\n", w->report.size);
+		appendBuffer(&c->out, &w->report);
+	}
+}
+
+/*!	 \fn serveRequest
+	 \return none
+	 \param struct server* s, struct serveWorker* w, struct connection* c, const char* request, size_t length - one line
+
+	 Answer one request into the output of the connection */
+static void serveRequest(struct server* s, struct serveWorker* w, struct connection* c, const char* request, size_t length) {
+	const char* p = request;
+	const char* end = request + length;
+	size_t commandLength, nameLength, argLength, extraLength;
+
+	const char* command = nextWord(&p, end, &commandLength);
+	const char* name = nextWord(&p, end, &nameLength);
+	const char* rest = p;
+
+	if (isWord(command, commandLength, "APPEND") && nameLength > 0) {
+		serveAppend(s, w, c, name, nameLength, rest, (size_t)(end - rest));
+		return;
+	}
+	const char* arg = nextWord(&p, end, &argLength);
+	nextWord(&p, end, &extraLength);
+	if (extraLength > 0)
+		appendFormat(&c->out, "ERR invalid request\n");
+	else if (isWord(command, commandLength, "QUERY") && nameLength > 0)
+		serveQuery(s, w, c, name, nameLength, arg, argLength);
+	else if (argLength > 0)
+		appendFormat(&c->out, "ERR invalid request\n");
+	else if (isWord(command, commandLength, "CREATE") && nameLength > 0)
+		serveCreate(s, c, name, nameLength);
+	else if (isWord(command, commandLength, "DROP") && nameLength > 0)
+		serveDrop(s, c, name, nameLength);
+	else if (isWord(command, commandLength, "LIST") && nameLength == 0)
+		serveList(s, w, c);
+	else if (isWord(command, commandLength, "SHUTDOWN") && nameLength == 0) {
+		lockMutex(&s->table.lock);
+		s->stopping = true;
+		unlockMutex(&s->table.lock);
+		appendFormat(&c->out, "OK\n");
+	}
+	else if (commandLength > 0) // blank lines are ignored
+		appendFormat(&c->out, "ERR invalid request\n");
+}
+
+/*!	 \fn serveConnection
+	 \return none
+	 \param struct server* s, struct serveWorker* w, struct connection* c
+
+	 Answer every whole request of the connection in order */
+static void serveConnection(struct server* s, struct serveWorker* w, struct connection* c) {
+	const char* p = c->in;
+	const char* end = c->in + c->inSize;
+	const char* eol;
+
+	while ((eol = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+		size_t length = (size_t)(eol - p);
+		if (length > 0 && p[length - 1] == '\r')
+			length--;
+		serveRequest(s, w, c, p, length);
+		p = eol + 1;
+	}
+	c->inSize = (size_t)(end - p);
+	memmove(c->in, p, c->inSize);
+	c->complete = false;
+	if (c->out.failed) { // an answer is lost, the client can not tell which
+		c->closing = true;
+		clearRender(&c->out);
+	}
+}
+
+/*!	 \fn runWorker
+	 \return none
+	 \param void* arg - struct serveWorker
+
+	 Thread of a worker: serve the queued connections until quit, and hand each back to the loop */
+static void runWorker(void* arg) {
+	struct serveWorker* w = (struct serveWorker*)arg;
+	struct server* s = w->server;
+
+	lockMutex(&s->queueLock);
+	for (;;) {
+		while (s->queueHead == NULL && !s->quit)
+			waitCondition(&s->queued, &s->queueLock);
+		if (s->quit)
+			break;
+		struct connection* c = s->queueHead;
+		s->queueHead = c->next;
+		if (s->queueHead == NULL)
+			s->queueTail = NULL;
+		unlockMutex(&s->queueLock);
+
+		serveConnection(s, w, c);
+
+		lockMutex(&s->queueLock);
+		if (s->done == NULL) { // the loop takes the whole list at one byte, a full socket is awake anyway
+			char byte = 0;
+			sendLocal(s->wakeWrite, &byte, 1);
+		}
+		c->next = s->done;
+		s->done = c;
+	}
+	unlockMutex(&s->queueLock);
+}
+
+/*!	 \fn takeServed
+	 \return none
+	 \param struct server* s
+
+	 Take the connections the workers are done with back into the loop */
+static void takeServed(struct server* s) {
+	char bytes[64];
+
+	while (receiveLocal(s->wakeRead, bytes, sizeof(bytes)) > 0) // before the list, a later byte is for a later one
+		;
+	lockMutex(&s->queueLock);
+	struct connection* c = s->done;
+	s->done = NULL;
+	unlockMutex(&s->queueLock);
+	for (; c != NULL; c = c->next) {
+		c->busy = false;
+		s->numBusy--;
+	}
+}
+
+/*!	 \fn receiveRequests
+	 \return none
+	 \param struct connection* c
+
+	 Take everything the socket has, the connection closes when the peer did or a request is too long */
+static void receiveRequests(struct connection* c) {
+	while (!c->closing) {
+		if (c->inCapacity - c->inSize < RECEIVE_BLOCK) {
+			if (c->inSize > MAX_REQUEST) {
+				appendFormat(&c->out, "ERR request too long\n");
+				c->closing = true;
+				return;
+			}
+			size_t capacity = c->inCapacity * 2 > c->inSize + RECEIVE_BLOCK ? c->inCapacity * 2 : c->inSize + RECEIVE_BLOCK;
+			char* grown = (char*)realloc(c->in, capacity);
+			if (grown == NULL) {
+				c->closing = true;
+				return;
+			}
+			c->in = grown;
+			c->inCapacity = capacity;
+		}
+
+		ptrdiff_t received = receiveLocal(c->socket, c->in + c->inSize, c->inCapacity - c->inSize);
+		if (received < 0) // nothing more for now
+			return;
+		if (received == 0) {
+			c->closing = true;
+			return;
+		}
+		if (memchr(c->in + c->inSize, '\n', (size_t)received) != NULL)
+			c->complete = true;
+		c->inSize += (size_t)received;
+	}
+}
+
+/*!	 \fn sendAnswers
+	 \return none
+	 \param struct connection* c
+
+	 Send as much of the answers as the socket takes, the rest waits for the next round */
+static void sendAnswers(struct connection* c) {
+	while (c->sent < c->out.size) {
+		ptrdiff_t sent = sendLocal(c->socket, c->out.data + c->sent, c->out.size - c->sent);
+		if (sent == 0)
+			return;
+		if (sent < 0) { // the peer went away, nobody to answer
+			c->closing = true;
+			break;
+		}
+		c->sent += (size_t)sent;
+	}
+	clearRender(&c->out);
+	c->sent = 0;
+}
+
+/*!	 \fn closeConnection
+	 \return none
+	 \param struct connection* c */
+static void closeConnection(struct connection* c) {
+	closeLocal(c->socket);
+	freeRender(&c->out);
+	free(c->in);
+	free(c);
+}
+
+/*!	 \fn acceptConnections
+	 \return none
+	 \param struct server* s, intptr_t listener
+
+	 Take every waiting connection, one that finds no memory is closed at once */
+static void acceptConnections(struct server* s, intptr_t listener) {
+	intptr_t socket;
+
+	while (acceptLocal(listener, &socket)) {
+		if (s->numConnections == s->capacity) {
+			size_t capacity = s->capacity < 16 ? 16 : s->capacity * 2;
+			struct connection** connections = (struct connection**)realloc(s->connections, capacity * sizeof(struct connection*));
+			struct connection** polled = (struct connection**)realloc(s->polled, capacity * sizeof(struct connection*));
+			struct pollEntry* polls = (struct pollEntry*)realloc(s->polls, (capacity + 2) * sizeof(struct pollEntry));
+			if (connections != NULL)
+				s->connections = connections;
+			if (polled != NULL)
+				s->polled = polled;
+			if (polls != NULL)
+				s->polls = polls;
+			if (connections == NULL || polled == NULL || polls == NULL) {
+				closeLocal(socket);
+				continue;
+			}
+			s->capacity = capacity;
+		}
+
+		struct connection* c = (struct connection*)calloc(1, sizeof(struct connection));
+		if (c == NULL || !initRender(&c->out, LINE_CAPACITY)) {
+			if (c != NULL)
+				freeRender(&c->out);
+			free(c);
+			closeLocal(socket);
+			continue;
+		}
+		c->socket = socket;
+		s->connections[s->numConnections++] = c;
+	}
+}
+
+/*!	 \fn serveRound
+	 \return false if the sockets can not be waited on
+	 \param struct server* s, intptr_t listener
+
+	 Wait for the sockets, take new connections, requests and the connections the workers are done with,
+	 queue the whole requests for the workers and send the answers. A connection with answers still to send
+	 is not read, a slow client only slows itself. */
+static bool serveRound(struct server* s, intptr_t listener) {
+	size_t numPolls = 2;
+
+	s->polls[0].socket = listener;
+	s->polls[0].wantRead = true;
+	s->polls[0].wantWrite = false;
+	s->polls[1].socket = s->wakeRead;
+	s->polls[1].wantRead = true;
+	s->polls[1].wantWrite = false;
+	for (size_t i = 0; i < s->numConnections; i++) {
+		struct connection* c = s->connections[i];
+		if (c->busy)
+			continue;
+		struct pollEntry* e = &s->polls[numPolls];
+		e->socket = c->socket;
+		e->wantWrite = c->out.size > 0;
+		e->wantRead = !e->wantWrite && !c->closing;
+		s->polled[numPolls++ - 2] = c;
+	}
+	if (pollLocal(s->polls, numPolls, -1) < 0)
+		return false;
+
+	if (s->polls[1].readable)
+		takeServed(s);
+	for (size_t i = 2; i < numPolls; i++) {
+		struct connection* c = s->polled[i - 2];
+		if (s->polls[i].writable)
+			sendAnswers(c);
+		if (s->polls[i].readable)
+			receiveRequests(c);
+	}
+	if (s->polls[0].readable)
+		acceptConnections(s, listener);
+
+	lockMutex(&s->table.lock);
+	s->draining = s->stopping;
+	unlockMutex(&s->table.lock);
+
+	struct connection* head = NULL;
+	struct connection* tail = NULL;
+	size_t kept = 0;
+	for (size_t i = 0; i < s->numConnections; i++) {
+		struct connection* c = s->connections[i];
+		if (!c->busy) {
+			if (c->out.size > 0)
+				sendAnswers(c);
+			if (c->complete && c->out.size == 0 && !s->draining) {
+				c->busy = true;
+				c->next = NULL;
+				if (tail != NULL)
+					tail->next = c;
+				else
+					head = c;
+				tail = c;
+				s->numBusy++;
+			}
+			else if (c->closing && c->out.size == 0) {
+				closeConnection(c);
+				continue;
+			}
+		}
+		s->connections[kept++] = c;
+	}
+	s->numConnections = kept;
+
+	if (head != NULL) {
+		lockMutex(&s->queueLock);
+		if (s->queueTail != NULL)
+			s->queueTail->next = head;
+		else
+			s->queueHead = head;
+		s->queueTail = tail;
+		wakeCondition(&s->queued);
+		unlockMutex(&s->queueLock);
+	}
+	return true;
+}
+
+/*!	 \fn serveLocal
+	 \return EXIT_SUCCESS after SHUTDOWN, EXIT_FAILURE if the socket can not be served
+	 \param const char* path - socket file, unsigned threads - workers, 0: one per processor,
+			const struct nb_config* config - of every data set (stream)
+
+	 Run the daemon until a client sends SHUTDOWN */
+int serveLocal(const char* path, unsigned threads, const struct nb_config* config) {
+	struct server s;
+	intptr_t listener;
+	int result = EXIT_SUCCESS;
+
+	memset(&s, 0, sizeof(s));
+	s.config = *config;
+	s.config.stream = true;
+	s.config.threads = 1; // the workers serve connections side by side
+	s.config.bootstrapThreads = 1;
+	s.threads = threads != 0 ? threads : processorCount();
+	s.workers = (struct serveWorker*)calloc(s.threads, sizeof(struct serveWorker));
+	s.table.slots = (struct dataset**)calloc(INITIAL_SLOTS, sizeof(struct dataset*));
+	s.table.mask = INITIAL_SLOTS - 1;
+	s.polls = (struct pollEntry*)malloc(2 * sizeof(struct pollEntry));
+	unsigned workers = 0;
+	bool locked = initMutex(&s.table.lock);
+	bool queueLocked = initMutex(&s.queueLock);
+	bool waits = initCondition(&s.queued);
+	bool ok = locked && queueLocked && waits && s.workers != NULL && s.table.slots != NULL && s.polls != NULL;
+	for (; ok && workers < s.threads; workers++) {
+		struct serveWorker* w = &s.workers[workers];
+		if (!initTokenizer(&w->tok) || !initRender(&w->report, REPORT_CAPACITY)) {
+			freeTokenizer(&w->tok);
+			freeRender(&w->report);
+			ok = false;
+			break;
+		}
+		w->tok.onReject = countRejection;
+		w->tok.rejectCtx = w;
+		w->server = &s;
+	}
+	bool paired = ok && pairLocal(&s.wakeRead, &s.wakeWrite);
+
+	unsigned started = 0;
+	for (; paired && started < s.threads; started++) {
+		if (!startThread(&s.workers[started].thread, runWorker, &s.workers[started]))
+			break;
+	}
+
+	if (!ok) {
+		printf("Error: out of memory\n");
+		result = EXIT_FAILURE;
+	}
+	else if (!paired || started == 0) {
+		printf("Error: the workers can not be started\n");
+		result = EXIT_FAILURE;
+	}
+	else if (!listenLocal(path, &listener)) {
+		printf("error <%s> ", path);
+		perror(" ");
+		result = EXIT_FAILURE;
+	}
+	else {
+		printf("Serving on <%s>, %u workers\n", path, started);
+		fflush(stdout);
+		while (!s.draining || s.numBusy > 0) { // the requests already with the workers still get their answers
+			if (!serveRound(&s, listener)) {
+				printf("Error: waiting on the connections failed\n");
+				result = EXIT_FAILURE;
+				break;
+			}
+		}
+		closeLocal(listener);
+		removeLocal(path);
+	}
+
+	if (started > 0) {
+		lockMutex(&s.queueLock);
+		s.quit = true;
+		wakeCondition(&s.queued);
+		unlockMutex(&s.queueLock);
+		for (unsigned i = 0; i < started; i++)
+			joinThread(&s.workers[i].thread);
+	}
+	for (size_t i = 0; i < s.numConnections; i++)
+		closeConnection(s.connections[i]);
+	if (paired) {
+		closeLocal(s.wakeRead);
+		closeLocal(s.wakeWrite);
+	}
+	for (size_t i = 0; s.table.slots != NULL && i <= s.table.mask; i++) {
+		if (s.table.slots[i] != NULL)
+			freeDataset(s.table.slots[i]);
+	}
+	for (unsigned i = 0; i < workers; i++) {
+		freeTokenizer(&s.workers[i].tok);
+		freeRender(&s.workers[i].report);
+	}
+	if (waits)
+		freeCondition(&s.queued);
+	if (queueLocked)
+		freeMutex(&s.queueLock);
+	if (locked)
+		freeMutex(&s.table.lock);
+	free(s.table.slots);
+	free(s.workers);
+	free(s.connections);
+	free(s.polled);
+	free(s.polls);
+	return result;
+}
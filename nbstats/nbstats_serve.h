@@ -0,0 +1,15 @@
+/*!	\file		nbstats_serve.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Analysis daemon (--serve): named data sets kept in the process, fed and queried over a local socket.
+*/
+#ifndef NBSTATS_SERVE_H
+#define NBSTATS_SERVE_H
+
+#include "nbstats.h"
+
+int serveLocal(const char* path, unsigned threads, const struct nb_config* config);
+
+#endif
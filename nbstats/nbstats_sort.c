@@ -0,0 +1,42 @@
+/*!	\file		nbstats_sort.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Introselect (quickselect falling back to heapsort) and an LSD radix sort on the bit patterns
+	(qsort as fallback), for each storage type of the kept numbers: long double, double and float.
+	The kernels are written once in nbstats_sort.inc and compiled here for every type.
+*/
+#include "nbstats_sort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// long double: compareNumbers, sortNumbers, selectNth, ...
+#define NUMBER			long double
+#define NAME(name)		name
+#ifdef LDBL_KEY_BYTES
+#define KEY_BYTES		LDBL_KEY_BYTES
+#endif
+#include "nbstats_sort.inc"
+#undef NUMBER
+#undef NAME
+#undef KEY_BYTES
+
+// double: compareNumbersDouble, sortNumbersDouble, selectNthDouble, ...
+#define NUMBER			double
+#define NAME(name)		name##Double
+#define KEY_BYTES		8
+#include "nbstats_sort.inc"
+#undef NUMBER
+#undef NAME
+#undef KEY_BYTES
+
+// float: compareNumbersFloat, sortNumbersFloat, selectNthFloat, ...
+#define NUMBER			float
+#define NAME(name)		name##Float
+#define KEY_BYTES		4
+#include "nbstats_sort.inc"
+#undef NUMBER
+#undef NAME
+#undef KEY_BYTES
@@ -0,0 +1,46 @@
+/*!	\file		nbstats_sort.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Order statistics without a comparison sort: selection for the median, radix sort when
+	sorted order is really needed. Every kernel is there for long double, double (...Double) and float (...Float).
+*/
+#ifndef NBSTATS_SORT_H
+#define NBSTATS_SORT_H
+
+#include <float.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// significant bytes of a long double (little endian, sign in the top bit of the last one)
+#if LDBL_MANT_DIG == 53
+#define LDBL_KEY_BYTES	8		// IEEE double (MSVC)
+#elif LDBL_MANT_DIG == 64
+#define LDBL_KEY_BYTES	10		// x87 extended precision
+#elif LDBL_MANT_DIG == 113
+#define LDBL_KEY_BYTES	16		// IEEE quadruple precision
+#endif
+
+int compareNumbers(void const* pA, void const* pB);
+int sortNumbers(long double a[], size_t size);
+void selectNth(long double a[], size_t size, size_t k);
+long double calStatisticalMedian(long double a[], size_t size);
+void selectRanks(long double a[], size_t size, const size_t index[], size_t n, long double out[]);
+bool radixSort(long double a[], size_t size);
+
+int compareNumbersDouble(void const* pA, void const* pB);
+int sortNumbersDouble(double a[], size_t size);
+void selectNthDouble(double a[], size_t size, size_t k);
+long double calStatisticalMedianDouble(double a[], size_t size);
+void selectRanksDouble(double a[], size_t size, const size_t index[], size_t n, long double out[]);
+bool radixSortDouble(double a[], size_t size);
+
+int compareNumbersFloat(void const* pA, void const* pB);
+int sortNumbersFloat(float a[], size_t size);
+void selectNthFloat(float a[], size_t size, size_t k);
+long double calStatisticalMedianFloat(float a[], size_t size);
+void selectRanksFloat(float a[], size_t size, const size_t index[], size_t n, long double out[]);
+bool radixSortFloat(float a[], size_t size);
+
+#endif
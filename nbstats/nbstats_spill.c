@@ -0,0 +1,301 @@
+/*!	\file		nbstats_spill.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Sorted runs in temporary files. A run is written in one piece when the kept numbers reach the budget,
+	the runs are read back through one buffer per run, and the smallest head of all the runs is taken
+	from a min-heap of the runs. With more runs than buffers of MERGE_BLOCK numbers fit in the memory,
+	groups of runs are merged into longer runs first, so the memory given is never exceeded.
+*/
+#include "nbstats_spill.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_sort.h"
+
+#define MERGE_BLOCK		4096	// numbers per run buffer at least
+
+// a run being merged
+struct mergeInput {
+	FILE* file;
+	size_t left;			// numbers not read yet
+	long double* buf;
+	size_t size;
+	size_t at;
+};
+
+// intermediate merges write a longer run
+struct runWriter {
+	FILE* out;
+	bool ok;
+};
+
+/*!	 \fn initSpill
+	 \return none
+	 \param struct spill* s */
+void initSpill(struct spill* s) {
+	memset(s, 0, sizeof(*s));
+}
+
+/*!	 \fn freeSpill
+	 \return none
+	 \param struct spill* s
+
+	 Close the runs, which removes their files */
+void freeSpill(struct spill* s) {
+	for (size_t i = 0; i < s->numRuns; i++)
+		fclose(s->runs[i]);
+	free((void*)s->runs);
+	free(s->runSizes);
+	initSpill(s);
+}
+
+/*!	 \fn openTemporary
+	 \return temporary file (removed when closed), NULL if it can not be created (errno is set)
+	 \param none */
+static FILE* openTemporary() {
+	FILE* file;
+#ifdef _WIN32
+	if (tmpfile_s(&file) != 0)
+		return NULL;
+#else
+	if ((file = tmpfile()) == NULL)
+		return NULL;
+#endif
+	return file;
+}
+
+/*!	 \fn addRun
+	 \return false if out of memory
+	 \param struct spill* s, FILE* file, size_t size */
+static bool addRun(struct spill* s, FILE* file, size_t size) {
+	if (s->numRuns == s->runsCapacity) {
+		size_t capacity = s->runsCapacity == 0 ? 16 : s->runsCapacity * 2;
+		FILE** runsMore = (FILE**)realloc((void*)s->runs, sizeof(FILE*) * capacity);
+		if (runsMore == NULL)
+			return false;
+		s->runs = runsMore;
+		size_t* sizesMore = (size_t*)realloc(s->runSizes, sizeof(size_t) * capacity);
+		if (sizesMore == NULL)
+			return false;
+		s->runSizes = sizesMore;
+		s->runsCapacity = capacity;
+	}
+	s->runs[s->numRuns] = file;
+	s->runSizes[s->numRuns] = size;
+	s->numRuns++;
+	s->count += size;
+	return true;
+}
+
+/*!	 \fn spillRun
+	 \return SPILL_OK, SPILL_NOMEM or SPILL_IO
+	 \param struct spill* s, long double a[] - sorted in place, size_t size
+
+	 Write the numbers as a new sorted run, a[] can take other numbers afterwards */
+enum spillStatus spillRun(struct spill* s, long double a[], size_t size) {
+	FILE* file = openTemporary();
+	if (file == NULL)
+		return SPILL_IO;
+
+	sortNumbers(a, size);
+	if (fwrite(a, sizeof(long double), size, file) != size || fflush(file) != 0) {
+		int error = errno;
+		fclose(file);
+		errno = error;
+		return SPILL_IO;
+	}
+	if (!addRun(s, file, size)) {
+		fclose(file);
+		return SPILL_NOMEM;
+	}
+	return SPILL_OK;
+}
+
+/*!	 \fn readRuns
+	 \return SPILL_OK, SPILL_NOMEM or SPILL_IO
+	 \param const struct spill* s, size_t memory - bytes for the buffer, spillVisitor visit, void* ctx
+
+	 Hand the numbers of every run to visit, run after run (not in order) */
+enum spillStatus readRuns(const struct spill* s, size_t memory, spillVisitor visit, void* ctx) {
+	size_t block = memory / sizeof(long double);
+	if (block < MERGE_BLOCK)
+		block = MERGE_BLOCK;
+	long double* buf = (long double*)malloc(sizeof(long double) * block);
+	if (buf == NULL)
+		return SPILL_NOMEM;
+
+	for (size_t i = 0; i < s->numRuns; i++) {
+		size_t left = s->runSizes[i];
+		rewind(s->runs[i]);
+		while (left > 0) {
+			size_t n = left < block ? left : block;
+			if (fread(buf, sizeof(long double), n, s->runs[i]) != n) {
+				free(buf);
+				errno = ferror(s->runs[i]) ? errno : EIO;
+				return SPILL_IO;
+			}
+			visit(ctx, buf, n);
+			left -= n;
+		}
+	}
+	free(buf);
+	return SPILL_OK;
+}
+
+/*!	 \fn fillInput
+	 \return false if the run could not be read (errno is set)
+	 \param struct mergeInput* in, size_t block */
+static bool fillInput(struct mergeInput* in, size_t block) {
+	size_t n = in->left < block ? in->left : block;
+
+	if (fread(in->buf, sizeof(long double), n, in->file) != n) {
+		errno = ferror(in->file) ? errno : EIO;
+		return false;
+	}
+	in->size = n;
+	in->at = 0;
+	in->left -= n;
+	return true;
+}
+
+static inline long double headOf(const struct mergeInput inputs[], size_t i) {
+	return inputs[i].buf[inputs[i].at];
+}
+
+/*!	 \fn siftHeads
+	 \return none
+	 \param size_t heap[] - numbers of the inputs, min-heap on their heads, size_t size, size_t pos,
+			const struct mergeInput inputs[] */
+static void siftHeads(size_t heap[], size_t size, size_t pos, const struct mergeInput inputs[]) {
+	for (;;) {
+		size_t child = 2 * pos + 1;
+		if (child >= size)
+			return;
+		if (child + 1 < size && headOf(inputs, heap[child + 1]) < headOf(inputs, heap[child]))
+			child++;
+		if (!(headOf(inputs, heap[child]) < headOf(inputs, heap[pos])))
+			return;
+		size_t t = heap[pos];
+		heap[pos] = heap[child];
+		heap[child] = t;
+		pos = child;
+	}
+}
+
+/*!	 \fn mergeGroup
+	 \return SPILL_OK, SPILL_NOMEM or SPILL_IO
+	 \param FILE* const runs[], const size_t sizes[], size_t n - runs to merge, size_t memory - bytes for the buffers,
+			spillVisitor visit, void* ctx - receives the numbers in ascending order */
+static enum spillStatus mergeGroup(FILE* const runs[], const size_t sizes[], size_t n, size_t memory, spillVisitor visit, void* ctx) {
+	size_t block = memory / (sizeof(long double) * (n + 1));
+	if (block < MERGE_BLOCK)
+		block = MERGE_BLOCK;
+
+	struct mergeInput* inputs = (struct mergeInput*)malloc(sizeof(struct mergeInput) * n);
+	size_t* heap = (size_t*)malloc(sizeof(size_t) * n);
+	long double* buffers = (long double*)malloc(sizeof(long double) * block * (n + 1));
+	if (inputs == NULL || heap == NULL || buffers == NULL) {
+		free(inputs);
+		free(heap);
+		free(buffers);
+		return SPILL_NOMEM;
+	}
+
+	enum spillStatus status = SPILL_OK;
+	size_t heapSize = 0;
+	for (size_t i = 0; i < n; i++) {
+		inputs[i].file = runs[i];
+		inputs[i].left = sizes[i];
+		inputs[i].buf = buffers + block * i;
+		rewind(runs[i]);
+		if (sizes[i] == 0)
+			continue;
+		if (!fillInput(&inputs[i], block)) {
+			status = SPILL_IO;
+			break;
+		}
+		heap[heapSize++] = i;
+	}
+	for (size_t pos = heapSize / 2; status == SPILL_OK && pos-- > 0; )
+		siftHeads(heap, heapSize, pos, inputs);
+
+	long double* output = buffers + block * n;
+	size_t outSize = 0;
+	while (status == SPILL_OK && heapSize > 0) {
+		struct mergeInput* in = &inputs[heap[0]];
+		output[outSize++] = in->buf[in->at++];
+		if (outSize == block) {
+			visit(ctx, output, outSize);
+			outSize = 0;
+		}
+
+		if (in->at == in->size) {
+			if (in->left == 0) // run done
+				heap[0] = heap[--heapSize];
+			else if (!fillInput(in, block))
+				status = SPILL_IO;
+		}
+		siftHeads(heap, heapSize, 0, inputs);
+	}
+	if (status == SPILL_OK && outSize > 0)
+		visit(ctx, output, outSize);
+
+	free(inputs);
+	free(heap);
+	free(buffers);
+	return status;
+}
+
+static void writeRun(void* ctx, const long double a[], size_t size) {
+	struct runWriter* w = (struct runWriter*)ctx;
+	if (w->ok)
+		w->ok = fwrite(a, sizeof(long double), size, w->out) == size;
+}
+
+/*!	 \fn mergeRuns
+	 \return SPILL_OK, SPILL_NOMEM or SPILL_IO
+	 \param struct spill* s, size_t memory - bytes for the buffers, spillVisitor visit, void* ctx
+
+	 Hand all the numbers of the runs to visit in ascending order. Runs that do not fit in the memory
+	 at once are merged into fewer, longer runs first. */
+enum spillStatus mergeRuns(struct spill* s, size_t memory, spillVisitor visit, void* ctx) {
+	size_t fanIn = memory / (sizeof(long double) * MERGE_BLOCK);
+	fanIn = fanIn > 3 ? fanIn - 1 : 2; // and the output buffer
+
+	while (s->numRuns > fanIn) {
+		struct runWriter w;
+		size_t size = 0;
+
+		if ((w.out = openTemporary()) == NULL)
+			return SPILL_IO;
+		w.ok = true;
+		enum spillStatus status = mergeGroup(s->runs, s->runSizes, fanIn, memory, writeRun, &w);
+		if (status == SPILL_OK && (!w.ok || fflush(w.out) != 0))
+			status = SPILL_IO;
+		if (status != SPILL_OK) {
+			int error = errno;
+			fclose(w.out);
+			errno = error;
+			return status;
+		}
+
+		// the merged runs are replaced by the longer one
+		for (size_t i = 0; i < fanIn; i++) {
+			fclose(s->runs[i]);
+			size += s->runSizes[i];
+		}
+		s->numRuns -= fanIn;
+		s->count -= size;
+		memmove((void*)s->runs, (void*)(s->runs + fanIn), sizeof(FILE*) * s->numRuns);
+		memmove(s->runSizes, s->runSizes + fanIn, sizeof(size_t) * s->numRuns);
+		if (!addRun(s, w.out, size)) { // there is room, fanIn runs just left
+			fclose(w.out);
+			return SPILL_NOMEM;
+		}
+	}
+	return mergeGroup(s->runs, s->runSizes, s->numRuns, memory, visit, ctx);
+}
@@ -0,0 +1,41 @@
+/*!	\file		nbstats_spill.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Numbers beyond the memory budget: sorted runs in temporary files, merged back in ascending order
+	(k-way merge) when the order statistics are taken.
+*/
+#ifndef NBSTATS_SPILL_H
+#define NBSTATS_SPILL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// sorted runs, each in its own temporary file (removed when closed)
+struct spill {
+	FILE** runs;
+	size_t* runSizes;		// numbers in each run
+	size_t numRuns;
+	size_t runsCapacity;
+	size_t count;			// numbers in all runs
+};
+
+// receives the numbers of the runs, a block at a time
+typedef void (*spillVisitor)(void* ctx, const long double a[], size_t size);
+
+// spill results
+enum spillStatus {
+	SPILL_OK,
+	SPILL_NOMEM,
+	SPILL_IO				// errno is set
+};
+
+void initSpill(struct spill* s);
+void freeSpill(struct spill* s);
+enum spillStatus spillRun(struct spill* s, long double a[], size_t size);
+enum spillStatus readRuns(const struct spill* s, size_t memory, spillVisitor visit, void* ctx);
+enum spillStatus mergeRuns(struct spill* s, size_t memory, spillVisitor visit, void* ctx);
+
+#endif
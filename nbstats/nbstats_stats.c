@@ -0,0 +1,212 @@
+/*!	\file		nbstats_stats.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Partial statistics: count, sum, sum of squares, range and leading digit counts (and the forensic digit tests),
+	gathered in one cache-blocked pass, and the Newcomb-Benford variance of the digit counts.
+*/
+#include "nbstats_stats.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "nbstats_digits.h"
+
+#define BLOCK_SIZE	2048	// numbers per block, 32 KB (double) to 64 KB (long double)
+
+/*!	 \fn initPartial
+	 \return none
+	 \param struct partial* p
+
+	 Empty partial */
+void initPartial(struct partial* p) {
+	memset(p, 0, sizeof(*p));
+}
+
+/*!	 \fn addSum
+	 \return none
+	 \param long double* sum, long double* compensation, long double x
+
+	 sum += x, keeping what the addition rounds off (Neumaier) */
+static inline void addSum(long double* sum, long double* compensation, long double x) {
+	long double t = *sum + x;
+	if (fabsl(*sum) >= fabsl(x))
+		*compensation += (*sum - t) + x;
+	else
+		*compensation += (x - t) + *sum;
+	*sum = t;
+}
+
+/*!	 \fn addBlock
+	 \return none
+	 \param struct partial* p, const long double a[] - block of numbers,
+			const unsigned char digits[] - their leading digits, NULL to find them, size_t size - at most BLOCK_SIZE
+
+	 Sum, range and leading digits in the first pass, squares around the block mean in the second pass
+	 while the block is still in cache, then merge into p */
+static void addBlock(struct partial* p, const long double a[], const unsigned char digits[], size_t size) {
+	struct partial part;
+	long double sum = 0;
+	long double compensation = 0;
+	long double min = a[0];
+	long double max = a[0];
+
+	initPartial(&part);
+	for (size_t i = 0; i < size; i++) {
+		long double x = a[i];
+		addSum(&sum, &compensation, x);
+		min = x < min ? x : min;
+		max = x > max ? x : max;
+	}
+	if (digits != NULL) {
+		for (size_t i = 0; i < size; i++)
+			part.fre[digits[i] - 1]++;
+	}
+	else {
+		countLeadingDigits(a, size, part.fre);
+	}
+
+	long double mean = (sum + compensation) / size;
+	long double m2 = 0;
+	long double shift = 0; // sum of the differences, 0 if mean were exact (corrected two pass)
+	for (size_t i = 0; i < size; i++) {
+		long double d = a[i] - mean;
+		m2 += d * d;
+		shift += d;
+	}
+
+	part.count = size;
+	part.sum = sum;
+	part.compensation = compensation;
+	part.m2 = m2 - shift * shift / size;
+	part.min = min;
+	part.max = max;
+	mergePartial(p, &part);
+}
+
+/*!	 \fn addPartial
+	 \return none
+	 \param struct partial* p, const long double a[] - numbers array, size_t size - how many numbers in array
+
+	 Add the statistics of a[] to p, one trip through memory
+	 \note a[] is taken in blocks of BLOCK_SIZE numbers, each block is read twice while in cache
+		   (sum, range, digits, then the squares around its mean) and merged with mergePartial,
+		   so the result is as exact as the two pass variance of the whole array. */
+void addPartial(struct partial* p, const long double a[], size_t size) {
+	for (size_t start = 0; start < size; start += BLOCK_SIZE) {
+		size_t n = size - start < BLOCK_SIZE ? size - start : BLOCK_SIZE;
+		addBlock(p, a + start, NULL, n);
+	}
+}
+
+/*!	 \fn addPartialTests
+	 \return none
+	 \param struct partial* p, struct digitTests* tests, const long double a[] - numbers array, size_t size
+
+	 addPartial that also counts the forensic digit tests of every block while it is in cache */
+void addPartialTests(struct partial* p, struct digitTests* tests, const long double a[], size_t size) {
+	for (size_t start = 0; start < size; start += BLOCK_SIZE) {
+		size_t n = size - start < BLOCK_SIZE ? size - start : BLOCK_SIZE;
+		addBlock(p, a + start, NULL, n);
+		addDigitTests(tests, a + start, n);
+	}
+}
+
+/*!	 \fn addPartialDigits
+	 \return none
+	 \param struct partial* p, const long double a[] - numbers array,
+			const unsigned char digits[] - leading digit (1 ~ 9) of each number, size_t size - how many numbers in array
+
+	 addPartial for numbers whose leading digits are known already (.nbc files) */
+void addPartialDigits(struct partial* p, const long double a[], const unsigned char digits[], size_t size) {
+	for (size_t start = 0; start < size; start += BLOCK_SIZE) {
+		size_t n = size - start < BLOCK_SIZE ? size - start : BLOCK_SIZE;
+		addBlock(p, a + start, digits + start, n);
+	}
+}
+
+/*!	 \fn addValue
+	 \return none
+	 \param struct partial* p, long double x - positive number
+
+	 Add a single number (Welford), for numbers that come one at a time into many partials
+	 (grouped analysis). A whole array is faster and as exact with addPartial. */
+void addValue(struct partial* p, long double x) {
+	if (p->count == 0) {
+		p->min = x;
+		p->max = x;
+	}
+	else {
+		p->min = x < p->min ? x : p->min;
+		p->max = x > p->max ? x : p->max;
+	}
+
+	long double before = p->count == 0 ? x : partialMean(p);
+	addSum(&p->sum, &p->compensation, x);
+	p->count++;
+	p->m2 += (x - before) * (x - partialMean(p));
+	p->fre[fastLeadingDigit(x) - 1]++;
+}
+
+/*!	 \fn mergePartial
+	 \return none
+	 \param struct partial* dst, const struct partial* src
+
+	 Combine two partials (Chan et al. parallel variance) */
+void mergePartial(struct partial* dst, const struct partial* src) {
+	if (src->count == 0)
+		return;
+	if (dst->count == 0) {
+		*dst = *src;
+		return;
+	}
+
+	long double n = (long double)dst->count + (long double)src->count;
+	long double delta = partialMean(src) - partialMean(dst);
+
+	dst->m2 += src->m2 + delta * delta * ((long double)dst->count * (long double)src->count / n);
+	addSum(&dst->sum, &dst->compensation, src->sum);
+	dst->compensation += src->compensation;
+	dst->count += src->count;
+	if (src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+	for (int i = 0; i < 9; i++)
+		dst->fre[i] += src->fre[i];
+}
+
+/*!	 \fn partialMean
+	 \return arithmetic mean
+	 \param const struct partial* p - not empty
+
+	 Mean of the compensated sum */
+long double partialMean(const struct partial* p) {
+	return (p->sum + p->compensation) / p->count;
+}
+
+/*!	 \fn calFrequencies
+	 \return none
+	 \param const long int fre[9] - raw frequency, size_t count - # elements, double expected[9], double actual[9]
+
+	 Calculate expected frequencies , actual frequencies from the raw frequency */
+void calFrequencies(const long int fre[9], size_t count, double expected[9], double actual[9]) {
+	for (size_t i = 0; i < 9; i++) {
+		expected[i] = (log10((i + 1) + 1) - log10(i + 1)) * 100;
+		actual[i] = (double)fre[i] / (double)count * 100;
+	}
+}
+
+/*!	 \fn calNBVariance
+	 \return NB Variance, the NB Deviation is its square root
+	 \param const double expected[9], const double actual[9] - frequencies (%)
+
+	 Mean squared relative difference of the actual from the expected frequencies */
+long double calNBVariance(const double expected[9], const double actual[9]) {
+	long double variance = 0;
+	for (int i = 0; i < 9; i++) {
+		variance += pow((actual[i] / expected[i] - 1), 2);
+	}
+	return variance / 9;
+}
@@ -0,0 +1,36 @@
+/*!	\file		nbstats_stats.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Partial statistics of a part of the data set.
+	Partials of separate parts (one per ingestion thread) merge into the statistics of the whole set.
+*/
+#ifndef NBSTATS_STATS_H
+#define NBSTATS_STATS_H
+
+#include <stddef.h>
+
+struct digitTests;
+
+struct partial {
+	size_t count;
+	long double sum;
+	long double compensation;	// low order part of sum lost in the additions (Neumaier)
+	long double m2;			// sum of squares of the differences from the mean
+	long double min;
+	long double max;
+	long int fre[9];		// raw frequency of the leading digits 1 ~ 9
+};
+
+void initPartial(struct partial* p);
+void addPartial(struct partial* p, const long double a[], size_t size);
+void addPartialTests(struct partial* p, struct digitTests* tests, const long double a[], size_t size);
+void addPartialDigits(struct partial* p, const long double a[], const unsigned char digits[], size_t size);
+void addValue(struct partial* p, long double x);
+void mergePartial(struct partial* dst, const struct partial* src);
+long double partialMean(const struct partial* p);
+void calFrequencies(const long int fre[9], size_t count, double expected[9], double actual[9]);
+long double calNBVariance(const double expected[9], const double actual[9]);
+
+#endif
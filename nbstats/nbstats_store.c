@@ -0,0 +1,232 @@
+/*!	\file		nbstats_store.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Kept numbers in their storage type. Numbers are rounded to nearest when they are stored, those beyond the
+	normal range of the type are clamped to it (they keep their order, not their value). Within the range
+	a stored number is off by at most 2^-53 (double) or 2^-24 (float) of its value, and so are median and
+	percentiles; numbers closer than that to each other count as one value for the mode.
+	The kernels for each type are the ones of nbstats_sort.inc and nbstats_mode.inc.
+*/
+#include "nbstats_store.h"
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_sort.h"
+
+#define INITIAL_STORE	1024
+#define VISIT_BLOCK		2048		// numbers widened at a time for a visitor
+
+/*!	 \fn valueSize
+	 \return bytes of one stored number
+	 \param enum nb_precision type */
+static size_t valueSize(enum nb_precision type) {
+	switch (type) {
+	case NB_PRECISION_DOUBLE:
+		return sizeof(double);
+	case NB_PRECISION_FLOAT:
+		return sizeof(float);
+	default:
+		return sizeof(long double);
+	}
+}
+
+static inline double toDouble(long double x) {
+	if (x > DBL_MAX)
+		return DBL_MAX;
+	if (x < DBL_MIN)
+		return DBL_MIN;
+	return (double)x;
+}
+
+static inline float toFloat(long double x) {
+	if (x > FLT_MAX)
+		return FLT_MAX;
+	if (x < FLT_MIN)
+		return FLT_MIN;
+	return (float)x;
+}
+
+/*!	 \fn initStore
+	 \return none
+	 \param struct valueStore* s, enum nb_precision type */
+void initStore(struct valueStore* s, enum nb_precision type) {
+	memset(s, 0, sizeof(*s));
+	s->type = type == NB_PRECISION_DOUBLE || type == NB_PRECISION_FLOAT ? type : NB_PRECISION_LD;
+}
+
+/*!	 \fn freeStore
+	 \return none
+	 \param struct valueStore* s */
+void freeStore(struct valueStore* s) {
+	free(s->values);
+	s->values = NULL;
+	s->size = 0;
+	s->capacity = 0;
+}
+
+/*!	 \fn reserveStore
+	 \return false if out of memory
+	 \param struct valueStore* s, size_t size - numbers it has to hold */
+bool reserveStore(struct valueStore* s, size_t size) {
+	if (size <= s->capacity)
+		return true;
+
+	size_t capacity = s->capacity == 0 ? INITIAL_STORE : s->capacity;
+	while (capacity < size)
+		capacity *= 2;
+	void* valuesMore = realloc(s->values, valueSize(s->type) * capacity);
+	if (valuesMore == NULL)
+		return false;
+	s->values = valuesMore;
+	s->capacity = capacity;
+	return true;
+}
+
+/*!	 \fn appendStore
+	 \return false if out of memory
+	 \param struct valueStore* s, const long double a[], size_t size
+
+	 Store numbers, rounded to the storage type */
+bool appendStore(struct valueStore* s, const long double a[], size_t size) {
+	if (size == 0)
+		return true;
+	if (s->size + size > s->capacity && !reserveStore(s, s->size + size))
+		return false;
+
+	switch (s->type) {
+	case NB_PRECISION_DOUBLE: {
+		double* to = (double*)s->values + s->size;
+		for (size_t i = 0; i < size; i++)
+			to[i] = toDouble(a[i]);
+		break;
+	}
+	case NB_PRECISION_FLOAT: {
+		float* to = (float*)s->values + s->size;
+		for (size_t i = 0; i < size; i++)
+			to[i] = toFloat(a[i]);
+		break;
+	}
+	default:
+		memcpy((long double*)s->values + s->size, a, sizeof(long double) * size);
+		break;
+	}
+	s->size += size;
+	return true;
+}
+
+/*!	 \fn adoptStore
+	 \return false if out of memory, a[] is freed anyway
+	 \param struct valueStore* s, long double* a - numbers of malloc, size_t size
+
+	 Store a whole array of numbers. The array becomes the store when the store is empty, narrowed
+	 in place (every number moves to a lower address than the ones still to be read) and shrunk. */
+bool adoptStore(struct valueStore* s, long double* a, size_t size) {
+	if (s->size > 0 || size == 0) {
+		bool ok = appendStore(s, a, size);
+		free(a);
+		return ok;
+	}
+
+	if (s->type == NB_PRECISION_DOUBLE) {
+		for (size_t i = 0; i < size; i++) {
+			long double x = a[i];
+			((double*)a)[i] = toDouble(x);
+		}
+	}
+	else if (s->type == NB_PRECISION_FLOAT) {
+		for (size_t i = 0; i < size; i++) {
+			long double x = a[i];
+			((float*)a)[i] = toFloat(x);
+		}
+	}
+	void* shrunk = realloc(a, valueSize(s->type) * size);
+	free(s->values);
+	s->values = shrunk != NULL ? shrunk : a;
+	s->size = size;
+	s->capacity = size;
+	return true;
+}
+
+/*!	 \fn storeBytes
+	 \return bytes of the stored numbers
+	 \param const struct valueStore* s */
+size_t storeBytes(const struct valueStore* s) {
+	return s->size * valueSize(s->type);
+}
+
+/*!	 \fn visitStore
+	 \return none
+	 \param const struct valueStore* s, storeVisitor visit, void* ctx
+
+	 Hand the stored numbers to visit as long double, all at once if that is how they are stored */
+void visitStore(const struct valueStore* s, storeVisitor visit, void* ctx) {
+	long double widened[VISIT_BLOCK];
+
+	if (s->type == NB_PRECISION_LD) {
+		visit(ctx, (const long double*)s->values, s->size);
+		return;
+	}
+	for (size_t at = 0; at < s->size; at += VISIT_BLOCK) {
+		size_t n = s->size - at < VISIT_BLOCK ? s->size - at : VISIT_BLOCK;
+		if (s->type == NB_PRECISION_DOUBLE) {
+			for (size_t i = 0; i < n; i++)
+				widened[i] = ((const double*)s->values)[at + i];
+		}
+		else {
+			for (size_t i = 0; i < n; i++)
+				widened[i] = ((const float*)s->values)[at + i];
+		}
+		visit(ctx, widened, n);
+	}
+}
+
+/*!	 \fn storeModes
+	 \return false if out of memory
+	 \param struct valueStore* s, struct modes* out */
+bool storeModes(struct valueStore* s, struct modes* out) {
+	switch (s->type) {
+	case NB_PRECISION_DOUBLE:
+		return findModesDouble((const double*)s->values, s->size, out);
+	case NB_PRECISION_FLOAT:
+		return findModesFloat((const float*)s->values, s->size, out);
+	default:
+		return findModes((const long double*)s->values, s->size, out);
+	}
+}
+
+/*!	 \fn storeMedian
+	 \return median of the stored numbers
+	 \param struct valueStore* s - not empty, rearranged */
+long double storeMedian(struct valueStore* s) {
+	switch (s->type) {
+	case NB_PRECISION_DOUBLE:
+		return calStatisticalMedianDouble((double*)s->values, s->size);
+	case NB_PRECISION_FLOAT:
+		return calStatisticalMedianFloat((float*)s->values, s->size);
+	default:
+		return calStatisticalMedian((long double*)s->values, s->size);
+	}
+}
+
+/*!	 \fn storeRanks
+	 \return none
+	 \param struct valueStore* s - rearranged, const size_t index[] - ascending, below the size, size_t n, long double out[]
+
+	 The stored numbers at index[] in sorted order */
+void storeRanks(struct valueStore* s, const size_t index[], size_t n, long double out[]) {
+	switch (s->type) {
+	case NB_PRECISION_DOUBLE:
+		selectRanksDouble((double*)s->values, s->size, index, n, out);
+		break;
+	case NB_PRECISION_FLOAT:
+		selectRanksFloat((float*)s->values, s->size, index, n, out);
+		break;
+	default:
+		selectRanks((long double*)s->values, s->size, index, n, out);
+		break;
+	}
+}
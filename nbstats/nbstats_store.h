@@ -0,0 +1,41 @@
+/*!	\file		nbstats_store.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	The kept numbers, from which median, mode and percentiles are taken, stored as long double, double or float
+	(config.precision). The other statistics are added up from the long double numbers before they are stored,
+	so only the order statistics see the storage type. Double and float halve or quarter the memory and the
+	bandwidth of selection and counting where long double takes 16 bytes.
+*/
+#ifndef NBSTATS_STORE_H
+#define NBSTATS_STORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nbstats.h"
+#include "nbstats_mode.h"
+
+struct valueStore {
+	enum nb_precision type;
+	void* values;				// long double*, double* or float*
+	size_t size;
+	size_t capacity;
+};
+
+// receives stored numbers widened to long double, a block at a time
+typedef void (*storeVisitor)(void* ctx, const long double a[], size_t size);
+
+void initStore(struct valueStore* s, enum nb_precision type);
+void freeStore(struct valueStore* s);
+bool reserveStore(struct valueStore* s, size_t size);
+bool appendStore(struct valueStore* s, const long double a[], size_t size);
+bool adoptStore(struct valueStore* s, long double* a, size_t size);
+size_t storeBytes(const struct valueStore* s);
+void visitStore(const struct valueStore* s, storeVisitor visit, void* ctx);
+bool storeModes(struct valueStore* s, struct modes* out);
+long double storeMedian(struct valueStore* s);
+void storeRanks(struct valueStore* s, const size_t index[], size_t n, long double out[]);
+
+#endif
@@ -0,0 +1,441 @@
+/*!	\file		nbstats_summary.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Writing and reading .nbs summary files. Like .nbc files, a build writes its long double when that is
+	wider than double, and reads files of double values or of its own long double.
+	A summary is small, it is read into memory as a whole and checked before anything of it is used.
+*/
+#include "nbstats_summary.h"
+
+#include <errno.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define READ_BLOCK		(1 << 16)
+
+// sequential writes that stop at the first failure
+struct writer {
+	FILE* out;
+	bool native;				// reals as long double
+	bool ok;
+};
+
+// reads from a summary in memory
+struct reader {
+	const unsigned char* data;
+	size_t size;
+	size_t at;
+	bool native;
+};
+
+static void put(struct writer* w, const void* p, size_t size) {
+	if (w->ok)
+		w->ok = fwrite(p, 1, size, w->out) == size;
+}
+
+static void putU64(struct writer* w, uint64_t v) {
+	put(w, &v, sizeof(v));
+}
+
+static void putReal(struct writer* w, long double x) {
+	if (w->native) {
+		put(w, &x, sizeof(x));
+	}
+	else {
+		double d = (double)x;
+		put(w, &d, sizeof(d));
+	}
+}
+
+static void putSection(struct writer* w, const char* tag, uint64_t length) {
+	struct nbsSection section;
+
+	memset(&section, 0, sizeof(section));
+	memcpy(section.tag, tag, strlen(tag));
+	section.length = length;
+	put(w, &section, sizeof(section));
+}
+
+/*!	 \fn writeSummary
+	 \return false if the file could not be written (errno is set)
+	 \param const char* fileName, const struct partial* stats, const struct heavyHitters* hitters,
+			const struct kll* sketch - NULL: none
+
+	 Write the statistics, the heavy-hitters summary and the quantile sketch of a data set as a .nbs file */
+bool writeSummary(const char* fileName, const struct partial* stats, const struct heavyHitters* hitters, const struct kll* sketch) {
+	struct nbsHeader header;
+	struct writer w;
+	size_t realSize;
+
+	w.native = LDBL_MANT_DIG > DBL_MANT_DIG;
+	w.ok = true;
+	realSize = w.native ? sizeof(long double) : sizeof(double);
+#ifdef _WIN32
+	if (fopen_s(&w.out, fileName, "wb") != 0)
+		return false;
+#else
+	if ((w.out = fopen(fileName, "wb")) == NULL)
+		return false;
+#endif
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, NBS_MAGIC, sizeof(NBS_MAGIC));
+	header.version = NBS_VERSION;
+	header.byteOrder = NBS_BYTE_ORDER;
+	header.valueSize = (uint32_t)realSize;
+	header.mantissaDigits = w.native ? LDBL_MANT_DIG : DBL_MANT_DIG;
+	put(&w, &header, sizeof(header));
+
+	putSection(&w, NBS_TAG_STATS, 8 + 5 * realSize + 9 * 8);
+	putU64(&w, stats->count);
+	putReal(&w, stats->sum);
+	putReal(&w, stats->compensation);
+	putReal(&w, stats->m2);
+	putReal(&w, stats->min);
+	putReal(&w, stats->max);
+	for (int i = 0; i < 9; i++)
+		putU64(&w, (uint64_t)stats->fre[i]);
+
+	putSection(&w, NBS_TAG_HITTERS, 16 + hitters->size * (realSize + 16));
+	putU64(&w, heavyHitterBound(hitters));
+	putU64(&w, hitters->size);
+	for (size_t s = 0; s < hitters->size; s++) {
+		putReal(&w, hitters->slots[s].value);
+		putU64(&w, hitters->slots[s].count);
+		putU64(&w, hitters->slots[s].error);
+	}
+
+	if (sketch != NULL) {
+		uint64_t length = 16;
+		for (size_t h = 0; h < sketch->numLevels; h++)
+			length += 8 + sketch->levels[h].size * realSize;
+		putSection(&w, NBS_TAG_SKETCH, length);
+		putU64(&w, sketch->k);
+		putU64(&w, sketch->numLevels);
+		for (size_t h = 0; h < sketch->numLevels; h++) {
+			putU64(&w, sketch->levels[h].size);
+			for (size_t i = 0; i < sketch->levels[h].size; i++)
+				putReal(&w, sketch->levels[h].items[i]);
+		}
+	}
+
+	putSection(&w, NBS_TAG_END, 0);
+
+	if (fclose(w.out) != 0)
+		w.ok = false;
+	if (!w.ok) { // no partial file is left, keep the errno of the failure
+		int error = errno;
+		remove(fileName);
+		errno = error;
+	}
+	return w.ok;
+}
+
+static bool take(struct reader* r, void* p, size_t size) {
+	if (r->size - r->at < size)
+		return false;
+	memcpy(p, r->data + r->at, size);
+	r->at += size;
+	return true;
+}
+
+static bool takeCount(struct reader* r, size_t* v) {
+	uint64_t u;
+	if (!take(r, &u, sizeof(u)) || u > SIZE_MAX)
+		return false;
+	*v = (size_t)u;
+	return true;
+}
+
+static bool takeReal(struct reader* r, long double* x) {
+	if (r->native)
+		return take(r, x, sizeof(*x));
+
+	double d;
+	if (!take(r, &d, sizeof(d)))
+		return false;
+	*x = d;
+	return true;
+}
+
+static inline bool isPositive(long double x) { return x > 0 && x <= LDBL_MAX; }
+
+/*!	 \fn readStats
+	 \return false if the section is damaged
+	 \param struct reader* r - at the section contents, struct partial* p */
+static bool readStats(struct reader* r, struct partial* p) {
+	size_t total = 0;
+
+	initPartial(p);
+	if (!takeCount(r, &p->count) || !takeReal(r, &p->sum) || !takeReal(r, &p->compensation) || !takeReal(r, &p->m2)
+		|| !takeReal(r, &p->min) || !takeReal(r, &p->max))
+		return false;
+	for (int i = 0; i < 9; i++) {
+		size_t fre;
+		if (!takeCount(r, &fre) || fre > p->count - total)
+			return false;
+		p->fre[i] = (long int)fre;
+		total += fre;
+	}
+	if (total != p->count)
+		return false;
+	if (p->count == 0) {
+		initPartial(p);
+		return true;
+	}
+	return isPositive(p->min) && isPositive(p->max) && p->min <= p->max && p->sum > 0 && p->m2 >= 0
+		&& p->compensation == p->compensation; // not nan
+}
+
+static int compareValues(const void* a, const void* b) {
+	long double x = ((const struct heavyHitter*)a)->value;
+	long double y = ((const struct heavyHitter*)b)->value;
+	return x < y ? -1 : x > y;
+}
+
+/*!	 \fn readHitters
+	 \return SUMMARY_OK, SUMMARY_NOMEM or SUMMARY_FORMAT
+	 \param struct reader* r - at the section contents, size_t length - of the section, struct summary* s */
+static enum summaryStatus readHitters(struct reader* r, size_t length, struct summary* s) {
+	size_t entrySize = (r->native ? sizeof(long double) : sizeof(double)) + 16;
+	size_t size;
+
+	if (!takeCount(r, &s->bound) || !takeCount(r, &size))
+		return SUMMARY_FORMAT;
+	if (length < 16 || size != (length - 16) / entrySize || (length - 16) % entrySize != 0)
+		return SUMMARY_FORMAT;
+	if (size == 0)
+		return SUMMARY_OK;
+
+	s->hitters = (struct heavyHitter*)malloc(sizeof(struct heavyHitter) * size);
+	if (s->hitters == NULL)
+		return SUMMARY_NOMEM;
+	for (size_t i = 0; i < size; i++) {
+		struct heavyHitter* h = &s->hitters[i];
+		h->heapPos = 0;
+		if (!takeReal(r, &h->value) || !takeCount(r, &h->count) || !takeCount(r, &h->error))
+			return SUMMARY_FORMAT;
+	}
+	s->numHitters = size;
+
+	// every value once
+	qsort(s->hitters, size, sizeof(struct heavyHitter), compareValues);
+	for (size_t i = 1; i < size; i++) {
+		if (!(s->hitters[i - 1].value < s->hitters[i].value))
+			return SUMMARY_FORMAT;
+	}
+	return SUMMARY_OK;
+}
+
+/*!	 \fn readSketch
+	 \return SUMMARY_OK, SUMMARY_NOMEM or SUMMARY_FORMAT
+	 \param struct reader* r - at the section contents, size_t count - numbers of the summary, struct summary* s
+
+	 The levels must hold exactly count numbers between them */
+static enum summaryStatus readSketch(struct reader* r, size_t count, struct summary* s) {
+	size_t k;
+	size_t numLevels;
+	size_t left = count;
+	long double* items = NULL;
+	size_t itemsSize = 0;
+
+	if (!takeCount(r, &k) || !takeCount(r, &numLevels) || k < KLL_MIN_K || k > KLL_MAX_K || numLevels == 0 || numLevels > 64)
+		return SUMMARY_FORMAT;
+	if (!initKll(&s->sketch, k))
+		return SUMMARY_NOMEM;
+	s->hasSketch = true;
+
+	enum summaryStatus status = SUMMARY_OK;
+	for (size_t h = 0; status == SUMMARY_OK && h < numLevels; h++) {
+		size_t size;
+		if (!takeCount(r, &size) || size > (r->size - r->at) / 8 || size > (left >> h)) {
+			status = SUMMARY_FORMAT;
+			break;
+		}
+		if (size > itemsSize) {
+			long double* itemsMore = (long double*)realloc(items, sizeof(long double) * size);
+			if (itemsMore == NULL) {
+				status = SUMMARY_NOMEM;
+				break;
+			}
+			items = itemsMore;
+			itemsSize = size;
+		}
+		for (size_t i = 0; status == SUMMARY_OK && i < size; i++) {
+			if (!takeReal(r, &items[i]) || !isPositive(items[i]))
+				status = SUMMARY_FORMAT;
+		}
+		if (status == SUMMARY_OK && !addKllLevel(&s->sketch, h, items, size))
+			status = SUMMARY_NOMEM;
+		left -= size << h;
+	}
+	free(items);
+	if (status == SUMMARY_OK && left != 0)
+		status = SUMMARY_FORMAT;
+	return status;
+}
+
+/*!	 \fn checkSummary
+	 \return false if the parts of the summary do not fit together
+	 \param const struct summary* s
+
+	 No count of a summary can be larger than the count of its data set */
+static bool checkSummary(const struct summary* s) {
+	if (s->bound > s->stats.count)
+		return false;
+	for (size_t i = 0; i < s->numHitters; i++) {
+		const struct heavyHitter* h = &s->hitters[i];
+		if (!isPositive(h->value) || h->count == 0 || h->count > s->stats.count || h->error > h->count)
+			return false;
+	}
+	return true;
+}
+
+/*!	 \fn readFile
+	 \return SUMMARY_OK, SUMMARY_NOMEM or SUMMARY_IO
+	 \param const char* fileName, unsigned char** data, size_t* size - whole file, to be freed */
+static enum summaryStatus readFile(const char* fileName, unsigned char** data, size_t* size) {
+	size_t capacity = READ_BLOCK;
+	size_t got = 0;
+	unsigned char* buf;
+
+	FILE* in;
+#ifdef _WIN32
+	if (fopen_s(&in, fileName, "rb") != 0)
+		return SUMMARY_IO;
+#else
+	if ((in = fopen(fileName, "rb")) == NULL)
+		return SUMMARY_IO;
+#endif
+
+	if ((buf = (unsigned char*)malloc(capacity)) == NULL) {
+		fclose(in);
+		return SUMMARY_NOMEM;
+	}
+	for (;;) {
+		if (got == capacity) {
+			unsigned char* bufDouble = (unsigned char*)realloc(buf, capacity * 2);
+			if (bufDouble == NULL) {
+				free(buf);
+				fclose(in);
+				return SUMMARY_NOMEM;
+			}
+			buf = bufDouble;
+			capacity *= 2;
+		}
+		size_t n = fread(buf + got, 1, capacity - got, in);
+		if (n == 0)
+			break;
+		got += n;
+	}
+	if (ferror(in)) {
+		int error = errno;
+		free(buf);
+		fclose(in);
+		errno = error;
+		return SUMMARY_IO;
+	}
+	fclose(in);
+
+	*data = buf;
+	*size = got;
+	return SUMMARY_OK;
+}
+
+/*!	 \fn parseSummary
+	 \return SUMMARY_OK, SUMMARY_NOMEM or SUMMARY_FORMAT
+	 \param struct reader* r - whole file, struct summary* out */
+static enum summaryStatus parseSummary(struct reader* r, struct summary* out) {
+	struct nbsHeader header;
+	bool hasStats = false;
+	bool hasHitters = false;
+	bool ended = false;
+
+	if (!take(r, &header, sizeof(header)) || memcmp(header.magic, NBS_MAGIC, sizeof(NBS_MAGIC)) != 0
+		|| header.version != NBS_VERSION || header.byteOrder != NBS_BYTE_ORDER)
+		return SUMMARY_FORMAT;
+	if (header.valueSize == sizeof(long double) && header.mantissaDigits == LDBL_MANT_DIG)
+		r->native = true;
+	else if (header.valueSize == sizeof(double) && header.mantissaDigits == DBL_MANT_DIG)
+		r->native = false;
+	else
+		return SUMMARY_FORMAT;
+
+	while (!ended) {
+		struct nbsSection section;
+		if (!take(r, &section, sizeof(section)) || section.length > r->size - r->at)
+			return SUMMARY_FORMAT;
+		size_t length = (size_t)section.length;
+		size_t end = r->at + length;
+
+		if (memcmp(section.tag, NBS_TAG_SKETCH, 4) == 0) {
+			if (!hasStats || out->hasSketch)
+				return SUMMARY_FORMAT;
+			enum summaryStatus status = readSketch(r, out->stats.count, out);
+			if (status != SUMMARY_OK)
+				return status;
+		}
+		else if (memcmp(section.tag, NBS_TAG_STATS, 4) == 0) {
+			if (hasStats || !readStats(r, &out->stats))
+				return SUMMARY_FORMAT;
+			hasStats = true;
+		}
+		else if (memcmp(section.tag, NBS_TAG_HITTERS, 4) == 0) {
+			if (hasHitters)
+				return SUMMARY_FORMAT;
+			enum summaryStatus status = readHitters(r, length, out);
+			if (status != SUMMARY_OK)
+				return status;
+			hasHitters = true;
+		}
+		else if (memcmp(section.tag, NBS_TAG_END, 4) == 0) {
+			ended = true;
+		}
+		if (r->at > end) // a known section longer than its length
+			return SUMMARY_FORMAT;
+		r->at = end; // unknown sections are skipped
+	}
+	if (!hasStats || r->at != r->size)
+		return SUMMARY_FORMAT;
+	if (!hasHitters)
+		out->bound = out->stats.count;
+	return checkSummary(out) ? SUMMARY_OK : SUMMARY_FORMAT;
+}
+
+/*!	 \fn readSummary
+	 \return SUMMARY_OK, SUMMARY_NOMEM, SUMMARY_IO or SUMMARY_FORMAT
+	 \param const char* fileName, struct summary* out - to be released with freeSummary, also after a failure
+
+	 Read and check a .nbs file. A summary without heavy hitters is taken as one that tracks no value. */
+enum summaryStatus readSummary(const char* fileName, struct summary* out) {
+	struct reader r;
+	unsigned char* data = NULL;
+
+	memset(out, 0, sizeof(*out));
+	initPartial(&out->stats);
+
+	enum summaryStatus status = readFile(fileName, &data, &r.size);
+	if (status != SUMMARY_OK)
+		return status;
+	r.data = data;
+	r.at = 0;
+	status = parseSummary(&r, out);
+	free(data);
+	return status;
+}
+
+/*!	 \fn freeSummary
+	 \return none
+	 \param struct summary* s */
+void freeSummary(struct summary* s) {
+	free(s->hitters);
+	s->hitters = NULL;
+	s->numHitters = 0;
+	if (s->hasSketch)
+		freeKll(&s->sketch);
+	s->hasSketch = false;
+}
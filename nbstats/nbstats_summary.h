@@ -0,0 +1,75 @@
+/*!	\file		nbstats_summary.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	.nbs summary file: everything a streaming analysis keeps of a data set (count, compensated moments,
+	range, leading digits, the heavy-hitters summary and the quantile sketch), in a few hundred kilobytes at most.
+	Summaries of parts of a data set merge into the summary of the whole, in any order.
+
+	offset 0		struct nbsHeader (32 bytes)
+	then			sections, each a struct nbsSection (16 bytes) and length bytes,
+					a reader skips the sections it does not know
+	last			section NBS_TAG_END of length 0
+
+	Reals are 8 bytes (IEEE double) or the long double of the writing build, as in .nbc files.
+*/
+#ifndef NBSTATS_SUMMARY_H
+#define NBSTATS_SUMMARY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nbstats_mode.h"
+#include "nbstats_quantile.h"
+#include "nbstats_stats.h"
+
+#define NBS_MAGIC		"NBSUMRY"		// 8 bytes with the terminating null
+#define NBS_VERSION		1
+#define NBS_BYTE_ORDER	0x01020304u
+
+// sections
+#define NBS_TAG_STATS	"STAT"	// u64 count, reals sum, compensation, m2, min, max, i64 fre[9]
+#define NBS_TAG_HITTERS	"HHIT"	// u64 bound, u64 size, size * (real value, u64 count, u64 error)
+#define NBS_TAG_SKETCH	"KLLS"	// after STAT: u64 k, u64 levels, per level u64 size and size reals
+#define NBS_TAG_END		"END"
+
+struct nbsHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t valueSize;			// 8, or sizeof(long double)
+	uint32_t mantissaDigits;	// 53 (double), or LDBL_MANT_DIG
+	uint8_t padding[8];
+};
+
+struct nbsSection {
+	char tag[4];
+	uint32_t reserved;
+	uint64_t length;			// bytes after this header
+};
+
+// contents of a summary file
+struct summary {
+	struct partial stats;
+	struct heavyHitter* hitters;	// tracked values, NULL if size is 0
+	size_t numHitters;
+	size_t bound;				// values not in hitters occur at most this often
+	bool hasSketch;
+	struct kll sketch;			// quantile sketch, if hasSketch
+};
+
+// readSummary results
+enum summaryStatus {
+	SUMMARY_OK,
+	SUMMARY_NOMEM,
+	SUMMARY_IO,					// errno is set
+	SUMMARY_FORMAT				// damaged, or a long double this build does not have
+};
+
+bool writeSummary(const char* fileName, const struct partial* stats, const struct heavyHitters* hitters, const struct kll* sketch);
+enum summaryStatus readSummary(const char* fileName, struct summary* out);
+void freeSummary(struct summary* s);
+
+#endif
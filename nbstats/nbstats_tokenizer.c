@@ -0,0 +1,355 @@
+/*!	\file		nbstats_tokenizer.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	In-place tokenizer for white-space separated numbers.
+	Tokens are located and parsed directly in the input buffer (a mapped file or a large block of input),
+	nothing is copied except the rare token that needs the C library to be read.
+	The rules are the ones of the old fgetc loop in getNumbers:
+	- "-..."  negative number, rejected (not a number after '-' terminates the data set)
+	- "0..."  rejected unless it reads as a positive number (0.5, 00012)
+	- "1..9"  digits and '.' up to the first letter, the rest of the token is skipped
+	- other   accepted if it reads as a positive number (.5, +7), otherwise terminates the data set
+	readNumber reads one field of a table instead, the whole field has to be the number.
+*/
+#include "nbstats_tokenizer.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY	1024
+
+// powers of ten that are exact in double (and so in long double)
+static const long double pow10Exact[] = {
+	1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L,
+	1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L
+};
+
+static inline bool isSpaceCh(unsigned char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static inline bool isDigitCh(unsigned char c) { return (unsigned char)(c - '0') < 10; }
+static inline bool isAlphaCh(unsigned char c) { return (unsigned char)((c | 0x20) - 'a') < 26; }
+
+/*!	 \fn parseFast
+	 \return true if the token was read, false if it needs the C library
+	 \param const char* s, const char* e - token, long double* value
+
+	 Read [+]digits[.digits] without copying the token.
+	 Only mantissas up to 2^53 scaled by an exact power of ten are read here, for those one
+	 division is correctly rounded and gives the same value as sscanf "%Lf". */
+static bool parseFast(const char* s, const char* e, long double* value) {
+	const char* p = s;
+	unsigned long long mantissa = 0;
+	int digits = 0;		// significant digits
+	int scale = 0;		// digits after the decimal point
+	bool any = false;
+	bool point = false;
+
+	if (p < e && *p == '+')
+		p++;
+
+	for (; p < e; p++) {
+		unsigned char d = (unsigned char)(*p - '0');
+		if (d < 10) {
+			any = true;
+			if (point)
+				scale++;
+			if (mantissa == 0 && d == 0) // leading zero
+				continue;
+			if (++digits > 19)
+				return false;
+			mantissa = mantissa * 10 + d;
+		}
+		else if (*p == '.' && !point) {
+			point = true;
+		}
+		else {
+			break;
+		}
+	}
+
+	// exponent or hex notation, inf, nan ... are left to strtold
+	if (!any || (p < e && (*p == 'e' || *p == 'E' || *p == 'x' || *p == 'X')))
+		return false;
+	if (mantissa > (1ULL << 53) || scale > 22)
+		return false;
+
+	*value = (long double)mantissa / pow10Exact[scale];
+	return true;
+}
+
+/*!	 \fn parseSlow
+	 \return false if out of memory
+	 \param const char* s, size_t len - token, long double* value, double* check - atof of the token
+
+	 Read a token with the C library, the token is copied because the input is not null terminated */
+static bool parseSlow(const char* s, size_t len, long double* value, double* check) {
+	char local[64];
+	char* copy = len < sizeof(local) ? local : (char*)malloc(len + 1);
+	if (copy == NULL)
+		return false;
+
+	memcpy(copy, s, len);
+	copy[len] = '\0';
+	*check = strtod(copy, NULL);
+	*value = strtold(copy, NULL);
+
+	if (copy != local)
+		free(copy);
+	return true;
+}
+
+/*!	 \fn readToken
+	 \return false if out of memory
+	 \param const char* s, const char* e - token, long double* value, double* check - atof of the token
+
+	 Read a token as sscanf "%Lf" (value) and atof (check) did */
+static bool readToken(const char* s, const char* e, long double* value, double* check) {
+	if (parseFast(s, e, value)) {
+		*check = (double)*value;
+		return true;
+	}
+	return parseSlow(s, (size_t)(e - s), value, check);
+}
+
+/*!	 \fn pushValue
+	 \return false if out of memory
+	 \param struct tokenizer* t, long double value
+
+	 Append an accepted element, the array always keeps room for the 0 at the end */
+static bool pushValue(struct tokenizer* t, long double value) {
+	if (t->size + 1 == t->capacity) {
+		long double* valuesDouble = (long double*)realloc(t->values, sizeof(long double) * (t->capacity * 2));
+		if (valuesDouble == NULL)
+			return false;
+		t->values = valuesDouble;
+		t->capacity *= 2;
+	}
+	t->values[t->size++] = value;
+	t->values[t->size] = 0;
+	t->total++;
+	return true;
+}
+
+static void reject(struct tokenizer* t, enum rejectReason reason, const char* token, size_t length) {
+	if (t->onReject != NULL)
+		t->onReject(t->rejectCtx, reason, t->total, token, length);
+}
+
+/*!	 \fn initTokenizer
+	 \return false if out of memory
+	 \param struct tokenizer* t
+
+	 Prepare an empty tokenizer, rejections are not reported until onReject is set */
+bool initTokenizer(struct tokenizer* t) {
+	t->chInNum = false;
+	t->total = 0;
+	t->size = 0;
+	t->capacity = INITIAL_CAPACITY;
+	t->values = (long double*)malloc(sizeof(long double) * t->capacity);
+	t->onReject = NULL;
+	t->rejectCtx = NULL;
+
+	if (t->values == NULL)
+		return false;
+	t->values[0] = 0;
+	return true;
+}
+
+/*!	 \fn freeTokenizer
+	 \return none
+	 \param struct tokenizer* t
+
+	 Release the values array (unless the caller took it) */
+void freeTokenizer(struct tokenizer* t) {
+	free(t->values);
+	t->values = NULL;
+	t->size = 0;
+	t->capacity = 0;
+}
+
+/*!	 \fn scanNumbers
+	 \return TOKENIZER_OK, TOKENIZER_NOMEM or TOKENIZER_INVALID
+	 \param struct tokenizer* t, const char* buf, size_t len - input,
+			bool eof - no more input follows buf, size_t* used - bytes consumed
+
+	 Tokenize buf in place and append the accepted elements to t->values.
+	 Unless eof is set, a token touching the end of buf is not consumed, the caller passes it again
+	 in front of the next block. */
+int scanNumbers(struct tokenizer* t, const char* buf, size_t len, bool eof, size_t* used) {
+	const char* p = buf;
+	const char* end = buf + len;
+	int status = TOKENIZER_OK;
+
+	while (p < end) {
+		unsigned char ch = (unsigned char)*p;
+		const char* r;
+
+		if (isSpaceCh(ch)) { // white-space ends the skipping of a number with letters
+			t->chInNum = false;
+			p++;
+			continue;
+		}
+
+		if (ch == '-') { // reject the negative number
+			r = p + 1;
+			if (r < end && (isDigitCh((unsigned char)*r) || *r == '.')) {
+				while (r < end && (isDigitCh((unsigned char)*r) || *r == '.'))
+					r++;
+				if (r == end && !eof)
+					break;
+				reject(t, REJECT_NEGATIVE, p, (size_t)(r - p));
+				p = r < end ? r + 1 : r; // the character after the number is dropped
+				continue;
+			}
+
+			while (r < end && !isSpaceCh((unsigned char)*r))
+				r++;
+			if (r == end && !eof)
+				break;
+			reject(t, REJECT_INVALID, p, (size_t)(r - p));
+			status = TOKENIZER_INVALID;
+			break;
+		}
+
+		if (isDigitCh(ch) && ch != '0') { // numbers
+			const char* digitsEnd = p; // digits and '.' before the first letter
+			bool chInNum = t->chInNum;
+
+			for (r = p; r < end; r++) {
+				unsigned char c = (unsigned char)*r;
+				if (isDigitCh(c) || c == '.') {
+					if (!chInNum)
+						digitsEnd = r + 1;
+				}
+				else if (isAlphaCh(c)) {
+					chInNum = true;
+				}
+				else {
+					break;
+				}
+			}
+			if (r == end && !eof)
+				break;
+
+			if (digitsEnd > p) {
+				long double num = 0;
+				double check;
+				if (!parseFast(p, digitsEnd, &num) && !parseSlow(p, (size_t)(digitsEnd - p), &num, &check)) {
+					status = TOKENIZER_NOMEM;
+					break;
+				}
+
+				if (isinf(num)) { // inf = INFINITY skip
+					reject(t, REJECT_INFINITY, p, (size_t)(digitsEnd - p));
+				}
+				else if (!pushValue(t, num)) {
+					status = TOKENIZER_NOMEM;
+					break;
+				}
+			}
+
+			t->chInNum = chInNum;
+			p = (r < end && !isSpaceCh((unsigned char)*r)) ? r + 1 : r;
+			continue;
+		}
+
+		// 0... or ALPHABET or special characters, the whole token counts
+		for (r = p + 1; r < end && !isSpaceCh((unsigned char)*r); r++)
+			;
+		if (r == end && !eof)
+			break;
+
+		long double num = 0;
+		double check = 0;
+		if (!readToken(p, r, &num, &check)) {
+			status = TOKENIZER_NOMEM;
+			break;
+		}
+
+		if (check > 0 && isinf(num)) {
+			reject(t, REJECT_INFINITY, p, (size_t)(r - p));
+		}
+		else if (check > 0) {
+			if (!pushValue(t, num)) {
+				status = TOKENIZER_NOMEM;
+				break;
+			}
+		}
+		else if (ch == '0') { // reject 0 BUT accept 0.00 float number
+			reject(t, REJECT_ZERO, p, (size_t)(r - p));
+		}
+		else { // error terminate
+			reject(t, REJECT_INVALID, p, (size_t)(r - p));
+			status = TOKENIZER_INVALID;
+			break;
+		}
+		p = r < end ? r + 1 : r; // the white-space after the token is dropped
+	}
+
+	*used = (size_t)(p - buf);
+	return status;
+}
+
+/*!	 \fn readNumber
+	 \return true if the field is a positive number
+	 \param const char* s, size_t len - whole field without surrounding white-space, long double* value,
+			enum rejectReason* reason - set when false is returned
+
+	 Read one field of a table (CSV). Nothing but the number may be in the field, and a field that is
+	 not a number is only rejected (REJECT_INVALID), it does not end the data set. */
+bool readNumber(const char* s, size_t len, long double* value, enum rejectReason* reason) {
+	const char* e = s + len;
+	int points = 0;
+	bool plain = len > 0;
+	double check;
+
+	for (const char* p = s; p < e && plain; p++) {
+		if (*p == '.')
+			points++;
+		else if (!isDigitCh((unsigned char)*p))
+			plain = false;
+	}
+
+	if (plain && points <= 1 && parseFast(s, e, value)) {
+		check = (double)*value;
+	}
+	else {
+		char local[64];
+		char* copy = len < sizeof(local) ? local : (char*)malloc(len + 1);
+		char* end = NULL;
+		if (copy == NULL) {
+			*reason = REJECT_INVALID;
+			return false;
+		}
+
+		memcpy(copy, s, len);
+		copy[len] = '\0';
+		check = strtod(copy, NULL);
+		*value = strtold(copy, &end);
+		bool whole = len > 0 && end == copy + len;
+
+		if (copy != local)
+			free(copy);
+		if (!whole) {
+			*reason = REJECT_INVALID;
+			return false;
+		}
+	}
+
+	if (check > 0 && isinf(*value)) {
+		*reason = REJECT_INFINITY;
+		return false;
+	}
+	if (check > 0)
+		return true;
+
+	if (*value < 0 || (*value == 0 && *s == '-'))
+		*reason = REJECT_NEGATIVE;
+	else if (*value == 0)
+		*reason = REJECT_ZERO;
+	else // nan
+		*reason = REJECT_INVALID;
+	return false;
+}
@@ -0,0 +1,45 @@
+/*!	\file		nbstats_tokenizer.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	In-place tokenizer for white-space separated numbers.
+	The accept/reject rules are the ones getNumbers always applied character by character.
+*/
+#ifndef NBSTATS_TOKENIZER_H
+#define NBSTATS_TOKENIZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// scanNumbers results
+#define TOKENIZER_OK		0
+#define TOKENIZER_NOMEM		1	// values array could not grow
+#define TOKENIZER_INVALID	2	// alphabetic junk, scanning stopped
+
+// why a token was not accepted
+enum rejectReason {
+	REJECT_NEGATIVE,	// negative number
+	REJECT_ZERO,		// 0 or a token starting with 0 that does not read as a positive number
+	REJECT_INFINITY,	// too large for long double
+	REJECT_INVALID		// not a number at all, terminates the data set
+};
+
+typedef void (*rejectHandler)(void* ctx, enum rejectReason reason, size_t index, const char* token, size_t length);
+
+struct tokenizer {
+	bool chInNum;			// a letter was met inside the current number, skip until white-space
+	size_t total;			// accepted elements so far (index of the next element)
+	long double* values;	// accepted elements, always followed by a 0 (end of array)
+	size_t size;
+	size_t capacity;
+	rejectHandler onReject;	// called for every rejected token
+	void* rejectCtx;
+};
+
+bool initTokenizer(struct tokenizer* t);
+void freeTokenizer(struct tokenizer* t);
+int scanNumbers(struct tokenizer* t, const char* buf, size_t len, bool eof, size_t* used);
+bool readNumber(const char* s, size_t len, long double* value, enum rejectReason* reason);
+
+#endif
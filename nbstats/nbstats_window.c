@@ -0,0 +1,149 @@
+/*!	\file		nbstats_window.c
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Sliding window: every number that enters adds its leading digit and moments to the running
+	statistics of the window, the number it pushes out of the ring buffer takes its own away again
+	(Welford forward and backward). A report costs the 9 digit classes, not the window.
+	Taking numbers away loses a little precision each time, so the moments are recalculated from
+	the ring once per window length of removals, which is still constant work per number.
+*/
+#include "nbstats_window.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nbstats_digits.h"
+#include "nbstats_stats.h"
+
+/*!	 \fn initWindow
+	 \return false if out of memory
+	 \param struct slidingWindow* w, size_t capacity - window size, size_t step - numbers between reports (0: capacity),
+			nb_window_handler onWindow, void* windowCtx - receives the reports */
+bool initWindow(struct slidingWindow* w, size_t capacity, size_t step, nb_window_handler onWindow, void* windowCtx) {
+	memset(w, 0, sizeof(*w));
+	w->capacity = capacity;
+	w->step = step != 0 ? step : capacity;
+	w->untilReport = capacity;
+	w->untilResync = capacity;
+	w->onWindow = onWindow;
+	w->windowCtx = windowCtx;
+
+	w->values = (long double*)malloc(sizeof(long double) * capacity);
+	w->digits = (unsigned char*)malloc(capacity);
+	if (w->values == NULL || w->digits == NULL) {
+		freeWindow(w);
+		return false;
+	}
+	return true;
+}
+
+/*!	 \fn freeWindow
+	 \return none
+	 \param struct slidingWindow* w */
+void freeWindow(struct slidingWindow* w) {
+	free(w->values);
+	free(w->digits);
+	w->values = NULL;
+	w->digits = NULL;
+}
+
+/*!	 \fn resyncMoments
+	 \return none
+	 \param struct slidingWindow* w
+
+	 Mean and squares of the numbers in the ring again (two pass), drops what the removals rounded off */
+static void resyncMoments(struct slidingWindow* w) {
+	long double sum = 0;
+	long double m2 = 0;
+
+	for (size_t i = 0; i < w->size; i++)
+		sum += w->values[i];
+	w->mean = sum / w->size;
+	for (size_t i = 0; i < w->size; i++) {
+		long double d = w->values[i] - w->mean;
+		m2 += d * d;
+	}
+	w->m2 = m2;
+}
+
+/*!	 \fn reportWindow
+	 \return none
+	 \param const struct slidingWindow* w - not empty
+
+	 Statistics and Newcomb-Benford analysis of the numbers in the window, to onWindow */
+void reportWindow(const struct slidingWindow* w) {
+	struct nb_window r;
+	double expected[9];
+	double actual[9];
+
+	if (w->onWindow == NULL || w->size == 0)
+		return;
+
+	r.first = w->total - w->size;
+	r.count = w->size;
+	r.arithmeticMean = w->mean;
+	r.variance = w->m2 > 0 ? w->m2 / w->size : 0;
+	r.standardDeviation = sqrt(r.variance);
+	for (int i = 0; i < 9; i++)
+		r.frequency[i] = w->fre[i];
+	calFrequencies(r.frequency, r.count, expected, actual);
+	r.NBVariance = calNBVariance(expected, actual);
+	r.NBDeviation = sqrt(r.NBVariance);
+	w->onWindow(w->windowCtx, &r);
+}
+
+/*!	 \fn addWindow
+	 \return none
+	 \param struct slidingWindow* w, const long double a[] - accepted numbers in input order, size_t size
+
+	 Slide the window over a[], reporting when it first fills and every step numbers after that */
+void addWindow(struct slidingWindow* w, const long double a[], size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		long double x = a[i];
+		size_t slot;
+
+		if (w->size == w->capacity) { // the oldest number leaves
+			long double old = w->values[w->head];
+			w->fre[w->digits[w->head] - 1]--;
+			if (--w->size == 0) {
+				w->mean = 0;
+				w->m2 = 0;
+			}
+			else {
+				long double delta = old - w->mean;
+				w->mean -= delta / w->size;
+				w->m2 -= delta * (old - w->mean);
+			}
+			slot = w->head;
+			w->head = w->head + 1 == w->capacity ? 0 : w->head + 1;
+			w->untilResync--;
+		}
+		else {
+			slot = w->head + w->size;
+			if (slot >= w->capacity)
+				slot -= w->capacity;
+		}
+
+		int digit = fastLeadingDigit(x);
+		w->values[slot] = x;
+		w->digits[slot] = (unsigned char)digit;
+		w->fre[digit - 1]++;
+		w->size++;
+		w->total++;
+		long double delta = x - w->mean;
+		w->mean += delta / w->size;
+		w->m2 += delta * (x - w->mean);
+
+		if (w->untilResync == 0) {
+			resyncMoments(w);
+			w->untilResync = w->capacity;
+		}
+		if (--w->untilReport == 0) {
+			reportWindow(w);
+			w->untilReport = w->step;
+		}
+	}
+}
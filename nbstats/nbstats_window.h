@@ -0,0 +1,40 @@
+/*!	\file		nbstats_window.h
+	\author		Jimin Park
+	\date		2026-10-16
+	\version	0.1
+
+	Sliding window over the most recent numbers of a stream, for monitoring the Newcomb-Benford
+	relationship as the numbers come in.
+*/
+#ifndef NBSTATS_WINDOW_H
+#define NBSTATS_WINDOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "nbstats.h"
+
+// ring buffer of the last capacity numbers with their running statistics
+struct slidingWindow {
+	long double* values;
+	unsigned char* digits;		// leading digit of each value
+	size_t capacity;			// window size
+	size_t step;				// numbers between two reports once the window is full
+	size_t size;				// numbers in the window
+	size_t head;				// position of the oldest number
+	size_t total;				// numbers that entered the window
+	size_t untilReport;			// numbers until the next report
+	size_t untilResync;			// removals until the moments are recalculated
+	long double mean;
+	long double m2;				// sum of squares of the differences from the mean
+	long int fre[9];			// raw frequency of the leading digits in the window
+	nb_window_handler onWindow;
+	void* windowCtx;
+};
+
+bool initWindow(struct slidingWindow* w, size_t capacity, size_t step, nb_window_handler onWindow, void* windowCtx);
+void freeWindow(struct slidingWindow* w);
+void addWindow(struct slidingWindow* w, const long double a[], size_t size);
+void reportWindow(const struct slidingWindow* w);
+
+#endif